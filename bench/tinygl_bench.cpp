@@ -0,0 +1,315 @@
+#include "tinygl/tinygl.h"
+#include <GL/glew.h>
+#include <fmt/format.h>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Measures tinygl hot paths on whatever context tinygl::init(..., context_flag::headless) provides,
+ * typically Mesa's llvmpipe on CI machines. Results are written as JSON so runs of different commits can be diffed.
+ *
+ * Usage: tinygl_bench [output.json]
+ *
+ * Validation is turned off for the run, but debug builds are still not comparable to release ones; the build type
+ * is part of the output.
+ */
+
+#ifndef TINYGL_BENCH_BUILD_TYPE
+#define TINYGL_BENCH_BUILD_TYPE ""
+#endif
+
+namespace {
+#ifdef NDEBUG
+    constexpr bool optimized = true;
+#else
+    constexpr bool optimized = false;
+#endif
+
+    constexpr auto vertex_shader_source = R"(
+#version 330 core
+layout (location = 0) in vec3 position;
+uniform mat4 transform;
+uniform float scale;
+uniform vec4 tint;
+out vec4 color;
+void main()
+{
+    gl_Position = transform * vec4(position * scale, 1.0);
+    color = tint;
+}
+)";
+
+    constexpr auto fragment_shader_source = R"(
+#version 330 core
+in vec4 color;
+out vec4 fragment_color;
+void main()
+{
+    fragment_color = color;
+}
+)";
+
+    struct result
+    {
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    std::vector<result> results;
+
+    // Runs `body` `iterations` times, waits for the GPU to finish and returns the elapsed seconds.
+    double measure(int iterations, const std::function<void(int)>& body)
+    {
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            body(i);
+        }
+        glFinish();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(std::string name, double value, std::string unit)
+    {
+        std::cerr << fmt::format("{:<48} {:>16.2f} {}\n", name, value, unit);
+        results.push_back({std::move(name), value, std::move(unit)});
+    }
+
+    tinygl::shader_program make_program()
+    {
+        tinygl::shader_program program;
+        program.add_shader_from_source_code(tinygl::shader::type::gl_vertex_shader, vertex_shader_source);
+        program.add_shader_from_source_code(tinygl::shader::type::gl_fragment_shader, fragment_shader_source);
+        program.link();
+        return program;
+    }
+
+    void bench_draw_calls()
+    {
+        constexpr std::array<float, 9> vertices = {-0.1f, -0.1f, 0.0f, 0.1f, -0.1f, 0.0f, 0.0f, 0.1f, 0.0f};
+        constexpr std::array<std::uint32_t, 3> indices = {0, 1, 2};
+        constexpr int draws = 20000;
+
+        auto program = make_program();
+        program.use();
+        program.set_uniform_value("transform", std::array<float, 16>{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}.data());
+        program.set_uniform_value("scale", 1.0f);
+        program.set_uniform_value(program.uniform_location("tint"), 1.0f, 1.0f, 1.0f, 1.0f);
+
+        tinygl::vertex_array_object vao;
+        vao.bind();
+        tinygl::buffer vbo{tinygl::buffer::binding_target::gl_array_buffer, tinygl::buffer::usage_pattern::gl_static_draw};
+        vbo.bind();
+        vbo.create(vertices.begin(), vertices.end());
+        tinygl::buffer ebo{
+            tinygl::buffer::binding_target::gl_element_array_buffer, tinygl::buffer::usage_pattern::gl_static_draw};
+        ebo.bind();
+        ebo.create(indices.begin(), indices.end());
+        vao.set_attribute_array(0, 3, tinygl::data_type::gl_float, tinygl::normalization::keep);
+        vao.enable_attribute_array(0);
+
+        auto seconds = measure(draws, [](int) {
+            tinygl::gl_draw_arrays(tinygl::mode::gl_triangles, 0, 3);
+        });
+        report("gl_draw_arrays", draws / seconds, "calls/s");
+
+        seconds = measure(draws, [](int) {
+            tinygl::gl_draw_elements(tinygl::mode::gl_triangles, 3, tinygl::data_type::gl_unsigned_int, nullptr);
+        });
+        report("gl_draw_elements", draws / seconds, "calls/s");
+
+        vao.unbind();
+    }
+
+    void bench_buffers()
+    {
+        const std::array<std::pair<tinygl::buffer::usage_pattern, const char*>, 3> patterns = {{
+            {tinygl::buffer::usage_pattern::gl_static_draw, "static_draw"},
+            {tinygl::buffer::usage_pattern::gl_dynamic_draw, "dynamic_draw"},
+            {tinygl::buffer::usage_pattern::gl_stream_draw, "stream_draw"},
+        }};
+        constexpr std::array<std::size_t, 4> sizes = {4 << 10, 64 << 10, 1 << 20, 16 << 20};
+
+        for (auto size : sizes) {
+            std::vector<std::uint8_t> data(size, 0x5A);
+            auto iterations = static_cast<int>(std::max<std::size_t>((256u << 20) / size, 8));
+            for (const auto& [pattern, pattern_name] : patterns) {
+                tinygl::buffer buffer{tinygl::buffer::binding_target::gl_array_buffer, pattern};
+                buffer.bind();
+
+                auto seconds = measure(iterations, [&](int) {
+                    buffer.create(size, data.data());
+                });
+                report(fmt::format("buffer::create {} {} KiB", pattern_name, size >> 10),
+                       static_cast<double>(size) * iterations / seconds / (1 << 20), "MiB/s");
+
+                seconds = measure(iterations, [&](int) {
+                    buffer.update(0, size, data.data());
+                });
+                report(fmt::format("buffer::update {} {} KiB", pattern_name, size >> 10),
+                       static_cast<double>(size) * iterations / seconds / (1 << 20), "MiB/s");
+
+                buffer.unbind();
+            }
+        }
+    }
+
+    void bench_textures()
+    {
+        constexpr int size = 1024;
+        constexpr int iterations = 16;
+
+        // stb_image reads binary PPM, which is trivial to write without an image library.
+        auto path = std::filesystem::temp_directory_path() / "tinygl_bench.ppm";
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << fmt::format("P6\n{} {}\n255\n", size, size);
+            std::vector<char> pixels(static_cast<std::size_t>(size) * size * 3);
+            for (std::size_t i = 0; i < pixels.size(); ++i) {
+                pixels[i] = static_cast<char>(i * 7);
+            }
+            file.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+        }
+
+        using tinygl::texture;
+        const std::array<std::pair<texture::internal_format, const char*>, 4> file_formats = {{
+            {texture::internal_format::gl_rgb8, "rgb8"},
+            {texture::internal_format::gl_srgb8, "srgb8"},
+            {texture::internal_format::gl_rgba8, "rgba8"},
+            {texture::internal_format::gl_rgb16f, "rgb16f"},
+        }};
+        for (const auto& [internal_format, name] : file_formats) {
+            auto seconds = measure(iterations, [&](int) {
+                texture t{texture::target::gl_texture_2d, path, internal_format, texture::format::gl_rgb, 0};
+            });
+            report(fmt::format("texture load+upload {} {}x{}", name, size, size), iterations / seconds, "textures/s");
+        }
+
+        const std::array<std::pair<texture::internal_format, const char*>, 4> storage_formats = {{
+            {texture::internal_format::gl_rgba8, "rgba8"},
+            {texture::internal_format::gl_rgba16f, "rgba16f"},
+            {texture::internal_format::gl_rgba32f, "rgba32f"},
+            {texture::internal_format::gl_r11f_g11f_b10f, "r11f_g11f_b10f"},
+        }};
+        for (const auto& [internal_format, name] : storage_formats) {
+            auto seconds = measure(iterations * 4, [&](int) {
+                texture t{texture::target::gl_texture_2d, internal_format, size, size, 0};
+            });
+            report(fmt::format("texture storage {} {}x{}", name, size, size), iterations * 4 / seconds, "textures/s");
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    void bench_shaders()
+    {
+        constexpr int iterations = 32;
+        auto seconds = measure(iterations, [](int) {
+            make_program();
+        });
+        report("shader compile+link", seconds / iterations * 1e3, "ms");
+
+        tinygl::shader_program program;
+        program.add_shader_from_source_code(tinygl::shader::type::gl_vertex_shader, vertex_shader_source);
+        program.add_shader_from_source_code(tinygl::shader::type::gl_fragment_shader, fragment_shader_source);
+        seconds = measure(iterations, [&](int) {
+            program.link();
+        });
+        report("shader_program::link", seconds / iterations * 1e3, "ms");
+    }
+
+    void bench_uniforms()
+    {
+        constexpr int iterations = 200000;
+        auto program = make_program();
+        program.use();
+        auto tint = program.uniform_location("tint");
+        auto transform = program.uniform_location("transform");
+        std::array<float, 16> matrix = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+        auto seconds = measure(iterations, [&](int i) {
+            program.set_uniform_value(tint, static_cast<float>(i), 0.0f, 0.0f, 1.0f);
+        });
+        report("set_uniform_value vec4", seconds / iterations * 1e9, "ns/call");
+
+        seconds = measure(iterations, [&](int i) {
+            matrix[12] = static_cast<float>(i);
+            program.set_uniform_value(transform, matrix.data());
+        });
+        report("set_uniform_value mat4", seconds / iterations * 1e9, "ns/call");
+
+        seconds = measure(iterations / 10, [&](int i) {
+            program.set_uniform_value("scale", static_cast<float>(i));
+        });
+        report("set_uniform_value by name", seconds / (iterations / 10) * 1e9, "ns/call");
+    }
+
+    std::string escape(std::string_view text)
+    {
+        std::string escaped;
+        for (auto c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void write_json(std::ostream& out)
+    {
+        out << "{\n";
+        out << fmt::format("  \"renderer\": \"{}\",\n", escape(tinygl::get_string(tinygl::name::gl_renderer)));
+        out << fmt::format("  \"version\": \"{}\",\n", escape(tinygl::get_string(tinygl::name::gl_version)));
+        out << fmt::format("  \"build_type\": \"{}\",\n", escape(TINYGL_BENCH_BUILD_TYPE));
+        out << fmt::format("  \"ndebug\": {},\n", optimized);
+        out << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            out << fmt::format(
+                "    {{ \"name\": \"{}\", \"value\": {:.4f}, \"unit\": \"{}\" }}{}\n",
+                escape(results[i].name), results[i].value, results[i].unit, i + 1 < results.size() ? "," : "");
+        }
+        out << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try {
+        tinygl::init(4, 5, tinygl::context_flag::headless);
+        tinygl::window window{640, 480, "tinygl_bench"};
+        // Every checked call would include a glGetError round trip.
+        tinygl::set_validation_enabled(false);
+        if (!optimized) {
+            std::cerr << "tinygl_bench: not built with NDEBUG, results are not comparable to release builds" << std::endl;
+        }
+
+        bench_draw_calls();
+        bench_buffers();
+        bench_textures();
+        bench_shaders();
+        bench_uniforms();
+
+        if (argc > 1) {
+            std::ofstream file{argv[1]};
+            write_json(file);
+        } else {
+            write_json(std::cout);
+        }
+    } catch (const std::exception& e) {
+        tinygl::terminate();
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    tinygl::terminate();
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,12 @@
 #ifndef TINYGL_BUFFER_H
 #define TINYGL_BUFFER_H
 
+#include "tinygl/bitmask_operators.h"
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <source_location>
 #include <vector>
 
 namespace tinygl
@@ -41,34 +43,66 @@ namespace tinygl
             gl_dynamic_copy
         };
 
+        enum class map_access : std::uint32_t {
+            gl_map_read_bit              = 0x0001,  // GL_MAP_READ_BIT
+            gl_map_write_bit             = 0x0002,  // GL_MAP_WRITE_BIT
+            gl_map_invalidate_range_bit  = 0x0004,  // GL_MAP_INVALIDATE_RANGE_BIT
+            gl_map_invalidate_buffer_bit = 0x0008,  // GL_MAP_INVALIDATE_BUFFER_BIT
+            gl_map_flush_explicit_bit    = 0x0010,  // GL_MAP_FLUSH_EXPLICIT_BIT
+            gl_map_unsynchronized_bit    = 0x0020,  // GL_MAP_UNSYNCHRONIZED_BIT
+            gl_map_persistent_bit        = 0x0040,  // GL_MAP_PERSISTENT_BIT
+            gl_map_coherent_bit          = 0x0080   // GL_MAP_COHERENT_BIT
+        };
+
         buffer(binding_target binding_target, usage_pattern usage_pattern);
         ~buffer();
 
         buffer(buffer&& other) noexcept;
         buffer& operator=(buffer&& other) noexcept;
 
-        void bind();
-        void unbind();
+        void bind(std::source_location call_site = std::source_location::current());
+        void unbind(std::source_location call_site = std::source_location::current());
+
+        void create(std::size_t size, const void* data = nullptr,
+                    std::source_location call_site = std::source_location::current());
+        void update(std::size_t offset, std::size_t size, const void* data,
+                    std::source_location call_site = std::source_location::current());
+
+        // The buffer has to be bound. Returns nullptr if the range could not be mapped.
+        void* map_range(std::size_t offset, std::size_t size, map_access access,
+                        std::source_location call_site = std::source_location::current());
+        // Returns false if the data store was corrupted while mapped and has to be reinitialized.
+        bool unmap(std::source_location call_site = std::source_location::current());
 
-        void create(std::size_t size, const void* data = nullptr);
-        void update(std::size_t offset, std::size_t size, const void* data);
+        // Size of the data store allocated by the last create().
+        std::size_t size() const;
 
         template<std::contiguous_iterator It>
-        void create(It first, It last)
+        void create(It first, It last, std::source_location call_site = std::source_location::current())
         {
-            create((last - first) * sizeof(*first), &(*first));
+            create((last - first) * sizeof(*first), &(*first), call_site);
         }
 
         template<std::contiguous_iterator It>
-        void update(std::size_t offset, It first, It last)
+        void update(std::size_t offset, It first, It last,
+                    std::source_location call_site = std::source_location::current())
         {
-            update(offset, (last - first) * sizeof(*first), &(*first));
+            update(offset, (last - first) * sizeof(*first), &(*first), call_site);
         }
 
     private:
+        std::uint32_t id() const;
+
         struct buffer_private;
         std::unique_ptr<buffer_private> p;
+
+        friend class texture;
     };
 }
 
+template<>
+struct enable_bitmask_operators<tinygl::buffer::map_access> {
+    static constexpr bool enable = true;
+};
+
 #endif // TINYGL_BUFFER_H
@@ -0,0 +1,21 @@
+#ifndef TINYGL_BUFFER_BIT_H
+#define TINYGL_BUFFER_BIT_H
+
+#include "tinygl/bitmask_operators.h"
+#include <cstdint>
+
+namespace tinygl
+{
+    enum class buffer_bit : std::uint32_t {
+        gl_color_buffer_bit   = 0x00004000,  // GL_COLOR_BUFFER_BIT
+        gl_depth_buffer_bit   = 0x00000100,  // GL_DEPTH_BUFFER_BIT
+        gl_stencil_buffer_bit = 0x00000400   // GL_STENCIL_BUFFER_BIT
+    };
+}
+
+template<>
+struct enable_bitmask_operators<tinygl::buffer_bit> {
+    static constexpr bool enable = true;
+};
+
+#endif // TINYGL_BUFFER_BIT_H
@@ -4,6 +4,8 @@
 namespace tinygl {
     struct color {
         float r, g, b, a;
+
+        bool operator==(const color&) const = default;
     };
 }
 
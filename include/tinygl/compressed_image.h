@@ -0,0 +1,47 @@
+#ifndef TINYGL_COMPRESSED_IMAGE_H
+#define TINYGL_COMPRESSED_IMAGE_H
+
+#include "tinygl/texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace tinygl
+{
+    /**
+     * Block-compressed 2D image with its mip chain, read from a KTX2 or DDS file (BC1-BC7, i.e. S3TC, RGTC and
+     * BPTC). The blocks are kept as stored and uploaded by texture's constructor without decoding.
+     * Rows are uploaded as stored. tinygl_texbake writes the bottom row first, like textures loaded through
+     * stb_image, which are flipped; DDS files and other KTX2 writers usually store the top row first.
+     */
+    class compressed_image final
+    {
+    public:
+        // Chooses the container by its magic number. Throws for cube maps, arrays, 3D and supercompressed images.
+        explicit compressed_image(const std::filesystem::path& file_name);
+        ~compressed_image();
+
+        compressed_image(compressed_image&& other) noexcept;
+        compressed_image& operator=(compressed_image&& other) noexcept;
+
+        compressed_image(const compressed_image&) = delete;
+        compressed_image& operator=(const compressed_image&) = delete;
+
+        texture::internal_format internal_format() const;
+        std::int32_t width() const;
+        std::int32_t height() const;
+
+        std::int32_t level_count() const;
+        std::int32_t level_width(std::int32_t level) const;
+        std::int32_t level_height(std::int32_t level) const;
+        std::span<const std::uint8_t> level_data(std::int32_t level) const;
+
+    private:
+        struct compressed_image_private;
+        std::unique_ptr<compressed_image_private> p;
+    };
+}
+
+#endif // TINYGL_COMPRESSED_IMAGE_H
@@ -0,0 +1,47 @@
+#ifndef TINYGL_DEBUG_OUTPUT_H
+#define TINYGL_DEBUG_OUTPUT_H
+
+#include "tinygl/bitmask_operators.h"
+#include <cstdint>
+
+namespace tinygl::debug_output
+{
+    enum class severity : std::uint32_t {
+        notification,
+        low,
+        medium,
+        high
+    };
+
+    enum class message_type : std::uint32_t {
+        error               = 1 << 0,
+        deprecated_behavior = 1 << 1,
+        undefined_behavior  = 1 << 2,
+        portability         = 1 << 3,
+        performance         = 1 << 4,
+        marker              = 1 << 5,
+        push_group          = 1 << 6,
+        pop_group           = 1 << 7,
+        other               = 1 << 8,
+        all                 = (1 << 9) - 1
+    };
+
+    // Messages below `min_severity` or of a type outside `types` are dropped inside the driver callback.
+    void set_filter(severity min_severity, message_type types = message_type::all);
+
+    // Counted before filtering, so performance warnings are tallied even when they are not logged.
+    std::uint64_t performance_warning_count();
+
+    // Messages lost because the queue between the driver callback and the logger was full.
+    std::uint64_t dropped_message_count();
+
+    // Logs how many times each message that was deduplicated by its ID was raised.
+    void report_repeated();
+}
+
+template<>
+struct enable_bitmask_operators<tinygl::debug_output::message_type> {
+    static constexpr bool enable = true;
+};
+
+#endif // TINYGL_DEBUG_OUTPUT_H
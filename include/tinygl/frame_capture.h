@@ -0,0 +1,67 @@
+#ifndef TINYGL_FRAME_CAPTURE_H
+#define TINYGL_FRAME_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace tinygl
+{
+    /**
+     * Records the back buffer without stalling the render thread. Every frame is read into one of a ring of
+     * pixel-pack buffers and only mapped once its fence has signalled, typically 2-3 frames later; encoding then
+     * happens on worker threads. When the GPU or the encoders fall behind, frames are dropped, never waited for.
+     */
+    class frame_capture final
+    {
+    public:
+        struct frame
+        {
+            std::uint64_t index;     // index of the rendered frame
+            std::uint64_t sequence;  // consecutive among the frames handed to the encoder
+            std::int32_t width;
+            std::int32_t height;
+            std::vector<std::uint8_t> pixels;  // RGBA8, bottom row first
+        };
+
+        // Called on a worker thread; may be called concurrently for different frames.
+        typedef std::function<void(const frame&)> encoder;
+
+        explicit frame_capture(
+            encoder encoder, std::size_t ring_size = 3, std::size_t worker_count = 2, std::size_t max_queued = 8);
+        ~frame_capture();
+
+        frame_capture(const frame_capture&) = delete;
+        frame_capture& operator=(const frame_capture&) = delete;
+
+        /**
+         * Issues the read of the current back buffer and hands finished reads to the workers. Called by the window.
+         * Frames with an empty framebuffer, e.g. while minimized, count as dropped.
+         */
+        void capture(std::int32_t width, std::int32_t height,
+                     std::source_location call_site = std::source_location::current());
+        // Waits for all outstanding reads and encodes them.
+        void finish();
+
+        std::uint64_t captured_frame_count() const;
+        std::uint64_t dropped_frame_count() const;
+
+        // One `frame_<index>.rgba` file per frame.
+        static encoder raw_files(const std::filesystem::path& directory);
+        // One binary PPM file per frame, flipped to top row first.
+        static encoder ppm_files(const std::filesystem::path& directory);
+        // Writes raw RGBA frames in order to the standard input of `command`, e.g. an ffmpeg invocation.
+        static encoder pipe(const std::string& command);
+
+    private:
+        struct frame_capture_private;
+        std::unique_ptr<frame_capture_private> p;
+    };
+}
+
+#endif // TINYGL_FRAME_CAPTURE_H
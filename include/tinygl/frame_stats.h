@@ -0,0 +1,94 @@
+#ifndef TINYGL_FRAME_STATS_H
+#define TINYGL_FRAME_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <source_location>
+#include <vector>
+
+namespace tinygl
+{
+    /**
+     * Collects per-frame timings for a window: the interval between frames, the CPU time spent building a frame,
+     * the GPU time measured with GL_TIME_ELAPSED queries (read back a few frames later, never waited for) and the
+     * time blocked in the buffer swap. The most recent frames are kept in a ring; every frame of the run also goes
+     * into fixed-width histograms, so percentiles over a long soak run cost no memory.
+     *
+     * The window owns the GL_TIME_ELAPSED target while it is attached; do not run other timer queries across frames.
+     */
+    class frame_stats final
+    {
+    public:
+        enum class metric {
+            frame,  // interval between the start of two frames
+            cpu,
+            gpu,
+            swap
+        };
+
+        struct sample
+        {
+            std::uint64_t frame;
+            float frame_ms;
+            float cpu_ms;
+            float gpu_ms;  // negative until (or if never) the query result arrives
+            float swap_ms;
+            bool hitch;
+        };
+
+        struct summary
+        {
+            std::uint64_t count;
+            double mean;
+            double p50;
+            double p95;
+            double p99;
+            double max;
+        };
+
+        /**
+         * A frame is a hitch when its CPU plus swap time exceeds `hitch_factor` times the running average,
+         * so the threshold follows the workload and the refresh rate.
+         */
+        explicit frame_stats(std::size_t capacity = 1024, double hitch_factor = 2.0);
+        ~frame_stats();
+
+        frame_stats(const frame_stats&) = delete;
+        frame_stats& operator=(const frame_stats&) = delete;
+
+        // Called by the window around every frame.
+        void begin_frame(std::source_location call_site = std::source_location::current());
+        void begin_swap(std::source_location call_site = std::source_location::current());
+        void end_frame(std::source_location call_site = std::source_location::current());
+        // Waits for the outstanding GPU queries, releases them and writes the configured exports.
+        void finish(std::source_location call_site = std::source_location::current());
+
+        // Over the frames still in the ring.
+        summary recent(metric metric) const;
+        // Over every frame since construction, to the resolution of the histogram (0.1 ms below 100 ms).
+        summary overall(metric metric) const;
+        std::uint64_t frame_count() const;
+        std::uint64_t hitch_count() const;
+        std::vector<sample> samples() const;
+
+        // Draws the frame time graphs into the current Dear ImGui frame; the window calls it when enabled.
+        void draw_ui();
+        void set_graph_visible(bool visible);
+        bool graph_visible() const;
+
+        // One row per frame still in the ring.
+        void write_csv(const std::filesystem::path& path) const;
+        // Summaries, hitch count and the non-empty histogram bins.
+        void write_json(const std::filesystem::path& path) const;
+        // Written by finish(), i.e. when the window's run() returns. Empty paths are skipped.
+        void set_export_paths(std::filesystem::path csv, std::filesystem::path json);
+
+    private:
+        struct frame_stats_private;
+        std::unique_ptr<frame_stats_private> p;
+    };
+}
+
+#endif // TINYGL_FRAME_STATS_H
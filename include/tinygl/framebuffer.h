@@ -0,0 +1,143 @@
+#ifndef TINYGL_FRAMEBUFFER_H
+#define TINYGL_FRAMEBUFFER_H
+
+#include "tinygl/buffer_bit.h"
+#include "tinygl/texture.h"
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <source_location>
+#include <span>
+#include <string>
+
+namespace tinygl
+{
+    class renderbuffer final
+    {
+    public:
+        // `samples` greater than zero allocates multisample storage.
+        renderbuffer(
+            texture::internal_format internal_format, std::int32_t width, std::int32_t height, std::int32_t samples = 0,
+            std::source_location call_site = std::source_location::current());
+        ~renderbuffer();
+
+        renderbuffer(renderbuffer&& other) noexcept;
+        renderbuffer& operator=(renderbuffer&& other) noexcept;
+
+        renderbuffer(const renderbuffer&) = delete;
+        renderbuffer& operator=(const renderbuffer&) = delete;
+
+        std::int32_t width() const;
+        std::int32_t height() const;
+        std::int32_t samples() const;
+
+    private:
+        std::uint32_t id() const;
+
+        struct renderbuffer_private;
+        std::unique_ptr<renderbuffer_private> p;
+
+        friend class framebuffer;
+    };
+
+    class framebuffer final
+    {
+    public:
+        enum class binding_target : std::uint32_t {
+            gl_framebuffer,
+            gl_draw_framebuffer,
+            gl_read_framebuffer
+        };
+
+        enum class attachment : std::uint32_t {
+            gl_color_attachment0,
+            gl_color_attachment1,
+            gl_color_attachment2,
+            gl_color_attachment3,
+            gl_color_attachment4,
+            gl_color_attachment5,
+            gl_color_attachment6,
+            gl_color_attachment7,
+            gl_depth_attachment,
+            gl_stencil_attachment,
+            gl_depth_stencil_attachment
+        };
+
+        enum class status : std::uint32_t {
+            gl_framebuffer_complete,
+            gl_framebuffer_undefined,
+            gl_framebuffer_incomplete_attachment,
+            gl_framebuffer_incomplete_missing_attachment,
+            gl_framebuffer_incomplete_draw_buffer,
+            gl_framebuffer_incomplete_read_buffer,
+            gl_framebuffer_unsupported,
+            gl_framebuffer_incomplete_multisample,
+            gl_framebuffer_incomplete_layer_targets
+        };
+
+        enum class blit_filter : std::uint32_t {
+            nearest,
+            linear
+        };
+
+        framebuffer();
+        ~framebuffer();
+
+        framebuffer(framebuffer&& other) noexcept;
+        framebuffer& operator=(framebuffer&& other) noexcept;
+
+        framebuffer(const framebuffer&) = delete;
+        framebuffer& operator=(const framebuffer&) = delete;
+
+        void bind(binding_target binding_target = binding_target::gl_framebuffer,
+                  std::source_location call_site = std::source_location::current());
+        // Binds the default framebuffer.
+        void unbind(binding_target binding_target = binding_target::gl_framebuffer,
+                    std::source_location call_site = std::source_location::current());
+
+        /**
+         * Attachments marked as transient (typically depth or multisample color) are only needed while the pass
+         * is being rendered; discard() invalidates them so tiled GPUs never write them back to memory.
+         * The framebuffer has to be bound.
+         */
+        void attach(attachment attachment, texture& texture, std::int32_t level = 0, bool transient = false,
+                    std::source_location call_site = std::source_location::current());
+        void attach(attachment attachment, renderbuffer& renderbuffer, bool transient = false,
+                    std::source_location call_site = std::source_location::current());
+        void detach(attachment attachment, std::source_location call_site = std::source_location::current());
+
+        void set_draw_buffers(std::initializer_list<attachment> attachments,
+                              std::source_location call_site = std::source_location::current());
+        void set_draw_buffers(std::span<const attachment> attachments,
+                              std::source_location call_site = std::source_location::current());
+
+        status check_status();
+        bool complete();
+
+        void invalidate(std::initializer_list<attachment> attachments,
+                        std::source_location call_site = std::source_location::current());
+        void discard(std::source_location call_site = std::source_location::current());
+
+        /**
+         * Copies the whole framebuffer into `target`, or into the default framebuffer when `target` is null.
+         * Blitting from a multisample framebuffer into a single-sample one resolves it.
+         * Leaves `target` bound as the draw framebuffer.
+         */
+        void blit(framebuffer* target, buffer_bit mask, blit_filter filter = blit_filter::nearest);
+        // Copies the `width` x `height` region at the origin, stretched to `target_width` x `target_height`.
+        void blit(framebuffer* target, buffer_bit mask, std::int32_t width, std::int32_t height,
+                  std::int32_t target_width, std::int32_t target_height, blit_filter filter = blit_filter::nearest,
+                  std::source_location call_site = std::source_location::current());
+
+        std::int32_t width() const;
+        std::int32_t height() const;
+
+        static std::string to_string(const status& status);
+
+    private:
+        struct framebuffer_private;
+        std::unique_ptr<framebuffer_private> p;
+    };
+}
+
+#endif // TINYGL_FRAMEBUFFER_H
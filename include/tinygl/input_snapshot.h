@@ -0,0 +1,76 @@
+#ifndef TINYGL_INPUT_SNAPSHOT_H
+#define TINYGL_INPUT_SNAPSHOT_H
+
+#include "tinygl/input.h"
+#include "tinygl/keyboard.h"
+#include "tinygl/mouse.h"
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace tinygl::input
+{
+    enum class event_type {
+        key,
+        character,
+        mouse_button,
+        cursor_pos,
+        cursor_enter,
+        scroll,
+        focus,
+        resize
+    };
+
+    // Only the fields listed next to each member are meaningful for a given type.
+    struct event
+    {
+        event_type type = event_type::key;
+        double time = 0.0;                                      // tinygl::get_time() when GLFW reported it
+        keyboard::key key = keyboard::key::unknown;             // key
+        std::int32_t scancode = 0;                              // key
+        mouse::button button = mouse::button::left;             // mouse_button
+        input::action action = input::action::release;          // key, mouse_button
+        input::modifier mods{};                                 // key, mouse_button
+        std::uint32_t codepoint = 0;                            // character
+        bool entered = false;                                   // cursor_enter, focus
+        double x = 0.0;                                         // cursor_pos, scroll
+        double y = 0.0;                                         // cursor_pos, scroll
+        std::int32_t width = 0;                                 // resize, in framebuffer pixels
+        std::int32_t height = 0;                                // resize
+    };
+
+    /**
+     * The input state at the start of a frame together with every event that led to it since the previous frame,
+     * in the order they arrived. It does not change while the frame is processed.
+     */
+    struct snapshot
+    {
+        std::uint64_t frame = 0;
+        double time = 0.0;
+        std::bitset<GLFW_KEY_LAST + 1> keys;
+        std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttons;
+        input::modifier mods{};
+        double cursor_x = 0.0;
+        double cursor_y = 0.0;
+        // Summed over this frame's events.
+        double scroll_x = 0.0;
+        double scroll_y = 0.0;
+        std::int32_t framebuffer_width = 0;
+        std::int32_t framebuffer_height = 0;
+        bool focused = true;
+        std::vector<event> events;
+
+        bool down(keyboard::key key) const
+        {
+            auto index = static_cast<int>(key);
+            return index >= 0 && index <= GLFW_KEY_LAST && keys.test(static_cast<std::size_t>(index));
+        }
+
+        bool down(mouse::button button) const
+        {
+            return buttons.test(static_cast<std::size_t>(button));
+        }
+    };
+}
+
+#endif // TINYGL_INPUT_SNAPSHOT_H
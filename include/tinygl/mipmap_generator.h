@@ -0,0 +1,78 @@
+#ifndef TINYGL_MIPMAP_GENERATOR_H
+#define TINYGL_MIPMAP_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace tinygl
+{
+    // 8-bit image with 1 to 4 interleaved channels and tightly packed rows.
+    struct image_view
+    {
+        const std::uint8_t* pixels;
+        std::int32_t width;
+        std::int32_t height;
+        std::int32_t channels;
+    };
+
+    struct image_level
+    {
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+        std::int32_t channels = 0;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    enum class mipmap_filter {
+        box,     // 2x2 average
+        kaiser   // Kaiser-windowed sinc over 8x8 texels; sharper, with less aliasing than box
+    };
+
+    struct mipmap_settings
+    {
+        mipmap_filter filter = mipmap_filter::kaiser;
+        // The first three channels are sRGB encoded and get filtered in linear space.
+        bool srgb = false;
+        // If positive, the alpha of every level is scaled so that the fraction of texels passing an alpha test
+        // against this reference matches the base level; keeps cutouts such as foliage from thinning out.
+        float alpha_cutoff = 0.0f;
+        // Including the base level; 0 builds the full chain down to 1x1.
+        std::int32_t level_count = 0;
+    };
+
+    /**
+     * Builds mip chains on the CPU instead of relying on glGenerateMipmap, whose filtering and sRGB handling depend
+     * on the driver. Each level is filtered from the previous one, kept in floating point and clamped at the edges;
+     * filtering uses SSE2 where available. The rows of all images given to one generate() call are spread over the
+     * generator's threads. generate() may be called from several threads at once.
+     */
+    class mipmap_generator final
+    {
+    public:
+        explicit mipmap_generator(std::size_t thread_count = std::thread::hardware_concurrency());
+        ~mipmap_generator();
+
+        mipmap_generator(mipmap_generator&& other) noexcept;
+        mipmap_generator& operator=(mipmap_generator&& other) noexcept;
+
+        mipmap_generator(const mipmap_generator&) = delete;
+        mipmap_generator& operator=(const mipmap_generator&) = delete;
+
+        // Returns the levels below `image`, i.e. level 1 first; the base level is not copied.
+        std::vector<image_level> generate(const image_view& image, const mipmap_settings& settings = {});
+        std::vector<std::vector<image_level>> generate(
+            std::span<const image_view> images, const mipmap_settings& settings = {});
+
+        static std::int32_t full_level_count(std::int32_t width, std::int32_t height);
+
+    private:
+        struct mipmap_generator_private;
+        std::unique_ptr<mipmap_generator_private> p;
+    };
+}
+
+#endif // TINYGL_MIPMAP_GENERATOR_H
@@ -0,0 +1,106 @@
+#ifndef TINYGL_RENDER_TARGET_H
+#define TINYGL_RENDER_TARGET_H
+
+#include "tinygl/buffer_bit.h"
+#include "tinygl/framebuffer.h"
+#include "tinygl/texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <source_location>
+#include <tuple>
+#include <vector>
+
+namespace tinygl
+{
+    /**
+     * An offscreen framebuffer that follows the size of an output, usually the window. Storage is allocated in
+     * buckets of `granularity` pixels and only reallocated, on first use after a resize, when the scaled size
+     * leaves its bucket. Only the lower left width() x height() pixels are rendered to.
+     */
+    class render_target final
+    {
+    public:
+        struct attachment_spec
+        {
+            framebuffer::attachment attachment;
+            texture::internal_format internal_format;
+            bool sampled = true;     // a texture; otherwise a renderbuffer, which cannot be sampled
+            bool transient = false;  // see framebuffer::attach()
+        };
+
+        render_target(
+            std::vector<attachment_spec> attachments,
+            float scale = 1.0f,
+            std::int32_t samples = 0,
+            std::int32_t granularity = 64);
+        ~render_target();
+
+        render_target(render_target&& other) noexcept;
+        render_target& operator=(render_target&& other) noexcept;
+
+        render_target(const render_target&) = delete;
+        render_target& operator=(const render_target&) = delete;
+
+        // Size of the output; the storage follows on the next bind(), get_framebuffer() or get_texture().
+        void resize(std::int32_t width, std::int32_t height);
+
+        // Binds the framebuffer and sets the viewport to width() x height().
+        void bind(std::source_location call_site = std::source_location::current());
+        // Binds the default framebuffer and sets the viewport back to the output size.
+        void unbind(std::source_location call_site = std::source_location::current());
+
+        framebuffer& get_framebuffer();
+        // Null for renderbuffer attachments.
+        texture* get_texture(framebuffer::attachment attachment);
+
+        std::int32_t width() const;
+        std::int32_t height() const;
+        // Fraction of the storage in use, to scale texture coordinates with when sampling the attachments.
+        std::tuple<float, float> uv_scale() const;
+
+        // Copies the rendered region into `target`, or into the default framebuffer, stretched to the output size.
+        void blit(framebuffer* target, buffer_bit mask,
+                  framebuffer::blit_filter filter = framebuffer::blit_filter::nearest);
+
+        std::uint64_t reallocation_count() const;
+
+    private:
+        struct render_target_private;
+        std::unique_ptr<render_target_private> p;
+    };
+
+    /**
+     * The window's size-dependent render targets. Targets are shared with the caller and only weakly referenced;
+     * they drop out of the registry with their last owner.
+     */
+    class render_target_registry final
+    {
+    public:
+        render_target_registry();
+        ~render_target_registry();
+
+        render_target_registry(render_target_registry&& other) noexcept;
+        render_target_registry& operator=(render_target_registry&& other) noexcept;
+
+        render_target_registry(const render_target_registry&) = delete;
+        render_target_registry& operator=(const render_target_registry&) = delete;
+
+        std::shared_ptr<render_target> create(
+            std::vector<render_target::attachment_spec> attachments, float scale = 1.0f, std::int32_t samples = 0);
+
+        // Bucket size for targets created afterwards.
+        void set_granularity(std::int32_t pixels);
+
+        // Called by the window once per frame at most, when the framebuffer size has settled.
+        void resize(std::int32_t width, std::int32_t height);
+
+        std::size_t size();
+
+    private:
+        struct render_target_registry_private;
+        std::unique_ptr<render_target_registry_private> p;
+    };
+}
+
+#endif // TINYGL_RENDER_TARGET_H
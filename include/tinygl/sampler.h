@@ -0,0 +1,75 @@
+#ifndef TINYGL_SAMPLER_H
+#define TINYGL_SAMPLER_H
+
+#include "tinygl/color.h"
+#include "tinygl/texture.h"
+#include <cstdint>
+#include <memory>
+#include <source_location>
+
+namespace tinygl
+{
+    enum class compare_func : std::uint32_t {
+        gl_never,
+        gl_less,
+        gl_equal,
+        gl_lequal,
+        gl_greater,
+        gl_notequal,
+        gl_gequal,
+        gl_always
+    };
+
+    // Sampling parameters; the defaults are OpenGL's, except for the single-level linear minification filter.
+    struct sampler_state
+    {
+        texture::wrap_mode wrap_s = texture::wrap_mode::gl_repeat;
+        texture::wrap_mode wrap_t = texture::wrap_mode::gl_repeat;
+        texture::wrap_mode wrap_r = texture::wrap_mode::gl_repeat;
+        texture::filter min_filter = texture::filter::linear;
+        texture::filter mag_filter = texture::filter::linear;
+        // Clamped to GL_MAX_TEXTURE_MAX_ANISOTROPY; ignored without anisotropic filtering support.
+        float max_anisotropy = 1.0f;
+        float lod_bias = 0.0f;
+        float min_lod = -1000.0f;
+        float max_lod = 1000.0f;
+        // Depth comparison for shadow samplers.
+        bool compare = false;
+        tinygl::compare_func compare_func = tinygl::compare_func::gl_lequal;
+        color border_color = {0.0f, 0.0f, 0.0f, 0.0f};
+
+        bool operator==(const sampler_state&) const = default;
+    };
+
+    /**
+     * Sampler object: sampling state kept apart from the texture, so one texture can be sampled in several ways.
+     * A sampler bound to a unit overrides the wrap and filter settings of whatever texture is bound there. The
+     * state is fixed at construction, which lets a sampler_cache share samplers.
+     */
+    class sampler final
+    {
+    public:
+        explicit sampler(const sampler_state& state = {},
+                         std::source_location call_site = std::source_location::current());
+        ~sampler();
+
+        sampler(sampler&& other) noexcept;
+        sampler& operator=(sampler&& other) noexcept;
+
+        sampler(const sampler&) = delete;
+        sampler& operator=(const sampler&) = delete;
+
+        // Binding a sampler leaves the texture bindings and the active texture unit alone.
+        void bind(std::uint32_t unit, std::source_location call_site = std::source_location::current()) const;
+        // Returns `unit` to the parameters of the texture bound there.
+        static void unbind(std::uint32_t unit, std::source_location call_site = std::source_location::current());
+
+        const sampler_state& state() const;
+
+    private:
+        struct sampler_private;
+        std::unique_ptr<sampler_private> p;
+    };
+}
+
+#endif // TINYGL_SAMPLER_H
@@ -0,0 +1,42 @@
+#ifndef TINYGL_SAMPLER_CACHE_H
+#define TINYGL_SAMPLER_CACHE_H
+
+#include "tinygl/sampler.h"
+#include <cstddef>
+#include <memory>
+#include <source_location>
+
+namespace tinygl
+{
+    /**
+     * Creates one sampler per distinct sampler_state: materials asking for the same sampling share a GL object,
+     * which also makes binding it for the next draw a no-op when the previous one used the same state.
+     */
+    class sampler_cache final
+    {
+    public:
+        sampler_cache();
+        ~sampler_cache();
+
+        sampler_cache(sampler_cache&& other) noexcept;
+        sampler_cache& operator=(sampler_cache&& other) noexcept;
+
+        sampler_cache(const sampler_cache&) = delete;
+        sampler_cache& operator=(const sampler_cache&) = delete;
+
+        // The reference stays valid until clear() or the cache is destroyed.
+        const sampler& get(const sampler_state& state);
+        // Shorthand for get(state).bind(unit).
+        void bind(std::uint32_t unit, const sampler_state& state,
+                  std::source_location call_site = std::source_location::current());
+
+        std::size_t size() const;
+        void clear();
+
+    private:
+        struct sampler_cache_private;
+        std::unique_ptr<sampler_cache_private> p;
+    };
+}
+
+#endif // TINYGL_SAMPLER_CACHE_H
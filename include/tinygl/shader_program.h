@@ -5,6 +5,7 @@
 #include <tinyla/mat.hpp>
 #include <tinyla/vec.hpp>
 #include <memory>
+#include <source_location>
 
 namespace tinygl
 {
@@ -17,46 +18,68 @@ namespace tinygl
         shader_program(shader_program&& other) noexcept;
         shader_program& operator=(shader_program&& other) noexcept;
 
-        void add_shader(const std::shared_ptr<shader>& shader);
+        void add_shader(const std::shared_ptr<shader>& shader,
+                        std::source_location call_site = std::source_location::current());
         void add_shader_from_source_code(shader::type type, std::string_view source);
         void add_shader_from_source_file(shader::type type, const std::filesystem::path& file_name);
-        void remove_shader(std::shared_ptr<shader> shader);
+        void remove_shader(std::shared_ptr<shader> shader,
+                           std::source_location call_site = std::source_location::current());
 
         int attribute_location(std::string_view name) const;
         int uniform_location(std::string_view name) const;
 
-        void set_uniform_value(int location, float value);
-        void set_uniform_value(int location, std::int32_t value);
-        void set_uniform_value(int location, std::uint32_t value);
-        void set_uniform_value(int location, float x, float y);
-        void set_uniform_value(int location, float x, float y, float z);
-        void set_uniform_value(int location, float x, float y, float z, float w);
+        void set_uniform_value(int location, float value,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, std::int32_t value,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, std::uint32_t value,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, float x, float y,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, float x, float y, float z,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, float x, float y, float z, float w,
+                               std::source_location call_site = std::source_location::current());
 
-        void set_uniform_value(int location, const tinyla::vec2f& v);
-        void set_uniform_value(int location, const tinyla::vec3f& v);
-        void set_uniform_value(int location, const tinyla::vec4f& v);
+        void set_uniform_value(int location, const tinyla::vec2f& v,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, const tinyla::vec3f& v,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, const tinyla::vec4f& v,
+                               std::source_location call_site = std::source_location::current());
 
-        void set_uniform_value(int location, const tinyla::mat4f& m);
-        void set_uniform_value(int location, const float m[4][4]);
-        void set_uniform_value(int location, const float m[16]);
+        void set_uniform_value(int location, const tinyla::mat4f& m,
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, const float m[4][4],
+                               std::source_location call_site = std::source_location::current());
+        void set_uniform_value(int location, const float m[16],
+                               std::source_location call_site = std::source_location::current());
 
-        void set_attribute_value(int location, float value);
-        void set_attribute_value(int location, float x, float y);
-        void set_attribute_value(int location, float x, float y, float z);
-        void set_attribute_value(int location, float x, float y, float z, float w);
+        void set_attribute_value(int location, float value,
+                                 std::source_location call_site = std::source_location::current());
+        void set_attribute_value(int location, float x, float y,
+                                 std::source_location call_site = std::source_location::current());
+        void set_attribute_value(int location, float x, float y, float z,
+                                 std::source_location call_site = std::source_location::current());
+        void set_attribute_value(int location, float x, float y, float z, float w,
+                                 std::source_location call_site = std::source_location::current());
 
-        void set_attribute_value(int location, const tinyla::vec2f& v);
-        void set_attribute_value(int location, const tinyla::vec3f& v);
-        void set_attribute_value(int location, const tinyla::vec4f& v);
+        void set_attribute_value(int location, const tinyla::vec2f& v,
+                                 std::source_location call_site = std::source_location::current());
+        void set_attribute_value(int location, const tinyla::vec3f& v,
+                                 std::source_location call_site = std::source_location::current());
+        void set_attribute_value(int location, const tinyla::vec4f& v,
+                                 std::source_location call_site = std::source_location::current());
 
         template<typename T>
-        void set_uniform_value(std::string_view name, T value)
+        void set_uniform_value(
+            std::string_view name, T value, std::source_location call_site = std::source_location::current())
         {
-            set_uniform_value(uniform_location(name), value);
+            set_uniform_value(uniform_location(name), value, call_site);
         }
 
-        void link();
-        void use();
+        void link(std::source_location call_site = std::source_location::current());
+        void use(std::source_location call_site = std::source_location::current());
     private:
         struct shader_program_private;
         std::unique_ptr<shader_program_private> p;
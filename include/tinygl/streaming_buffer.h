@@ -0,0 +1,64 @@
+#ifndef TINYGL_STREAMING_BUFFER_H
+#define TINYGL_STREAMING_BUFFER_H
+
+#include "tinygl/buffer.h"
+#include <cstddef>
+#include <memory>
+#include <source_location>
+
+namespace tinygl
+{
+    /**
+     * Ring buffer for data that is rewritten every frame (UI geometry, per-frame uniforms, ...). The buffer is split
+     * into one region per frame in flight; each frame writes into its own region, which is fenced at the end of the
+     * frame and only reused once the GPU is done with it. With ARB_buffer_storage the whole buffer stays persistently
+     * mapped, so writes go straight to memory the GPU reads; otherwise each region is uploaded with glBufferSubData.
+     */
+    class streaming_buffer final
+    {
+    public:
+        struct allocation
+        {
+            void* data;          // write-only, valid until end_frame()
+            std::size_t offset;  // from the start of the buffer, for attribute pointers and draw calls
+        };
+
+        streaming_buffer(buffer::binding_target binding_target, std::size_t frame_capacity,
+                         std::size_t frames_in_flight = 3,
+                         std::source_location call_site = std::source_location::current());
+        ~streaming_buffer();
+
+        streaming_buffer(streaming_buffer&& other) noexcept;
+        streaming_buffer& operator=(streaming_buffer&& other) noexcept;
+
+        streaming_buffer(const streaming_buffer&) = delete;
+        streaming_buffer& operator=(const streaming_buffer&) = delete;
+
+        void bind(std::source_location call_site = std::source_location::current());
+        // The same storage can be bound to several targets, e.g. vertices and indices in one buffer.
+        void bind(buffer::binding_target binding_target,
+                  std::source_location call_site = std::source_location::current());
+
+        /**
+         * Starts writing the next region, waiting for the GPU only if it is still reading it. If `required_size`
+         * exceeds the region size the buffer is reallocated; its name changes, so bind it again afterwards.
+         */
+        void begin_frame(std::size_t required_size = 0,
+                         std::source_location call_site = std::source_location::current());
+        // Throws if the region is full.
+        allocation allocate(std::size_t size, std::size_t alignment = 16);
+        // Makes everything allocated so far visible to the GPU; call it before the draws that read the data.
+        void flush(std::source_location call_site = std::source_location::current());
+        // Fences the region; call it after the last draw that reads from it.
+        void end_frame(std::source_location call_site = std::source_location::current());
+
+        std::size_t frame_capacity() const;
+        bool persistent() const;
+
+    private:
+        struct streaming_buffer_private;
+        std::unique_ptr<streaming_buffer_private> p;
+    };
+}
+
+#endif // TINYGL_STREAMING_BUFFER_H
@@ -1,13 +1,19 @@
 #ifndef TINYGL_TEXTURE_H
 #define TINYGL_TEXTURE_H
 
+#include "tinygl/data_types.h"
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <source_location>
 #include <string>
 
 namespace tinygl
 {
+    class buffer;
+    class compressed_image;
+
     class texture final
     {
     public:
@@ -132,7 +138,22 @@ namespace tinygl
             gl_compressed_rgba_bptc_unorm,
             gl_compressed_srgb_alpha_bptc_unorm,
             gl_compressed_rgb_bptc_signed_float,
-            gl_compressed_rgb_bptc_unsigned_float
+            gl_compressed_rgb_bptc_unsigned_float,
+            // EXT_texture_compression_s3tc (BC1-BC3), sRGB variants need EXT_texture_sRGB
+            gl_compressed_rgb_s3tc_dxt1_ext,
+            gl_compressed_rgba_s3tc_dxt1_ext,
+            gl_compressed_rgba_s3tc_dxt3_ext,
+            gl_compressed_rgba_s3tc_dxt5_ext,
+            gl_compressed_srgb_s3tc_dxt1_ext,
+            gl_compressed_srgb_alpha_s3tc_dxt1_ext,
+            gl_compressed_srgb_alpha_s3tc_dxt3_ext,
+            gl_compressed_srgb_alpha_s3tc_dxt5_ext,
+            // sized depth and stencil formats
+            gl_depth_component16,
+            gl_depth_component24,
+            gl_depth_component32f,
+            gl_depth24_stencil8,
+            gl_depth32f_stencil8
         };
 
         enum class format : std::uint32_t {
@@ -153,41 +174,146 @@ namespace tinygl
             gl_depth_stencil
         };
 
+        /**
+         * Immutable storage; the fields a target does not use are ignored. Base internal formats are allocated
+         * with a sized equivalent (gl_rgb as gl_rgb8, gl_depth_component as gl_depth_component24, ...); generic
+         * compressed formats cannot be allocated this way and throw std::invalid_argument.
+         */
+        struct storage
+        {
+            texture::target target = texture::target::gl_texture_2d;
+            texture::internal_format internal_format = texture::internal_format::gl_rgba8;
+            // Layers of gl_texture_1d_array; cube maps have to be square.
+            std::int32_t width = 1;
+            std::int32_t height = 1;
+            // Depth of gl_texture_3d, layers of 2D arrays, layer-faces (6 per cube) of gl_texture_cube_map_array.
+            std::int32_t depth = 1;
+            // 0 allocates the full mip chain. Rectangle, multisample and buffer textures have one level.
+            std::int32_t levels = 1;
+            // Multisample targets only.
+            std::int32_t samples = 0;
+            bool fixed_sample_locations = true;
+            // gl_texture_buffer only: the texels are read from this range of `buffer`, size 0 meaning up to its end.
+            // The offset has to be a multiple of GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT.
+            const tinygl::buffer* buffer = nullptr;
+            std::size_t buffer_offset = 0;
+            std::size_t buffer_size = 0;
+        };
+
+        /**
+         * Loads an 8-bit image into immutable storage with room for the full mip chain, which generate_mipmaps()
+         * fills. gl_texture_2d and gl_texture_rectangle take the image as is; for gl_texture_2d_array and
+         * gl_texture_cube_map it is a column of square layers or faces (+X, -X, +Y, -Y, +Z, -Z), top to bottom.
+         * Other targets throw std::invalid_argument.
+         */
         texture(
             target target,
             const std::filesystem::path& file_name,
             internal_format internal_format,
             format format,
-            std::uint32_t unit);
+            std::uint32_t unit,
+            std::source_location call_site = std::source_location::current());
+        /**
+         * Allocates storage without uploading any pixels, e.g. for render targets.
+         * Same as texture(storage{target, internal_format, width, height, 1, levels, samples}, unit).
+         */
+        texture(
+            target target,
+            internal_format internal_format,
+            std::int32_t width,
+            std::int32_t height,
+            std::uint32_t unit,
+            std::int32_t samples = 0,
+            std::int32_t levels = 1,
+            std::source_location call_site = std::source_location::current());
+        /**
+         * Allocates immutable storage described by `storage`, for any target, without uploading any pixels. A buffer
+         * texture is attached to its buffer instead and sees the buffer's contents.
+         */
+        texture(const storage& storage, std::uint32_t unit,
+                std::source_location call_site = std::source_location::current());
+        /**
+         * Uploads the blocks and all mip levels of `image` as they are, into immutable gl_texture_2d storage.
+         * S3TC formats need EXT_texture_compression_s3tc.
+         */
+        texture(const compressed_image& image, std::uint32_t unit,
+                std::source_location call_site = std::source_location::current());
         ~texture();
 
         texture(texture&& other) noexcept;
         texture& operator=(texture&& other) noexcept;
 
-        void bind();
-        void unbind();
+        void bind(std::source_location call_site = std::source_location::current());
+        void unbind(std::source_location call_site = std::source_location::current());
+
+        void generate_mipmaps(std::source_location call_site = std::source_location::current());
 
-        void generate_mipmaps();
+        /**
+         * Replaces a region of `level`. With a buffer bound to gl_pixel_unpack_buffer, `pixels` is an offset into
+         * that buffer and the copy happens asynchronously. The texture has to be bound.
+         * For gl_texture_2d, gl_texture_rectangle and gl_texture_1d_array, where `y` and `height` count layers.
+         */
+        void update(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height,
+                    format format, data_type type, const void* pixels,
+                    std::source_location call_site = std::source_location::current());
+        // For gl_texture_1d.
+        void update(std::int32_t level, std::int32_t x, std::int32_t width, format format, data_type type,
+                    const void* pixels, std::source_location call_site = std::source_location::current());
+        /**
+         * For gl_texture_3d and the 2D and cube map arrays, where `z` and `depth` count layers or layer-faces. For
+         * gl_texture_cube_map, `z` selects the face in the order +X, -X, +Y, -Y, +Z, -Z and `depth` has to be 1.
+         */
+        void update(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t z, std::int32_t width,
+                    std::int32_t height, std::int32_t depth, format format, data_type type, const void* pixels,
+                    std::source_location call_site = std::source_location::current());
+        // Same for compressed formats; x, y, width and height are multiples of the block size unless at the edge.
+        void update_compressed(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t width,
+                               std::int32_t height, internal_format internal_format, std::size_t size,
+                               const void* data,
+                               std::source_location call_site = std::source_location::current());
+        void update_compressed(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t z,
+                               std::int32_t width, std::int32_t height, std::int32_t depth,
+                               internal_format internal_format, std::size_t size, const void* data,
+                               std::source_location call_site = std::source_location::current());
 
-        void set_wrap_mode(wrap_mode mode);
-        void set_wrap_mode(coordinate direction, wrap_mode mode);
+        // Sampling parameters of the texture itself; a sampler bound to the same unit takes precedence.
+        void set_wrap_mode(wrap_mode mode, std::source_location call_site = std::source_location::current());
+        void set_wrap_mode(coordinate direction, wrap_mode mode,
+                           std::source_location call_site = std::source_location::current());
         wrap_mode get_wrap_mode(coordinate direction) const;
 
-        void set_minification_filter(filter filter);
+        void set_minification_filter(filter filter, std::source_location call_site = std::source_location::current());
         filter minification_filter() const;
 
-        void set_magnification_filter(filter filter);
+        void set_magnification_filter(filter filter, std::source_location call_site = std::source_location::current());
         filter magnification_filter() const;
 
-        void set_min_mag_filters(filter minification_filter, filter magnification_filter);
+        void set_min_mag_filters(filter minification_filter, filter magnification_filter,
+                                 std::source_location call_site = std::source_location::current());
         std::pair<filter, filter> min_mag_filters() const;
 
+        std::int32_t width() const;
+        std::int32_t height() const;
+        // As given in the storage: depth, layers or layer-faces; 1 for the other targets.
+        std::int32_t depth() const;
+        std::int32_t levels() const;
+        texture::target get_target() const;
+        // The format the storage was allocated with, e.g. the block format of a compressed image.
+        texture::internal_format get_internal_format() const;
+
         static std::string to_string(const coordinate& direction);
         static std::string to_string(const target& target);
 
     private:
+        std::uint32_t id() const;
+        // Unlike GL names, never reused within a process.
+        std::uint64_t serial() const;
+
         struct texture_private;
         std::unique_ptr<texture_private> p;
+
+        friend class framebuffer;
+        friend class texture_unit_manager;
     };
 }
 
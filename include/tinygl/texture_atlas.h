@@ -0,0 +1,76 @@
+#ifndef TINYGL_TEXTURE_ATLAS_H
+#define TINYGL_TEXTURE_ATLAS_H
+
+#include "tinygl/mipmap_generator.h"
+#include "tinygl/texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <source_location>
+
+namespace tinygl
+{
+    /**
+     * Packs many small images into one texture, the layers of a gl_texture_2d_array or a single gl_texture_2d, so
+     * that a batch of sprites or UI elements draws with one binding. Images are placed largest first with a skyline
+     * bottom-left packer and surrounded by a gutter that repeats their edge texels. With several mip levels,
+     * positions and sizes are aligned to 2^(levels - 1) texels and levels are box filtered, so no level mixes
+     * texels of neighbouring images.
+     */
+    class texture_atlas final
+    {
+    public:
+        struct region
+        {
+            // Texture coordinates of the image without its gutter; v follows the row order of the added pixels.
+            float u0, v0, u1, v1;
+            // Always 0 for gl_texture_2d.
+            std::int32_t layer;
+            // In texels of the base level.
+            std::int32_t x, y, width, height;
+        };
+
+        /**
+         * `target` is gl_texture_2d_array or gl_texture_2d; every layer, or the one texture, is `width` by `height`
+         * texels, which have to be multiples of the alignment. `format` gives the channel count of added images.
+         */
+        texture_atlas(
+            texture::target target,
+            texture::internal_format internal_format,
+            texture::format format,
+            std::int32_t width,
+            std::int32_t height,
+            std::int32_t padding = 2,
+            std::int32_t levels = 1);
+        ~texture_atlas();
+
+        texture_atlas(texture_atlas&& other) noexcept;
+        texture_atlas& operator=(texture_atlas&& other) noexcept;
+
+        texture_atlas(const texture_atlas&) = delete;
+        texture_atlas& operator=(const texture_atlas&) = delete;
+
+        // Copies the image and returns the id of its region; ids are assigned in order, starting at 0.
+        std::size_t add(const image_view& image);
+        // Decodes the file, flipped vertically like texture's constructor does.
+        std::size_t add(const std::filesystem::path& file_name);
+
+        /**
+         * Packs all images added so far and uploads them into a new texture on `unit`. Regions are valid from then
+         * on. Throws if the images do not fit into one texture, or into GL_MAX_ARRAY_TEXTURE_LAYERS layers.
+         */
+        void build(std::uint32_t unit, std::source_location call_site = std::source_location::current());
+
+        texture& get_texture();
+        const region& get_region(std::size_t id) const;
+        std::size_t size() const;
+        std::int32_t layer_count() const;
+
+    private:
+        struct texture_atlas_private;
+        std::unique_ptr<texture_atlas_private> p;
+    };
+}
+
+#endif // TINYGL_TEXTURE_ATLAS_H
@@ -0,0 +1,93 @@
+#ifndef TINYGL_TEXTURE_LOADER_H
+#define TINYGL_TEXTURE_LOADER_H
+
+#include "tinygl/color.h"
+#include "tinygl/mipmap_generator.h"
+#include "tinygl/texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <source_location>
+#include <string>
+
+namespace tinygl
+{
+    /**
+     * Shared reference to a texture that may still be loading. Until it is ready, get() returns a 1x1 placeholder
+     * on the same texture unit, so it can be bound unconditionally.
+     */
+    class texture_handle final
+    {
+    public:
+        enum class status {
+            loading,
+            ready,
+            failed  // the placeholder stays; error() tells why
+        };
+
+        texture_handle();
+
+        texture& get() const;
+        status get_status() const;
+        bool ready() const;
+        std::string error() const;
+        // Number of handles sharing the texture, including those held by the loader while it is loading.
+        long use_count() const;
+
+        explicit operator bool() const;
+
+    private:
+        struct texture_handle_private;
+        std::shared_ptr<texture_handle_private> p;
+
+        friend class texture_loader;
+    };
+
+    /**
+     * Loads image files without stalling the render thread. Worker threads decode them; update(), called once per
+     * frame on the thread that owns the context, copies up to `bytes_per_frame` of decoded rows into a pixel-unpack
+     * buffer and lets the driver upload them from there. Large images are spread over several frames.
+     */
+    class texture_loader final
+    {
+    public:
+        explicit texture_loader(
+            std::size_t bytes_per_frame = 16 << 20,
+            std::size_t worker_count = 2,
+            color placeholder = {0.5f, 0.5f, 0.5f, 1.0f});
+        ~texture_loader();
+
+        texture_loader(const texture_loader&) = delete;
+        texture_loader& operator=(const texture_loader&) = delete;
+
+        /**
+         * Only gl_texture_2d is supported. The decoded channel count follows `format`. Files are decoded from a
+         * memory mapping; .ktx2 and .dds files are not decoded at all but uploaded block-compressed straight from
+         * it, with the internal format and mip levels stored in the file.
+         */
+        texture_handle load(
+            const std::filesystem::path& file_name,
+            texture::internal_format internal_format,
+            texture::format format,
+            std::uint32_t unit = 0);
+
+        void update(std::source_location call_site = std::source_location::current());
+
+        void set_bytes_per_frame(std::size_t bytes);
+        /**
+         * With settings, textures loaded from then on get a full mip chain built by the workers, see
+         * mipmap_generator; `srgb` is taken from the internal format. Without, the default, they have one level.
+         */
+        void set_mipmap_settings(std::optional<mipmap_settings> settings);
+        // Textures requested but not uploaded yet, including those still being decoded.
+        std::size_t pending() const;
+
+    private:
+        struct texture_loader_private;
+        std::unique_ptr<texture_loader_private> p;
+    };
+}
+
+#endif // TINYGL_TEXTURE_LOADER_H
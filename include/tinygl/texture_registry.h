@@ -0,0 +1,67 @@
+#ifndef TINYGL_TEXTURE_REGISTRY_H
+#define TINYGL_TEXTURE_REGISTRY_H
+
+#include "tinygl/texture.h"
+#include "tinygl/texture_loader.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+
+namespace tinygl
+{
+    /**
+     * Loads every texture once: requests for the same file, by canonical path, with the same target and formats
+     * share one texture_handle. The registry keeps its textures after the last handle is dropped, until the GPU
+     * memory they use exceeds the budget; then the least recently requested unreferenced ones are released.
+     * Textures that are still referenced are never evicted, so the budget can be exceeded.
+     */
+    class texture_registry final
+    {
+    public:
+        struct statistics
+        {
+            std::size_t textures;    // loaded or loading
+            std::size_t referenced;  // held by at least one handle outside the registry
+            std::size_t gpu_bytes;   // of the loaded textures, estimated from their sizes and formats
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t evictions;
+        };
+
+        // `loader` has to outlive the registry.
+        explicit texture_registry(texture_loader& loader, std::size_t budget = std::numeric_limits<std::size_t>::max());
+        ~texture_registry();
+
+        texture_registry(texture_registry&& other) noexcept;
+        texture_registry& operator=(texture_registry&& other) noexcept;
+
+        texture_registry(const texture_registry&) = delete;
+        texture_registry& operator=(const texture_registry&) = delete;
+
+        // `unit` is only used when the texture is not loaded yet.
+        texture_handle acquire(
+            const std::filesystem::path& file_name,
+            texture::internal_format internal_format,
+            texture::format format,
+            std::uint32_t unit = 0,
+            texture::target target = texture::target::gl_texture_2d);
+
+        // Updates the loader, accounts newly loaded textures and evicts down to the budget. Once per frame.
+        void update();
+
+        void set_budget(std::size_t bytes);
+        std::size_t budget() const;
+        // Releases every texture that is not referenced outside the registry.
+        void evict_unused();
+
+        statistics get_statistics() const;
+
+    private:
+        struct texture_registry_private;
+        std::unique_ptr<texture_registry_private> p;
+    };
+}
+
+#endif // TINYGL_TEXTURE_REGISTRY_H
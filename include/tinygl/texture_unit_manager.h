@@ -0,0 +1,65 @@
+#ifndef TINYGL_TEXTURE_UNIT_MANAGER_H
+#define TINYGL_TEXTURE_UNIT_MANAGER_H
+
+#include "tinygl/shader_program.h"
+#include "tinygl/texture.h"
+#include <cstdint>
+#include <memory>
+#include <source_location>
+#include <string_view>
+
+namespace tinygl
+{
+    /**
+     * Assigns texture units to textures per draw instead of the fixed unit each texture is created with. Textures
+     * stay bound after a draw; binding one that is still resident only returns its unit, otherwise it replaces the
+     * least recently used texture whose unit is not needed by the current draw. Textures bound through the manager
+     * should not be bound to the managed units by other means, or invalidate() has to be called afterwards.
+     */
+    class texture_unit_manager final
+    {
+    public:
+        struct statistics
+        {
+            std::uint64_t binds;      // textures that had to be bound
+            std::uint64_t hits;       // textures that were already resident
+            std::uint64_t evictions;  // binds that replaced another texture
+        };
+
+        // Manages `unit_count` units starting at `first_unit`; 0 means all units up to
+        // GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, but at most the first 32, whose bindings tinygl caches.
+        explicit texture_unit_manager(std::uint32_t first_unit = 0, std::uint32_t unit_count = 0,
+                                      std::source_location call_site = std::source_location::current());
+        ~texture_unit_manager();
+
+        texture_unit_manager(texture_unit_manager&& other) noexcept;
+        texture_unit_manager& operator=(texture_unit_manager&& other) noexcept;
+
+        texture_unit_manager(const texture_unit_manager&) = delete;
+        texture_unit_manager& operator=(const texture_unit_manager&) = delete;
+
+        // Starts a draw: the units handed out before are free to be reused.
+        void begin_draw();
+
+        /**
+         * Makes `texture` resident and returns its unit, the value for its sampler uniform. Throws if the current
+         * draw already uses every managed unit.
+         */
+        std::uint32_t bind(texture& texture, std::source_location call_site = std::source_location::current());
+        // Also sets the sampler uniform `name` of `program`, which has to be in use.
+        std::uint32_t bind(texture& texture, shader_program& program, std::string_view name,
+                           std::source_location call_site = std::source_location::current());
+
+        // Drops all residency information, e.g. after binding textures with raw OpenGL calls.
+        void invalidate();
+
+        std::uint32_t unit_count() const;
+        statistics get_statistics() const;
+
+    private:
+        struct texture_unit_manager_private;
+        std::unique_ptr<texture_unit_manager_private> p;
+    };
+}
+
+#endif // TINYGL_TEXTURE_UNIT_MANAGER_H
@@ -3,31 +3,42 @@
 
 #include "tinygl/bitmask_operators.h"
 #include "tinygl/buffer.h"
+#include "tinygl/buffer_bit.h"
 #include "tinygl/color.h"
+#include "tinygl/compressed_image.h"
 #include "tinygl/data_types.h"
+#include "tinygl/debug_output.h"
+#include "tinygl/frame_capture.h"
+#include "tinygl/frame_stats.h"
+#include "tinygl/framebuffer.h"
 #include "tinygl/keyboard.h"
+#include "tinygl/mipmap_generator.h"
+#include "tinygl/render_target.h"
+#include "tinygl/sampler.h"
+#include "tinygl/sampler_cache.h"
 #include "tinygl/shader.h"
 #include "tinygl/shader_program.h"
+#include "tinygl/streaming_buffer.h"
 #include "tinygl/texture.h"
+#include "tinygl/texture_atlas.h"
+#include "tinygl/texture_loader.h"
+#include "tinygl/texture_registry.h"
+#include "tinygl/texture_unit_manager.h"
 #include "tinygl/vertex_array_object.h"
 #include "tinygl/window.h"
 #include <tinyla/mat.hpp>
 #include <tinyla/util.hpp>
 #include <tinyla/vec.hpp>
 #include "imgui.h"
+#include <source_location>
 
 namespace tinygl
 {
-    void gl_clear_color(const color& color);
+    void gl_clear_color(const color& color, std::source_location call_site = std::source_location::current());
 
-    enum class buffer_bit : std::uint32_t {
-        gl_color_buffer_bit   = 0x00004000,  // GL_COLOR_BUFFER_BIT
-        gl_depth_buffer_bit   = 0x00000100,  // GL_DEPTH_BUFFER_BIT
-        gl_stencil_buffer_bit = 0x00000400   // GL_STENCIL_BUFFER_BIT
-    };
-    void gl_clear(buffer_bit buffer_bit);
+    void gl_clear(buffer_bit buffer_bit, std::source_location call_site = std::source_location::current());
 
-    void gl_point_size(float size);
+    void gl_point_size(float size, std::source_location call_site = std::source_location::current());
 
     enum class mode : std::uint32_t {
         gl_points,
@@ -43,9 +54,12 @@ namespace tinygl
         gl_triangles_adjacency,
         gl_patches
     };
-    void gl_draw_arrays(mode mode, std::int32_t first, std::int32_t count);
-    void gl_draw_arrays_instanced(mode mode, std::int32_t first, std::int32_t count, std::int32_t instance_count);
-    void gl_draw_elements(mode mode, std::int32_t count, data_type type, const void* indices);
+    void gl_draw_arrays(mode mode, std::int32_t first, std::int32_t count,
+                        std::source_location call_site = std::source_location::current());
+    void gl_draw_arrays_instanced(mode mode, std::int32_t first, std::int32_t count, std::int32_t instance_count,
+                                  std::source_location call_site = std::source_location::current());
+    void gl_draw_elements(mode mode, std::int32_t count, data_type type, const void* indices,
+                          std::source_location call_site = std::source_location::current());
 
     enum struct capability : std::uint32_t {
         gl_blend,
@@ -82,7 +96,16 @@ namespace tinygl
         gl_texture_cube_map_seamless,
         gl_program_point_size
     };
-    void gl_enable(capability capability);
+    // Both go through tinygl's state cache and skip the GL call when the capability is already in that state.
+    void gl_enable(capability capability, std::source_location call_site = std::source_location::current());
+    void gl_disable(capability capability, std::source_location call_site = std::source_location::current());
+
+    /**
+     * tinygl remembers the capabilities, program, vertex array, blend setup, 2D texture and sampler bindings it sets,
+     * so it can skip redundant calls and restore state without glGet. Call this after changing any of them with raw
+     * OpenGL calls or after making a different context current.
+     */
+    void invalidate_state_cache();
 
     enum class depth_func : std::uint32_t {
         gl_never,
@@ -94,11 +117,19 @@ namespace tinygl
         gl_gequal,
         gl_always
     };
-    void gl_depth_func(depth_func depth_func);
+    void gl_depth_func(depth_func depth_func, std::source_location call_site = std::source_location::current());
 
-    void init(int major, int minor);
+    enum class context_flag : std::uint32_t {
+        none     = 0,
+        no_error = 1 << 0, // KHR_no_error: the driver skips error checking, tinygl validation is turned off
+        headless = 1 << 1  // no window system: EGL (surfaceless) or OSMesa context with a fixed-size framebuffer
+    };
+    void init(int major, int minor, context_flag flags = context_flag::none);
     void terminate();
 
+    // True when tinygl was initialized with context_flag::headless.
+    bool headless();
+
     template<std::floating_point T>
     T get_time();
 
@@ -110,11 +141,15 @@ namespace tinygl
     };
     const char* get_string(name name);
 
-    void check_opengl_errors();
+    // Explicit error check, active in every build type; debug builds already validate each tinygl call.
+    void check_opengl_errors(std::source_location location = std::source_location::current());
+    // Turns the per-call validation of debug builds off or on again, e.g. around measurements. Creating a window
+    // turns it on, unless the context is a KHR_no_error one.
+    void set_validation_enabled(bool enabled);
 }
 
 template<>
-    struct enable_bitmask_operators<tinygl::buffer_bit> {
+struct enable_bitmask_operators<tinygl::context_flag> {
     static constexpr bool enable = true;
 };
 
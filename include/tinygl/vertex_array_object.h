@@ -3,6 +3,7 @@
 
 #include "data_types.h"
 #include <memory>
+#include <source_location>
 
 namespace tinygl
 {
@@ -18,12 +19,13 @@ namespace tinygl
         vertex_array_object(vertex_array_object&& other) noexcept;
         vertex_array_object& operator=(vertex_array_object&& other) noexcept;
 
-        void bind();
-        void unbind();
+        void bind(std::source_location call_site = std::source_location::current());
+        void unbind(std::source_location call_site = std::source_location::current());
 
         void set_attribute_array(
-            int location, int tuple_size, data_type type, normalization normalization, int stride = 0, int offset = 0);
-        void enable_attribute_array(int location);
+            int location, int tuple_size, data_type type, normalization normalization, int stride = 0, int offset = 0,
+            std::source_location call_site = std::source_location::current());
+        void enable_attribute_array(int location, std::source_location call_site = std::source_location::current());
 
     private:
         struct vertex_array_object_private;
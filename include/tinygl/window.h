@@ -2,8 +2,10 @@
 #define TINYGL_WINDOW_H
 
 #include "tinygl/input.h"
+#include "tinygl/input_snapshot.h"
 #include "tinygl/keyboard.h"
 #include "tinygl/mouse.h"
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
@@ -11,6 +13,10 @@
 
 namespace tinygl
 {
+    class frame_capture;
+    class frame_stats;
+    class render_target_registry;
+
     class window
     {
     public:
@@ -19,14 +25,51 @@ namespace tinygl
         typedef std::function<void(
             tinygl::mouse::button, tinygl::input::action, tinygl::input::modifier)> mouse_button_callback;
 
-        window(int width, int height, std::string_view title, bool vsync = false);
+        enum class loop_mode {
+            uncapped,        // render as fast as possible (or as vsync allows)
+            frame_rate_cap,  // sleep, then spin-wait, until the next frame is due
+            fixed_timestep,  // update() in fixed steps, draw_interpolated() gets the leftover fraction of a step
+            on_demand        // block until input arrives, the redraw timeout expires or request_redraw() is called
+        };
+
+        enum class threading_mode {
+            single,        // events, drawing and swapping all happen on the thread that calls run()
+            render_thread  // run() only pumps events, a render thread owns the context and calls init(), draw(), ...
+        };
+
+        enum class vsync_mode {
+            off,
+            on,
+            adaptive  // swaps late frames immediately instead of waiting a whole refresh; falls back to `on`
+        };
+
+        /**
+         * Passing `share` puts the new context in the same share group: buffers, textures, shader programs and
+         * samplers created in one are usable in the other, vertex array objects and framebuffers are not.
+         */
+        window(int width, int height, std::string_view title, bool vsync = false, const window* share = nullptr);
         virtual ~window();
 
         window(window&& other) noexcept;
         window& operator=(window&& other) noexcept;
 
+        /**
+         * In threading_mode::render_thread, every virtual function is called on the render thread and the input
+         * queried there (get_key(), get_cursor_pos(), the sizes) is what the event thread last handed off.
+         * Objects created before run() should not be used from the render thread. Dear ImGui is fed from the same
+         * hand-off instead of its GLFW backend, so it cannot change the mouse cursor or read gamepads. Falls back to
+         * threading_mode::single on macOS, where windows may only be touched from the main thread.
+         */
+        void set_threading_mode(threading_mode mode);
         void run();
 
+        /**
+         * Input as it was at the start of the current frame, with the events of the previous frame. Only valid on
+         * the thread that renders and until the next frame starts; copy it to hand it to other threads.
+         */
+        const tinygl::input::snapshot& input_snapshot() const;
+
+        // Latest state handed off by the event thread; can be called from any thread.
         tinygl::keyboard::key_state get_key(tinygl::keyboard::key key);
 
         template<std::floating_point T>
@@ -42,20 +85,89 @@ namespace tinygl
 
         void set_should_close(bool should_close);
 
+        // Called while the events queued since the last frame are drained, not from inside GLFW.
         void set_key_callback(key_callback callback);
         void set_mouse_button_callback(mouse_button_callback callback);
 
+        // Every frame rendered by run(), including the UI, is handed to `capture`; nullptr stops capturing.
+        void set_frame_capture(std::shared_ptr<frame_capture> capture);
+        // Times every frame rendered by run(); the statistics are exported when run() returns.
+        void set_frame_stats(std::shared_ptr<frame_stats> stats);
+
+        // Where the baked UI font atlas is cached between runs; an empty path rebuilds it every time.
+        void set_font_cache_directory(const std::filesystem::path& directory);
+
+        void set_loop_mode(loop_mode mode);
+        void set_frame_rate_cap(double frames_per_second);
+        // `max_steps` bounds the catch-up work after a long frame, so a slow machine does not spiral.
+        void set_fixed_timestep(double seconds, int max_steps = 5);
+        // Applied at the start of the next frame when called from a thread that does not own the context.
+        void set_vsync(vsync_mode mode);
+
+        // Wakes a window in loop_mode::on_demand up for one more frame. Can be called from any thread.
+        void request_redraw();
+        // In loop_mode::on_demand, redraw at least every `seconds` even without input; zero waits indefinitely.
+        void set_redraw_timeout(double seconds);
+
         float delta_time() const;
 
+        // Render targets created here follow the framebuffer size of the window.
+        render_target_registry& render_targets();
+        /**
+         * resize() and the render targets only see a new size once it has not changed for `seconds`, so dragging
+         * a window edge does not rebuild them on every frame. The viewport always follows immediately.
+         */
+        void set_resize_settle_time(double seconds);
+
     protected:
         virtual void init() {}
+        // Called at the start of a frame when the framebuffer size changed, at most once per frame.
+        virtual void resize([[maybe_unused]] int width, [[maybe_unused]] int height) {}
         virtual void process_input() {}
+        // Called once per frame with the frame time, or zero or more times with the fixed timestep.
+        virtual void update([[maybe_unused]] double dt) {}
+        // `alpha` is how far between the last two fixed updates the frame is; 1 outside loop_mode::fixed_timestep.
+        virtual void draw_interpolated([[maybe_unused]] double alpha) { draw(); }
         virtual void draw() {}
         virtual void draw_ui() {}
 
     private:
         struct window_private;
         std::unique_ptr<window_private> p;
+
+        friend class window_group;
+    };
+
+    /**
+     * Renders several windows from one loop on the calling thread, typically one per monitor with contexts shared
+     * through the `share` constructor argument. Each pass renders every open window, then swaps them back to back:
+     * only the primary window waits for vsync and the others swap immediately, so N windows cost one vertical blank
+     * per frame instead of N. Secondary windows on monitors with a different refresh may tear.
+     */
+    class window_group final
+    {
+    public:
+        explicit window_group(bool vsync = true);
+        ~window_group();
+
+        window_group(window_group&& other) noexcept;
+        window_group& operator=(window_group&& other) noexcept;
+
+        window_group(const window_group&) = delete;
+        window_group& operator=(const window_group&) = delete;
+
+        /**
+         * The first window added is the primary one until it is closed. Windows are not owned and must stay in
+         * place until run() returns. Their swap intervals are set by the group; loop_mode::fixed_timestep is
+         * honoured per window, loop_mode::frame_rate_cap and loop_mode::on_demand are not.
+         */
+        void add(window& window);
+        // Returns once every window has been closed.
+        void run();
+
+    private:
+        struct window_group_private;
+        std::unique_ptr<window_group_private> p;
     };
 }
 
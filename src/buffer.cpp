@@ -1,49 +1,15 @@
 #include "tinygl/buffer.h"
+#include "buffer_utils.h"
+#include "validation.h"
 #include <GL/glew.h>
 
-namespace {
-    constexpr GLenum gl_enum(tinygl::buffer::binding_target target)
-    {
-        switch(target) {
-        case tinygl::buffer::binding_target::gl_array_buffer: return GL_ARRAY_BUFFER;
-        case tinygl::buffer::binding_target::gl_atomic_counter_buffer: return GL_ATOMIC_COUNTER_BUFFER;
-        case tinygl::buffer::binding_target::gl_copy_read_buffer: return GL_COPY_READ_BUFFER;
-        case tinygl::buffer::binding_target::gl_copy_write_buffer: return GL_COPY_WRITE_BUFFER;
-        case tinygl::buffer::binding_target::gl_dispatch_indirect_buffer: return GL_DISPATCH_INDIRECT_BUFFER;
-        case tinygl::buffer::binding_target::gl_draw_indirect_buffer: return GL_DRAW_INDIRECT_BUFFER;
-        case tinygl::buffer::binding_target::gl_element_array_buffer: return GL_ELEMENT_ARRAY_BUFFER;
-        case tinygl::buffer::binding_target::gl_pixel_pack_buffer: return GL_PIXEL_PACK_BUFFER;
-        case tinygl::buffer::binding_target::gl_pixel_unpack_buffer: return GL_PIXEL_UNPACK_BUFFER;
-        case tinygl::buffer::binding_target::gl_query_buffer: return GL_QUERY_BUFFER;
-        case tinygl::buffer::binding_target::gl_shader_storage_buffer: return GL_SHADER_STORAGE_BUFFER;
-        case tinygl::buffer::binding_target::gl_texture_buffer: return GL_TEXTURE_BUFFER;
-        case tinygl::buffer::binding_target::gl_transform_feedback_buffer: return GL_TRANSFORM_FEEDBACK_BUFFER;
-        case tinygl::buffer::binding_target::gl_uniform_buffer: return GL_UNIFORM_BUFFER;
-        }
-    }
-
-    constexpr GLenum gl_enum(tinygl::buffer::usage_pattern usage_pattern)
-    {
-        switch(usage_pattern) {
-        case tinygl::buffer::usage_pattern::gl_stream_draw: return GL_STREAM_DRAW;
-        case tinygl::buffer::usage_pattern::gl_stream_read: return GL_STREAM_READ;
-        case tinygl::buffer::usage_pattern::gl_stream_copy: return GL_STREAM_COPY;
-        case tinygl::buffer::usage_pattern::gl_static_draw: return GL_STATIC_DRAW;
-        case tinygl::buffer::usage_pattern::gl_static_read: return GL_STATIC_READ;
-        case tinygl::buffer::usage_pattern::gl_static_copy: return GL_STATIC_COPY;
-        case tinygl::buffer::usage_pattern::gl_dynamic_draw: return GL_DYNAMIC_DRAW;
-        case tinygl::buffer::usage_pattern::gl_dynamic_read: return GL_DYNAMIC_READ;
-        case tinygl::buffer::usage_pattern::gl_dynamic_copy: return GL_DYNAMIC_COPY;
-        }
-    }
-}
-
 struct tinygl::buffer::buffer_private
 {
     buffer_private(buffer::binding_target binding_target, buffer::usage_pattern pattern);
     ~buffer_private();
 
     GLuint id = 0;
+    std::size_t size = 0;
     binding_target binding_target;
     usage_pattern usage_pattern;
 };
@@ -77,32 +43,66 @@ tinygl::buffer& tinygl::buffer::operator=(tinygl::buffer&& other) noexcept
     return *this;
 }
 
-void tinygl::buffer::bind()
+void tinygl::buffer::bind(std::source_location call_site)
 {
-    glBindBuffer(gl_enum(p->binding_target), p->id);
+    glBindBuffer(utils::gl_enum(p->binding_target), p->id);
+    validation::check(call_site);
 }
 
-void tinygl::buffer::unbind()
+void tinygl::buffer::unbind(std::source_location call_site)
 {
-    glBindBuffer(gl_enum(p->binding_target), 0);
+    glBindBuffer(utils::gl_enum(p->binding_target), 0);
+    validation::check(call_site);
 }
 
-void tinygl::buffer::create(std::size_t size, const void* data)
+void tinygl::buffer::create(std::size_t size, const void* data, std::source_location call_site)
 {
+    p->size = size;
     glBufferData(
-        gl_enum(p->binding_target),
+        utils::gl_enum(p->binding_target),
         static_cast<GLsizeiptr>(size),
         data,
-        gl_enum(p->usage_pattern)
+        utils::gl_enum(p->usage_pattern)
     );
+    validation::check(call_site);
 }
 
-void tinygl::buffer::update(std::size_t offset, std::size_t size, void const* data)
+void tinygl::buffer::update(std::size_t offset, std::size_t size, void const* data, std::source_location call_site)
 {
     glBufferSubData(
-        gl_enum(p->binding_target),
+        utils::gl_enum(p->binding_target),
         static_cast<GLintptr>(offset),
         static_cast<GLsizeiptr>(size),
         data
     );
+    validation::check(call_site);
+}
+
+void* tinygl::buffer::map_range(std::size_t offset, std::size_t size, map_access access, std::source_location call_site)
+{
+    auto* data = glMapBufferRange(
+        utils::gl_enum(p->binding_target),
+        static_cast<GLintptr>(offset),
+        static_cast<GLsizeiptr>(size),
+        static_cast<GLbitfield>(access)
+    );
+    validation::check(call_site);
+    return data;
+}
+
+bool tinygl::buffer::unmap(std::source_location call_site)
+{
+    auto result = glUnmapBuffer(utils::gl_enum(p->binding_target));
+    validation::check(call_site);
+    return result == GL_TRUE;
+}
+
+std::size_t tinygl::buffer::size() const
+{
+    return p->size;
+}
+
+std::uint32_t tinygl::buffer::id() const
+{
+    return p->id;
 }
@@ -0,0 +1,44 @@
+#ifndef TINYGL_BUFFER_UTILS_H
+#define TINYGL_BUFFER_UTILS_H
+
+#include <GL/glew.h>
+#include <tinygl/buffer.h>
+
+namespace tinygl::utils {
+    inline constexpr GLenum gl_enum(tinygl::buffer::binding_target target)
+    {
+        switch(target) {
+        case tinygl::buffer::binding_target::gl_array_buffer: return GL_ARRAY_BUFFER;
+        case tinygl::buffer::binding_target::gl_atomic_counter_buffer: return GL_ATOMIC_COUNTER_BUFFER;
+        case tinygl::buffer::binding_target::gl_copy_read_buffer: return GL_COPY_READ_BUFFER;
+        case tinygl::buffer::binding_target::gl_copy_write_buffer: return GL_COPY_WRITE_BUFFER;
+        case tinygl::buffer::binding_target::gl_dispatch_indirect_buffer: return GL_DISPATCH_INDIRECT_BUFFER;
+        case tinygl::buffer::binding_target::gl_draw_indirect_buffer: return GL_DRAW_INDIRECT_BUFFER;
+        case tinygl::buffer::binding_target::gl_element_array_buffer: return GL_ELEMENT_ARRAY_BUFFER;
+        case tinygl::buffer::binding_target::gl_pixel_pack_buffer: return GL_PIXEL_PACK_BUFFER;
+        case tinygl::buffer::binding_target::gl_pixel_unpack_buffer: return GL_PIXEL_UNPACK_BUFFER;
+        case tinygl::buffer::binding_target::gl_query_buffer: return GL_QUERY_BUFFER;
+        case tinygl::buffer::binding_target::gl_shader_storage_buffer: return GL_SHADER_STORAGE_BUFFER;
+        case tinygl::buffer::binding_target::gl_texture_buffer: return GL_TEXTURE_BUFFER;
+        case tinygl::buffer::binding_target::gl_transform_feedback_buffer: return GL_TRANSFORM_FEEDBACK_BUFFER;
+        case tinygl::buffer::binding_target::gl_uniform_buffer: return GL_UNIFORM_BUFFER;
+        }
+    }
+
+    inline constexpr GLenum gl_enum(tinygl::buffer::usage_pattern usage_pattern)
+    {
+        switch(usage_pattern) {
+        case tinygl::buffer::usage_pattern::gl_stream_draw: return GL_STREAM_DRAW;
+        case tinygl::buffer::usage_pattern::gl_stream_read: return GL_STREAM_READ;
+        case tinygl::buffer::usage_pattern::gl_stream_copy: return GL_STREAM_COPY;
+        case tinygl::buffer::usage_pattern::gl_static_draw: return GL_STATIC_DRAW;
+        case tinygl::buffer::usage_pattern::gl_static_read: return GL_STATIC_READ;
+        case tinygl::buffer::usage_pattern::gl_static_copy: return GL_STATIC_COPY;
+        case tinygl::buffer::usage_pattern::gl_dynamic_draw: return GL_DYNAMIC_DRAW;
+        case tinygl::buffer::usage_pattern::gl_dynamic_read: return GL_DYNAMIC_READ;
+        case tinygl::buffer::usage_pattern::gl_dynamic_copy: return GL_DYNAMIC_COPY;
+        }
+    }
+}
+
+#endif // TINYGL_BUFFER_UTILS_H
@@ -0,0 +1,312 @@
+#include "tinygl/compressed_image.h"
+#include "mapped_file.h"
+#include "texture_utils.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    using tinygl::texture;
+
+    constexpr std::array<std::uint8_t, 12> ktx2_identifier = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    constexpr std::uint32_t dds_magic = 0x20534444;  // "DDS "
+
+    constexpr std::uint32_t fourcc(const char (&code)[5])
+    {
+        return static_cast<std::uint32_t>(code[0]) | static_cast<std::uint32_t>(code[1]) << 8 |
+               static_cast<std::uint32_t>(code[2]) << 16 | static_cast<std::uint32_t>(code[3]) << 24;
+    }
+
+    struct level
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    // Little-endian reads with bounds checks; both containers are little-endian.
+    class reader
+    {
+    public:
+        reader(std::span<const std::uint8_t> data, const std::filesystem::path& file_name) :
+            data{data}, file_name{file_name}
+        {
+        }
+
+        template<typename T>
+        T read(std::size_t offset) const
+        {
+            check(offset, sizeof(T));
+            T value;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            return value;
+        }
+
+        void check(std::size_t offset, std::size_t size) const
+        {
+            if (offset > data.size() || size > data.size() - offset) {
+                fail("file is truncated");
+            }
+        }
+
+        [[noreturn]] void fail(const std::string& reason) const
+        {
+            throw std::runtime_error(
+                fmt::format("tinygl::compressed_image: {}: {}!", file_name.string(), reason));
+        }
+
+    private:
+        std::span<const std::uint8_t> data;
+        const std::filesystem::path& file_name;
+    };
+
+    std::optional<texture::internal_format> from_vk_format(std::uint32_t vk_format)
+    {
+        switch (vk_format) {
+            case 131: return texture::internal_format::gl_compressed_rgb_s3tc_dxt1_ext;         // BC1_RGB_UNORM
+            case 132: return texture::internal_format::gl_compressed_srgb_s3tc_dxt1_ext;        // BC1_RGB_SRGB
+            case 133: return texture::internal_format::gl_compressed_rgba_s3tc_dxt1_ext;        // BC1_RGBA_UNORM
+            case 134: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt1_ext;  // BC1_RGBA_SRGB
+            case 135: return texture::internal_format::gl_compressed_rgba_s3tc_dxt3_ext;        // BC2_UNORM
+            case 136: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt3_ext;  // BC2_SRGB
+            case 137: return texture::internal_format::gl_compressed_rgba_s3tc_dxt5_ext;        // BC3_UNORM
+            case 138: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt5_ext;  // BC3_SRGB
+            case 139: return texture::internal_format::gl_compressed_red_rgtc1;                 // BC4_UNORM
+            case 140: return texture::internal_format::gl_compressed_signed_red_rgtc1;          // BC4_SNORM
+            case 141: return texture::internal_format::gl_compressed_rg_rgtc2;                  // BC5_UNORM
+            case 142: return texture::internal_format::gl_compressed_signed_rg_rgtc2;           // BC5_SNORM
+            case 143: return texture::internal_format::gl_compressed_rgb_bptc_unsigned_float;   // BC6H_UFLOAT
+            case 144: return texture::internal_format::gl_compressed_rgb_bptc_signed_float;     // BC6H_SFLOAT
+            case 145: return texture::internal_format::gl_compressed_rgba_bptc_unorm;           // BC7_UNORM
+            case 146: return texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm;     // BC7_SRGB
+            default: return std::nullopt;
+        }
+    }
+
+    std::optional<texture::internal_format> from_dxgi_format(std::uint32_t dxgi_format)
+    {
+        switch (dxgi_format) {
+            case 71: return texture::internal_format::gl_compressed_rgba_s3tc_dxt1_ext;         // BC1_UNORM
+            case 72: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt1_ext;   // BC1_UNORM_SRGB
+            case 74: return texture::internal_format::gl_compressed_rgba_s3tc_dxt3_ext;         // BC2_UNORM
+            case 75: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt3_ext;   // BC2_UNORM_SRGB
+            case 77: return texture::internal_format::gl_compressed_rgba_s3tc_dxt5_ext;         // BC3_UNORM
+            case 78: return texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt5_ext;   // BC3_UNORM_SRGB
+            case 80: return texture::internal_format::gl_compressed_red_rgtc1;                  // BC4_UNORM
+            case 81: return texture::internal_format::gl_compressed_signed_red_rgtc1;           // BC4_SNORM
+            case 83: return texture::internal_format::gl_compressed_rg_rgtc2;                   // BC5_UNORM
+            case 84: return texture::internal_format::gl_compressed_signed_rg_rgtc2;            // BC5_SNORM
+            case 95: return texture::internal_format::gl_compressed_rgb_bptc_unsigned_float;    // BC6H_UF16
+            case 96: return texture::internal_format::gl_compressed_rgb_bptc_signed_float;      // BC6H_SF16
+            case 98: return texture::internal_format::gl_compressed_rgba_bptc_unorm;            // BC7_UNORM
+            case 99: return texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm;      // BC7_UNORM_SRGB
+            default: return std::nullopt;
+        }
+    }
+
+    std::optional<texture::internal_format> from_fourcc(std::uint32_t code)
+    {
+        switch (code) {
+            case fourcc("DXT1"): return texture::internal_format::gl_compressed_rgba_s3tc_dxt1_ext;
+            case fourcc("DXT3"): return texture::internal_format::gl_compressed_rgba_s3tc_dxt3_ext;
+            case fourcc("DXT5"): return texture::internal_format::gl_compressed_rgba_s3tc_dxt5_ext;
+            case fourcc("ATI1"):
+            case fourcc("BC4U"): return texture::internal_format::gl_compressed_red_rgtc1;
+            case fourcc("BC4S"): return texture::internal_format::gl_compressed_signed_red_rgtc1;
+            case fourcc("ATI2"):
+            case fourcc("BC5U"): return texture::internal_format::gl_compressed_rg_rgtc2;
+            case fourcc("BC5S"): return texture::internal_format::gl_compressed_signed_rg_rgtc2;
+            default: return std::nullopt;
+        }
+    }
+}
+
+struct tinygl::compressed_image::compressed_image_private
+{
+    void parse_ktx2(const reader& reader);
+    void parse_dds(const reader& reader);
+
+    explicit compressed_image_private(const std::filesystem::path& file_name) : file{file_name} {}
+
+    // Level data is uploaded straight from the mapping.
+    utils::mapped_file file;
+    texture::internal_format internal_format{};
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    std::vector<level> levels;
+};
+
+void tinygl::compressed_image::compressed_image_private::parse_ktx2(const reader& reader)
+{
+    auto vk_format = reader.read<std::uint32_t>(12);
+    width = static_cast<std::int32_t>(reader.read<std::uint32_t>(20));
+    height = static_cast<std::int32_t>(reader.read<std::uint32_t>(24));
+    auto depth = reader.read<std::uint32_t>(28);
+    auto layer_count = reader.read<std::uint32_t>(32);
+    auto face_count = reader.read<std::uint32_t>(36);
+    auto level_count = std::max(reader.read<std::uint32_t>(40), 1u);
+    auto supercompression = reader.read<std::uint32_t>(44);
+
+    if (supercompression != 0) {
+        reader.fail("supercompressed KTX2 files are not supported");
+    }
+    if (depth > 0 || layer_count > 0 || face_count != 1) {
+        reader.fail("only 2D KTX2 images are supported");
+    }
+    auto format = from_vk_format(vk_format);
+    if (!format) {
+        reader.fail(fmt::format("VkFormat {} is not a supported block-compressed format", vk_format));
+    }
+    internal_format = *format;
+
+    // The level index follows the 80 byte header; it lists the largest level first.
+    constexpr std::size_t level_index = 80;
+    for (std::uint32_t i = 0; i < level_count; ++i) {
+        auto offset = reader.read<std::uint64_t>(level_index + i * 24);
+        auto size = reader.read<std::uint64_t>(level_index + i * 24 + 8);
+        levels.push_back({static_cast<std::size_t>(offset), static_cast<std::size_t>(size)});
+    }
+}
+
+void tinygl::compressed_image::compressed_image_private::parse_dds(const reader& reader)
+{
+    constexpr std::uint32_t ddsd_mipmapcount = 0x20000;
+    constexpr std::uint32_t ddpf_fourcc = 0x4;
+    constexpr std::uint32_t ddscaps2_cubemap = 0x200;
+    constexpr std::uint32_t ddscaps2_volume = 0x200000;
+    constexpr std::uint32_t resource_misc_texturecube = 0x4;
+
+    if (reader.read<std::uint32_t>(4) != 124) {
+        reader.fail("invalid DDS header");
+    }
+    auto flags = reader.read<std::uint32_t>(8);
+    height = static_cast<std::int32_t>(reader.read<std::uint32_t>(12));
+    width = static_cast<std::int32_t>(reader.read<std::uint32_t>(16));
+    auto level_count = flags & ddsd_mipmapcount ? std::max(reader.read<std::uint32_t>(28), 1u) : 1u;
+    auto pixel_flags = reader.read<std::uint32_t>(80);
+    auto code = reader.read<std::uint32_t>(84);
+    auto caps2 = reader.read<std::uint32_t>(112);
+
+    if (caps2 & (ddscaps2_cubemap | ddscaps2_volume)) {
+        reader.fail("only 2D DDS images are supported");
+    }
+    if (!(pixel_flags & ddpf_fourcc)) {
+        reader.fail("uncompressed DDS files are not supported");
+    }
+
+    std::size_t offset = 128;
+    std::optional<texture::internal_format> format;
+    if (code == fourcc("DX10")) {
+        auto dxgi_format = reader.read<std::uint32_t>(128);
+        auto misc_flags = reader.read<std::uint32_t>(136);
+        auto array_size = reader.read<std::uint32_t>(140);
+        if (array_size > 1 || misc_flags & resource_misc_texturecube) {
+            reader.fail("only 2D DDS images are supported");
+        }
+        format = from_dxgi_format(dxgi_format);
+        if (!format) {
+            reader.fail(fmt::format("DXGI format {} is not a supported block-compressed format", dxgi_format));
+        }
+        offset += 20;
+    } else {
+        format = from_fourcc(code);
+        if (!format) {
+            reader.fail("FourCC code is not a supported block-compressed format");
+        }
+    }
+    internal_format = *format;
+
+    // Levels are stored back to back, largest first.
+    for (std::uint32_t i = 0; i < level_count; ++i) {
+        auto size = utils::image_size(internal_format, std::max(width >> i, 1), std::max(height >> i, 1));
+        levels.push_back({offset, size});
+        offset += size;
+    }
+}
+
+tinygl::compressed_image::compressed_image(const std::filesystem::path& file_name) :
+    p{std::make_unique<compressed_image_private>(file_name)}
+{
+    auto data = p->file.span();
+    reader reader{data, file_name};
+    if (data.size() >= ktx2_identifier.size() &&
+        std::equal(ktx2_identifier.begin(), ktx2_identifier.end(), data.begin())) {
+        p->parse_ktx2(reader);
+    } else if (data.size() >= 4 && reader.read<std::uint32_t>(0) == dds_magic) {
+        p->parse_dds(reader);
+    } else {
+        reader.fail("neither a KTX2 nor a DDS file");
+    }
+
+    if (p->width < 1 || p->height < 1) {
+        reader.fail("invalid image size");
+    }
+    // Levels below 1x1 would make GL reject the whole texture.
+    auto max_levels = static_cast<std::size_t>(std::bit_width(static_cast<std::uint32_t>(std::max(p->width, p->height))));
+    if (p->levels.size() > max_levels) {
+        reader.fail("too many mip levels");
+    }
+    for (std::size_t i = 0; i < p->levels.size(); ++i) {
+        auto level = static_cast<std::int32_t>(i);
+        auto expected = utils::image_size(p->internal_format, level_width(level), level_height(level));
+        if (p->levels[i].size < expected) {
+            reader.fail(fmt::format("mip level {} is too small", i));
+        }
+        reader.check(p->levels[i].offset, expected);
+        p->levels[i].size = expected;
+    }
+}
+
+tinygl::compressed_image::~compressed_image() = default;
+
+tinygl::compressed_image::compressed_image(compressed_image&& other) noexcept = default;
+
+tinygl::compressed_image& tinygl::compressed_image::operator=(compressed_image&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+tinygl::texture::internal_format tinygl::compressed_image::internal_format() const
+{
+    return p->internal_format;
+}
+
+std::int32_t tinygl::compressed_image::width() const
+{
+    return p->width;
+}
+
+std::int32_t tinygl::compressed_image::height() const
+{
+    return p->height;
+}
+
+std::int32_t tinygl::compressed_image::level_count() const
+{
+    return static_cast<std::int32_t>(p->levels.size());
+}
+
+std::int32_t tinygl::compressed_image::level_width(std::int32_t level) const
+{
+    return std::max(p->width >> level, 1);
+}
+
+std::int32_t tinygl::compressed_image::level_height(std::int32_t level) const
+{
+    return std::max(p->height >> level, 1);
+}
+
+std::span<const std::uint8_t> tinygl::compressed_image::level_data(std::int32_t level) const
+{
+    const auto& entry = p->levels.at(static_cast<std::size_t>(level));
+    return p->file.span().subspan(entry.offset, entry.size);
+}
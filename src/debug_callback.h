@@ -0,0 +1,12 @@
+#ifndef TINYGL_DEBUG_CALLBACK_H
+#define TINYGL_DEBUG_CALLBACK_H
+
+namespace tinygl::debug_output {
+    // Registers the asynchronous debug message callback on the current context.
+    void install();
+
+    // Hands queued messages over to the asynchronous logger; called once per frame by the window.
+    void drain();
+}
+
+#endif // TINYGL_DEBUG_CALLBACK_H
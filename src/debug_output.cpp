@@ -0,0 +1,313 @@
+#include "tinygl/debug_output.h"
+#include "debug_callback.h"
+#include <GL/glew.h>
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+namespace {
+    using tinygl::debug_output::message_type;
+    using tinygl::debug_output::severity;
+
+    constexpr const char* source_string(GLenum source)
+    {
+        switch (source) {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window System";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third Party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+        default: return "Other";
+        }
+    }
+
+    constexpr message_type to_message_type(GLenum type)
+    {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return message_type::error;
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return message_type::deprecated_behavior;
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return message_type::undefined_behavior;
+        case GL_DEBUG_TYPE_PORTABILITY: return message_type::portability;
+        case GL_DEBUG_TYPE_PERFORMANCE: return message_type::performance;
+        case GL_DEBUG_TYPE_MARKER: return message_type::marker;
+        case GL_DEBUG_TYPE_PUSH_GROUP: return message_type::push_group;
+        case GL_DEBUG_TYPE_POP_GROUP: return message_type::pop_group;
+        default: return message_type::other;
+        }
+    }
+
+    constexpr const char* type_string(GLenum type)
+    {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "Error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated Behavior";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined Behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+        case GL_DEBUG_TYPE_MARKER: return "Marker";
+        case GL_DEBUG_TYPE_PUSH_GROUP: return "Push Group";
+        case GL_DEBUG_TYPE_POP_GROUP: return "Pop Group";
+        default: return "Other";
+        }
+    }
+
+    constexpr severity to_severity(GLenum gl_severity)
+    {
+        switch (gl_severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return severity::high;
+        case GL_DEBUG_SEVERITY_MEDIUM: return severity::medium;
+        case GL_DEBUG_SEVERITY_LOW: return severity::low;
+        default: return severity::notification;
+        }
+    }
+
+    constexpr spdlog::level::level_enum to_level(severity message_severity)
+    {
+        switch (message_severity) {
+        case severity::high: return spdlog::level::err;
+        case severity::medium: return spdlog::level::warn;
+        case severity::low: return spdlog::level::info;
+        case severity::notification: return spdlog::level::debug;
+        }
+    }
+
+    struct message
+    {
+        GLuint id;
+        GLenum source;
+        GLenum type;
+        severity level;
+        std::array<char, 512> text;
+    };
+
+    /**
+     * Bounded multi-producer queue (D. Vyukov's design): drivers may invoke the callback from their own threads,
+     * so producers only claim a cell with a CAS and never take a lock. The window drains it once per frame.
+     */
+    class message_queue
+    {
+    public:
+        message_queue()
+        {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool push(const message& m)
+        {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = cells[position & (capacity - 1)];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.data = m;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Single consumer.
+        bool pop(message& m)
+        {
+            auto& cell = cells[dequeue_position & (capacity - 1)];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence != dequeue_position + 1) {
+                return false;
+            }
+            m = cell.data;
+            cell.sequence.store(dequeue_position + capacity, std::memory_order_release);
+            ++dequeue_position;
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t capacity = 64;
+
+        struct cell
+        {
+            std::atomic<std::size_t> sequence;
+            message data;
+        };
+
+        std::array<cell, capacity> cells;
+        alignas(64) std::atomic<std::size_t> enqueue_position{0};
+        alignas(64) std::size_t dequeue_position{0};
+    };
+
+    /**
+     * Open-addressing table of per-ID counters. Only the first occurrence of a message ID is queued,
+     * repeats just bump the counter, which keeps chatty drivers from flooding the queue.
+     */
+    class repeat_counter
+    {
+    public:
+        // Returns the number of times the key has been seen before this call.
+        std::uint64_t add(std::uint64_t key)
+        {
+            auto index = hash(key);
+            for (std::size_t probe = 0; probe < capacity; ++probe, index = (index + 1) & (capacity - 1)) {
+                auto& slot = slots[index];
+                auto current = slot.key.load(std::memory_order_acquire);
+                if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    current = key;
+                }
+                if (current == key) {
+                    return slot.count.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            // The table is full, let the message through.
+            return 0;
+        }
+
+        template<typename F>
+        void for_each(F f) const
+        {
+            for (const auto& slot : slots) {
+                auto key = slot.key.load(std::memory_order_acquire);
+                if (key != 0) {
+                    f(key, slot.count.load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t capacity = 1024;
+
+        static std::size_t hash(std::uint64_t key)
+        {
+            return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 54) & (capacity - 1);
+        }
+
+        struct slot
+        {
+            std::atomic<std::uint64_t> key{0};
+            std::atomic<std::uint64_t> count{0};
+        };
+
+        std::array<slot, capacity> slots;
+    };
+
+    constexpr std::uint64_t make_key(GLenum source, GLenum type, GLuint id)
+    {
+        // The top bit keeps the key non-zero, zero marks an empty slot.
+        return (1ull << 63) | (static_cast<std::uint64_t>((source - GL_DEBUG_SOURCE_API) & 0x7FFF) << 48) |
+            (static_cast<std::uint64_t>(type & 0xFFFF) << 32) | id;
+    }
+
+    std::atomic<severity> min_severity{severity::low};
+    std::atomic<message_type> enabled_types{message_type::all};
+    std::atomic<std::uint64_t> performance_warnings{0};
+    std::atomic<std::uint64_t> dropped_messages{0};
+    message_queue queue;
+    repeat_counter repeats;
+
+    std::shared_ptr<spdlog::logger> logger()
+    {
+        static auto logger = [] {
+            if (auto existing = spdlog::get("tinygl::gl")) {
+                return existing;
+            }
+            // Non-blocking: when the logging thread falls behind the oldest entries are overwritten.
+            return spdlog::create_async_nb<spdlog::sinks::stderr_color_sink_mt>("tinygl::gl");
+        }();
+        return logger;
+    }
+
+    void GLAPIENTRY gl_debug_output(
+            GLenum source,
+            GLenum type,
+            GLuint id,
+            GLenum gl_severity,
+            GLsizei length,
+            const GLchar* text,
+            [[maybe_unused]] const void* user_param)
+    {
+        auto kind = to_message_type(type);
+        if (kind == message_type::performance) {
+            performance_warnings.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto message_severity = to_severity(gl_severity);
+        if (message_severity < min_severity.load(std::memory_order_relaxed) ||
+            (kind & enabled_types.load(std::memory_order_relaxed)) != kind) {
+            return;
+        }
+
+        if (repeats.add(make_key(source, type, id)) > 0) {
+            return;
+        }
+
+        message m{id, source, type, message_severity, {}};
+        auto size = length < 0 ? std::strlen(text) : static_cast<std::size_t>(length);
+        size = std::min(size, m.text.size() - 1);
+        std::memcpy(m.text.data(), text, size);
+        m.text[size] = '\0';
+        if (!queue.push(m)) {
+            dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void tinygl::debug_output::install()
+{
+    logger();
+    // Without GL_DEBUG_OUTPUT_SYNCHRONOUS the driver is free to call back from its own threads
+    // instead of stalling the calling one.
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(gl_debug_output, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+}
+
+void tinygl::debug_output::drain()
+{
+    message m;
+    while (queue.pop(m)) {
+        logger()->log(
+            to_level(m.level),
+            "[tinygl::gl] {} {} #{}: {}", source_string(m.source), type_string(m.type), m.id, m.text.data());
+    }
+}
+
+void tinygl::debug_output::set_filter(severity min_severity, message_type types)
+{
+    ::min_severity.store(min_severity, std::memory_order_relaxed);
+    enabled_types.store(types, std::memory_order_relaxed);
+}
+
+std::uint64_t tinygl::debug_output::performance_warning_count()
+{
+    return performance_warnings.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tinygl::debug_output::dropped_message_count()
+{
+    return dropped_messages.load(std::memory_order_relaxed);
+}
+
+void tinygl::debug_output::report_repeated()
+{
+    drain();
+    repeats.for_each([](std::uint64_t key, std::uint64_t count) {
+        if (count > 1) {
+            logger()->info(
+                "[tinygl::gl] {} {} #{} was raised {} times",
+                source_string(static_cast<GLenum>(GL_DEBUG_SOURCE_API + ((key >> 48) & 0x7FFF))),
+                type_string(static_cast<GLenum>((key >> 32) & 0xFFFF)),
+                static_cast<GLuint>(key & 0xFFFFFFFF),
+                count);
+        }
+    });
+}
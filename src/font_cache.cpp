@@ -0,0 +1,221 @@
+#include "font_cache.h"
+#include "imgui.h"
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+// Dear ImGui 1.92 builds glyphs on demand and has no single baked atlas to cache.
+#if IMGUI_VERSION_NUM < 19200
+#define TINYGL_FONT_CACHE_SUPPORTED
+#endif
+
+#ifdef TINYGL_FONT_CACHE_SUPPORTED
+namespace {
+    constexpr std::array<char, 4> magic = {'T', 'G', 'F', 'A'};
+    constexpr std::uint32_t format_version = 1;
+
+    struct header
+    {
+        std::array<char, 4> magic;
+        std::uint32_t format_version;
+        std::uint32_t imgui_version;
+        std::uint32_t glyph_size;
+        std::uint64_t key;
+        float size_pixels;
+        float ascent;
+        float descent;
+        std::int32_t width;
+        std::int32_t height;
+        ImVec2 uv_scale;
+        ImVec2 uv_white_pixel;
+        std::uint32_t line_count;
+        std::uint32_t glyph_count;
+    };
+
+    std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::uint64_t cache_key(const std::vector<char>& font_data, float size_pixels)
+    {
+        auto key = fnv1a(font_data.data(), font_data.size());
+        key = fnv1a(&size_pixels, sizeof(size_pixels), key);
+        auto version = static_cast<std::uint32_t>(IMGUI_VERSION_NUM);
+        return fnv1a(&version, sizeof(version), key);
+    }
+
+    constexpr auto line_count = static_cast<std::uint32_t>(IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1);
+
+    bool load(ImFontAtlas& atlas, const std::filesystem::path& path, std::uint64_t key, float size_pixels)
+    {
+        std::error_code error;
+        auto file_size = std::filesystem::file_size(path, error);
+        if (error) {
+            return false;
+        }
+        std::ifstream file{path, std::ios::binary};
+        header header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return false;
+        }
+        if (header.magic != magic || header.format_version != format_version ||
+            header.imgui_version != IMGUI_VERSION_NUM || header.glyph_size != sizeof(ImFontGlyph) ||
+            header.key != key || header.size_pixels != size_pixels || header.line_count != line_count ||
+            header.width <= 0 || header.height <= 0) {
+            return false;
+        }
+        // The counts come from the file, so they are checked against its size before anything is allocated.
+        auto pixel_count = static_cast<std::uint64_t>(header.width) * static_cast<std::uint64_t>(header.height);
+        auto expected_size = sizeof(header) + std::uint64_t{line_count} * sizeof(ImVec4) +
+                             std::uint64_t{header.glyph_count} * sizeof(ImFontGlyph) + pixel_count;
+        if (expected_size != file_size) {
+            return false;
+        }
+
+        std::vector<ImVec4> lines(header.line_count);
+        std::vector<ImFontGlyph> glyphs(header.glyph_count);
+        auto* pixels = static_cast<unsigned char*>(IM_ALLOC(static_cast<std::size_t>(pixel_count)));
+        file.read(reinterpret_cast<char*>(lines.data()), static_cast<std::streamsize>(lines.size() * sizeof(ImVec4)));
+        file.read(reinterpret_cast<char*>(glyphs.data()),
+                  static_cast<std::streamsize>(glyphs.size() * sizeof(ImFontGlyph)));
+        file.read(reinterpret_cast<char*>(pixels), static_cast<std::streamsize>(pixel_count));
+        if (!file) {
+            IM_FREE(pixels);
+            return false;
+        }
+
+        // Recreates what ImFontAtlas::Build() leaves behind, minus the rasterizer state. The font keeps a config
+        // without font data, as ImFont::BuildLookupTable() and the atlas read it (EllipsisChar and friends).
+        auto* font = IM_NEW(ImFont);
+        ImFontConfig config;
+        config.SizePixels = header.size_pixels;
+        config.FontDataOwnedByAtlas = false;
+        config.DstFont = font;
+        atlas.ConfigData.push_back(config);
+        font->ConfigData = &atlas.ConfigData.back();
+        font->ConfigDataCount = 1;
+        font->FontSize = header.size_pixels;
+        font->Ascent = header.ascent;
+        font->Descent = header.descent;
+        font->ContainerAtlas = &atlas;
+        for (const auto& glyph : glyphs) {
+            font->Glyphs.push_back(glyph);
+        }
+        font->BuildLookupTable();
+
+        atlas.Fonts.push_back(font);
+        atlas.TexPixelsAlpha8 = pixels;
+        atlas.TexWidth = header.width;
+        atlas.TexHeight = header.height;
+        atlas.TexUvScale = header.uv_scale;
+        atlas.TexUvWhitePixel = header.uv_white_pixel;
+        std::memcpy(atlas.TexUvLines, lines.data(), lines.size() * sizeof(ImVec4));
+#if IMGUI_VERSION_NUM >= 18700
+        atlas.TexReady = true;
+#endif
+        return true;
+    }
+
+    void store(ImFontAtlas& atlas, const std::filesystem::path& path, std::uint64_t key, float size_pixels)
+    {
+        unsigned char* pixels;
+        int width, height;
+        atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+        const auto* font = atlas.Fonts[0];
+
+        header header{
+            magic, format_version, IMGUI_VERSION_NUM, sizeof(ImFontGlyph), key, size_pixels, font->Ascent,
+            font->Descent, width, height, atlas.TexUvScale, atlas.TexUvWhitePixel, line_count,
+            static_cast<std::uint32_t>(font->Glyphs.Size)};
+
+        // Written next to the final file and renamed, so a concurrent run never sees half a cache entry.
+        auto temporary = path;
+        temporary += fmt::format(".{}", std::chrono::steady_clock::now().time_since_epoch().count());
+        {
+            std::ofstream file{temporary, std::ios::binary};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(atlas.TexUvLines), line_count * sizeof(ImVec4));
+            file.write(reinterpret_cast<const char*>(font->Glyphs.Data),
+                       static_cast<std::streamsize>(font->Glyphs.Size * sizeof(ImFontGlyph)));
+            file.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(width) * height);
+            if (!file) {
+                throw std::runtime_error(fmt::format("could not write {}", temporary.string()));
+            }
+        }
+        std::filesystem::rename(temporary, path);
+    }
+}
+#endif
+
+void tinygl::font_cache::add_font(ImFontAtlas& atlas, const std::filesystem::path& font_path, float size_pixels,
+                                  const std::filesystem::path& cache_directory)
+{
+#ifdef TINYGL_FONT_CACHE_SUPPORTED
+    if (cache_directory.empty() || atlas.Fonts.Size != 0) {
+        atlas.AddFontFromFileTTF(font_path.string().c_str(), size_pixels, nullptr, nullptr);
+        return;
+    }
+
+    std::ifstream font_file{font_path, std::ios::binary};
+    std::vector<char> font_data{std::istreambuf_iterator<char>{font_file}, std::istreambuf_iterator<char>{}};
+    auto key = cache_key(font_data, size_pixels);
+    auto path = cache_directory / fmt::format("font_{:016x}.atlas", key);
+
+    if (load(atlas, path, key, size_pixels)) {
+        spdlog::debug("[tinygl::window] font atlas loaded from {}", path.string());
+        return;
+    }
+
+    // Hand the bytes that were just read to the atlas instead of having it read the file again.
+    auto* data = IM_ALLOC(font_data.size());
+    std::memcpy(data, font_data.data(), font_data.size());
+    atlas.AddFontFromMemoryTTF(data, static_cast<int>(font_data.size()), size_pixels, nullptr, nullptr);
+    atlas.Build();
+
+    try {
+        std::filesystem::create_directories(cache_directory);
+        store(atlas, path, key, size_pixels);
+    } catch (const std::exception& e) {
+        spdlog::warn("[tinygl::window] could not cache the font atlas: {}", e.what());
+    }
+#else
+    static_cast<void>(cache_directory);
+    atlas.AddFontFromFileTTF(font_path.string().c_str(), size_pixels, nullptr, nullptr);
+#endif
+}
+
+std::filesystem::path tinygl::font_cache::default_directory()
+{
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if (base && *base) {
+        return std::filesystem::path{base} / "tinygl" / "cache";
+    }
+#else
+    const char* base = std::getenv("XDG_CACHE_HOME");
+    if (base && *base) {
+        return std::filesystem::path{base} / "tinygl";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::filesystem::path{home} / ".cache" / "tinygl";
+    }
+#endif
+    std::error_code error;
+    auto temporary = std::filesystem::temp_directory_path(error);
+    return error ? std::filesystem::path{} : temporary / "tinygl";
+}
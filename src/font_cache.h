@@ -0,0 +1,22 @@
+#ifndef TINYGL_FONT_CACHE_H
+#define TINYGL_FONT_CACHE_H
+
+#include <filesystem>
+
+struct ImFontAtlas;
+
+namespace tinygl::font_cache {
+    /**
+     * Adds the font at `font_path` rasterized at `size_pixels` to the empty `atlas` and builds it. The baked
+     * atlas (alpha texture plus glyph metrics) is cached in `cache_directory`, keyed by a hash of the font file,
+     * the size and the Dear ImGui version, so later runs skip stb_truetype entirely.
+     * An empty `cache_directory` disables the cache.
+     */
+    void add_font(ImFontAtlas& atlas, const std::filesystem::path& font_path, float size_pixels,
+                  const std::filesystem::path& cache_directory);
+
+    // The per-user cache directory, or a directory below the temporary one when there is none.
+    std::filesystem::path default_directory();
+}
+
+#endif // TINYGL_FONT_CACHE_H
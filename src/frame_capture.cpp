@@ -0,0 +1,280 @@
+#include "tinygl/frame_capture.h"
+#include "tinygl/buffer.h"
+#include "thread_pool.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+    struct slot
+    {
+        tinygl::buffer pbo{tinygl::buffer::binding_target::gl_pixel_pack_buffer,
+                           tinygl::buffer::usage_pattern::gl_stream_read};
+        GLsync fence = nullptr;
+        std::uint64_t index = 0;
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+    };
+
+    void write_file(const std::filesystem::path& path, const char* header, std::size_t header_size,
+                    const std::uint8_t* data, std::size_t size)
+    {
+        std::ofstream file{path, std::ios::binary};
+        file.write(header, static_cast<std::streamsize>(header_size));
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file) {
+            throw std::runtime_error(fmt::format("tinygl::frame_capture: could not write {}!", path.string()));
+        }
+    }
+}
+
+struct tinygl::frame_capture::frame_capture_private
+{
+    frame_capture_private(frame_capture::encoder encoder, std::size_t ring_size, std::size_t worker_count,
+                          std::size_t max_queued);
+
+    // Hands every read whose fence has signalled to the workers, oldest first.
+    void collect(bool wait);
+    void encode(frame& frame);
+    std::vector<std::uint8_t> acquire_pixels(std::size_t size);
+
+    frame_capture::encoder encoder;
+    std::vector<slot> slots;
+    std::size_t oldest = 0;
+    std::size_t pending = 0;
+    std::uint64_t frame_index = 0;
+    std::uint64_t sequence = 0;
+    std::atomic<std::uint64_t> captured{0};
+    std::atomic<std::uint64_t> dropped{0};
+
+    // Pixel storage is recycled, a full HD frame is 8 MB.
+    std::mutex pixels_mutex;
+    std::vector<std::vector<std::uint8_t>> free_pixels;
+
+    // Declared last: destroyed first, so no worker outlives the state it uses.
+    utils::thread_pool workers;
+};
+
+tinygl::frame_capture::frame_capture_private::frame_capture_private(
+        frame_capture::encoder encoder, std::size_t ring_size, std::size_t worker_count, std::size_t max_queued) :
+    encoder{std::move(encoder)},
+    slots(std::max<std::size_t>(ring_size, 1)),
+    workers{worker_count, max_queued}
+{
+}
+
+void tinygl::frame_capture::frame_capture_private::collect(bool wait)
+{
+    while (pending > 0) {
+        auto& slot = slots[oldest];
+        auto timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+        auto status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        oldest = (oldest + 1) % slots.size();
+        --pending;
+
+        if (status == GL_WAIT_FAILED) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto size = static_cast<std::size_t>(slot.width) * slot.height * 4;
+        slot.pbo.bind();
+        const auto* data = slot.pbo.map_range(0, size, buffer::map_access::gl_map_read_bit);
+        if (!data) {
+            slot.pbo.unbind();
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        frame frame{slot.index, sequence, slot.width, slot.height, acquire_pixels(size)};
+        std::memcpy(frame.pixels.data(), data, size);
+        // The copy is garbage if the data store was corrupted while mapped.
+        auto intact = slot.pbo.unmap();
+        slot.pbo.unbind();
+        if (!intact) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard lock{pixels_mutex};
+            free_pixels.push_back(std::move(frame.pixels));
+            continue;
+        }
+
+        auto submitted = workers.try_submit([this, frame = std::move(frame)]() mutable {
+            encode(frame);
+        });
+        if (submitted) {
+            ++sequence;
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void tinygl::frame_capture::frame_capture_private::encode(frame& frame)
+{
+    try {
+        encoder(frame);
+        captured.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception& e) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        spdlog::error("[tinygl::frame_capture] frame {}: {}", frame.index, e.what());
+    }
+    std::lock_guard lock{pixels_mutex};
+    free_pixels.push_back(std::move(frame.pixels));
+}
+
+std::vector<std::uint8_t> tinygl::frame_capture::frame_capture_private::acquire_pixels(std::size_t size)
+{
+    std::vector<std::uint8_t> pixels;
+    {
+        std::lock_guard lock{pixels_mutex};
+        if (!free_pixels.empty()) {
+            pixels = std::move(free_pixels.back());
+            free_pixels.pop_back();
+        }
+    }
+    pixels.resize(size);
+    return pixels;
+}
+
+tinygl::frame_capture::frame_capture(
+        encoder encoder, std::size_t ring_size, std::size_t worker_count, std::size_t max_queued) :
+    p{std::make_unique<frame_capture_private>(std::move(encoder), ring_size, worker_count, max_queued)}
+{
+}
+
+tinygl::frame_capture::~frame_capture()
+{
+    for (auto& slot : p->slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+    }
+}
+
+void tinygl::frame_capture::capture(std::int32_t width, std::int32_t height, std::source_location call_site)
+{
+    p->collect(false);
+
+    auto index = p->frame_index++;
+    // A minimized window has an empty framebuffer, which leaves nothing to read.
+    if (width <= 0 || height <= 0 || p->pending == p->slots.size()) {
+        p->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& slot = p->slots[(p->oldest + p->pending) % p->slots.size()];
+    auto size = static_cast<std::size_t>(width) * height * 4;
+    slot.pbo.bind(call_site);
+    if (slot.pbo.size() != size) {
+        slot.pbo.create(size, nullptr, call_site);
+    }
+    GLint read_framebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(read_framebuffer));
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.pbo.unbind(call_site);
+    slot.index = index;
+    slot.width = width;
+    slot.height = height;
+    ++p->pending;
+    validation::check(call_site);
+}
+
+void tinygl::frame_capture::finish()
+{
+    p->collect(true);
+    p->workers.wait_idle();
+}
+
+std::uint64_t tinygl::frame_capture::captured_frame_count() const
+{
+    return p->captured.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tinygl::frame_capture::dropped_frame_count() const
+{
+    return p->dropped.load(std::memory_order_relaxed);
+}
+
+tinygl::frame_capture::encoder tinygl::frame_capture::raw_files(const std::filesystem::path& directory)
+{
+    std::filesystem::create_directories(directory);
+    return [directory](const frame& frame) {
+        write_file(
+            directory / fmt::format("frame_{:06}.rgba", frame.index), nullptr, 0, frame.pixels.data(),
+            frame.pixels.size());
+    };
+}
+
+tinygl::frame_capture::encoder tinygl::frame_capture::ppm_files(const std::filesystem::path& directory)
+{
+    std::filesystem::create_directories(directory);
+    return [directory](const frame& frame) {
+        std::vector<std::uint8_t> rgb(static_cast<std::size_t>(frame.width) * frame.height * 3);
+        for (std::int32_t y = 0; y < frame.height; ++y) {
+            const auto* src = frame.pixels.data() + static_cast<std::size_t>(frame.height - 1 - y) * frame.width * 4;
+            auto* dst = rgb.data() + static_cast<std::size_t>(y) * frame.width * 3;
+            for (std::int32_t x = 0; x < frame.width; ++x) {
+                dst[3 * x + 0] = src[4 * x + 0];
+                dst[3 * x + 1] = src[4 * x + 1];
+                dst[3 * x + 2] = src[4 * x + 2];
+            }
+        }
+        auto header = fmt::format("P6\n{} {}\n255\n", frame.width, frame.height);
+        write_file(
+            directory / fmt::format("frame_{:06}.ppm", frame.index), header.data(), header.size(), rgb.data(),
+            rgb.size());
+    };
+}
+
+tinygl::frame_capture::encoder tinygl::frame_capture::pipe(const std::string& command)
+{
+    struct pipe_state
+    {
+        explicit pipe_state(const std::string& command) : file{popen(command.c_str(), "w")}
+        {
+            if (!file) {
+                throw std::runtime_error(fmt::format("tinygl::frame_capture: could not run {}!", command));
+            }
+        }
+        ~pipe_state() { pclose(file); }
+
+        FILE* file;
+        std::mutex mutex;
+        std::condition_variable turn;
+        std::uint64_t next = 0;
+    };
+
+    auto state = std::make_shared<pipe_state>(command);
+    return [state](const frame& frame) {
+        // Workers may finish out of order, but the stream must not.
+        std::unique_lock lock{state->mutex};
+        state->turn.wait(lock, [&] { return state->next == frame.sequence; });
+        auto written = std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), state->file);
+        ++state->next;
+        lock.unlock();
+        state->turn.notify_all();
+        if (written != frame.pixels.size()) {
+            throw std::runtime_error("tinygl::frame_capture: could not write to the pipe!");
+        }
+    };
+}
@@ -0,0 +1,428 @@
+#include "tinygl/frame_stats.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "imgui.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    constexpr std::size_t metric_count = 4;
+    constexpr double bin_width_ms = 0.1;
+    constexpr std::size_t bin_count = 1000;
+    constexpr std::size_t query_count = 4;
+
+    struct histogram
+    {
+        // The last bin collects everything from bin_count * bin_width_ms up.
+        std::array<std::uint64_t, bin_count + 1> bins{};
+        std::uint64_t count = 0;
+        double sum = 0.0;
+        double max = 0.0;
+
+        void add(double ms)
+        {
+            auto bin = static_cast<std::size_t>(std::max(ms, 0.0) / bin_width_ms);
+            ++bins[std::min(bin, bin_count)];
+            ++count;
+            sum += ms;
+            max = std::max(max, ms);
+        }
+
+        double percentile(double fraction) const
+        {
+            auto rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < bin_count; ++i) {
+                seen += bins[i];
+                if (seen >= rank) {
+                    return std::min((static_cast<double>(i) + 1.0) * bin_width_ms, max);
+                }
+            }
+            return max;
+        }
+    };
+
+    struct query
+    {
+        GLuint id = 0;
+        std::uint64_t frame = 0;
+        bool pending = false;
+    };
+
+    double milliseconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    tinygl::frame_stats::summary summarize(std::vector<float>& values)
+    {
+        if (values.empty()) {
+            return {};
+        }
+        std::sort(values.begin(), values.end());
+        auto at = [&](double fraction) {
+            auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+            return static_cast<double>(values[std::max<std::size_t>(rank, 1) - 1]);
+        };
+        double sum = 0.0;
+        for (auto value : values) {
+            sum += value;
+        }
+        return {values.size(), sum / static_cast<double>(values.size()), at(0.50), at(0.95), at(0.99), values.back()};
+    }
+
+    const char* metric_name(std::size_t metric)
+    {
+        constexpr std::array<const char*, metric_count> names = {"frame", "cpu", "gpu", "swap"};
+        return names[metric];
+    }
+}
+
+struct tinygl::frame_stats::frame_stats_private
+{
+    frame_stats_private(std::size_t capacity, double hitch_factor) :
+        ring(std::max<std::size_t>(capacity, 1)),
+        hitch_factor{hitch_factor}
+    {
+    }
+
+    void add_gpu_time(std::uint64_t frame, double ms);
+    void collect_queries(bool wait);
+    void release_queries();
+
+    std::vector<frame_stats::sample> ring;
+    std::size_t next = 0;
+    std::size_t size = 0;
+    std::array<histogram, metric_count> histograms;
+
+    double hitch_factor;
+    double average_busy_ms = 0.0;
+    std::uint64_t frames = 0;
+    std::uint64_t hitches = 0;
+
+    std::chrono::steady_clock::time_point frame_start;
+    std::chrono::steady_clock::time_point swap_start;
+    bool started = false;
+    frame_stats::sample current{};
+
+    std::array<query, query_count> queries;
+    bool queries_created = false;
+    query* active_query = nullptr;
+
+    bool graph_visible = false;
+    std::filesystem::path csv_path;
+    std::filesystem::path json_path;
+};
+
+void tinygl::frame_stats::frame_stats_private::add_gpu_time(std::uint64_t frame, double ms)
+{
+    histograms[static_cast<std::size_t>(metric::gpu)].add(ms);
+    // The frame is still in the ring unless the ring is shorter than the query latency.
+    for (std::size_t i = 0; i < std::min(size, query_count + 1); ++i) {
+        auto& sample = ring[(next + ring.size() - 1 - i) % ring.size()];
+        if (sample.frame == frame) {
+            sample.gpu_ms = static_cast<float>(ms);
+            return;
+        }
+    }
+}
+
+void tinygl::frame_stats::frame_stats_private::collect_queries(bool wait)
+{
+    for (auto& query : queries) {
+        if (!query.pending) {
+            continue;
+        }
+        if (!wait) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                continue;
+            }
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsed);
+        query.pending = false;
+        add_gpu_time(query.frame, static_cast<double>(elapsed) * 1e-6);
+    }
+}
+
+void tinygl::frame_stats::frame_stats_private::release_queries()
+{
+    if (queries_created) {
+        for (auto& query : queries) {
+            glDeleteQueries(1, &query.id);
+            query = {};
+        }
+        queries_created = false;
+    }
+}
+
+tinygl::frame_stats::frame_stats(std::size_t capacity, double hitch_factor) :
+    p{std::make_unique<frame_stats_private>(capacity, hitch_factor)}
+{
+}
+
+tinygl::frame_stats::~frame_stats()
+{
+    p->release_queries();
+}
+
+void tinygl::frame_stats::begin_frame(std::source_location call_site)
+{
+    auto now = std::chrono::steady_clock::now();
+    p->current = {p->frames, 0.0f, 0.0f, -1.0f, 0.0f, false};
+    if (p->started) {
+        p->current.frame_ms = static_cast<float>(std::chrono::duration<double, std::milli>(now - p->frame_start).count());
+    }
+    p->frame_start = now;
+    p->started = true;
+
+    if (!p->queries_created) {
+        for (auto& query : p->queries) {
+            glGenQueries(1, &query.id);
+        }
+        p->queries_created = true;
+    }
+    // With every query still in flight the GPU is far behind; leave this frame untimed rather than wait.
+    auto free_query = std::find_if(p->queries.begin(), p->queries.end(), [](const query& q) { return !q.pending; });
+    if (free_query != p->queries.end()) {
+        glBeginQuery(GL_TIME_ELAPSED, free_query->id);
+        free_query->frame = p->frames;
+        p->active_query = &*free_query;
+    }
+    validation::check(call_site);
+}
+
+void tinygl::frame_stats::begin_swap(std::source_location call_site)
+{
+    if (p->active_query) {
+        glEndQuery(GL_TIME_ELAPSED);
+        p->active_query->pending = true;
+        p->active_query = nullptr;
+    }
+    p->swap_start = std::chrono::steady_clock::now();
+    p->current.cpu_ms = static_cast<float>(std::chrono::duration<double, std::milli>(p->swap_start - p->frame_start).count());
+    validation::check(call_site);
+}
+
+void tinygl::frame_stats::end_frame(std::source_location call_site)
+{
+    auto& current = p->current;
+    current.swap_ms = static_cast<float>(milliseconds_since(p->swap_start));
+
+    auto busy = static_cast<double>(current.cpu_ms) + current.swap_ms;
+    // The first frames include shader compilation and uploads, let the average settle before judging.
+    constexpr std::uint64_t warmup_frames = 16;
+    auto threshold = p->hitch_factor * p->average_busy_ms;
+    auto smoothing = 1.0 / 32.0;
+    if (p->frames >= warmup_frames && busy > threshold) {
+        current.hitch = true;
+        ++p->hitches;
+        // Hitches still move the average, slowly and clamped, so a lasting step up in workload becomes the new
+        // baseline instead of flagging every frame after it, while a single spike barely counts.
+        smoothing = 1.0 / 128.0;
+        busy = threshold;
+    }
+    p->average_busy_ms = p->frames == 0 ? busy : p->average_busy_ms + smoothing * (busy - p->average_busy_ms);
+
+    if (current.frame_ms > 0.0f) {
+        p->histograms[static_cast<std::size_t>(metric::frame)].add(current.frame_ms);
+    }
+    p->histograms[static_cast<std::size_t>(metric::cpu)].add(current.cpu_ms);
+    p->histograms[static_cast<std::size_t>(metric::swap)].add(current.swap_ms);
+
+    p->ring[p->next] = current;
+    p->next = (p->next + 1) % p->ring.size();
+    p->size = std::min(p->size + 1, p->ring.size());
+    ++p->frames;
+
+    p->collect_queries(false);
+    validation::check(call_site);
+}
+
+void tinygl::frame_stats::finish(std::source_location call_site)
+{
+    if (p->active_query) {
+        glEndQuery(GL_TIME_ELAPSED);
+        p->active_query->pending = false;
+        p->active_query = nullptr;
+    }
+    p->collect_queries(true);
+    p->release_queries();
+    validation::check(call_site);
+
+    try {
+        if (!p->csv_path.empty()) {
+            write_csv(p->csv_path);
+        }
+        if (!p->json_path.empty()) {
+            write_json(p->json_path);
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("[tinygl::frame_stats] {}", e.what());
+    }
+}
+
+tinygl::frame_stats::summary tinygl::frame_stats::recent(metric metric) const
+{
+    std::vector<float> values;
+    values.reserve(p->size);
+    for (std::size_t i = 0; i < p->size; ++i) {
+        const auto& sample = p->ring[i];
+        switch (metric) {
+            case metric::frame:
+                if (sample.frame_ms > 0.0f) {
+                    values.push_back(sample.frame_ms);
+                }
+                break;
+            case metric::cpu:
+                values.push_back(sample.cpu_ms);
+                break;
+            case metric::gpu:
+                if (sample.gpu_ms >= 0.0f) {
+                    values.push_back(sample.gpu_ms);
+                }
+                break;
+            case metric::swap:
+                values.push_back(sample.swap_ms);
+                break;
+        }
+    }
+    return summarize(values);
+}
+
+tinygl::frame_stats::summary tinygl::frame_stats::overall(metric metric) const
+{
+    const auto& histogram = p->histograms[static_cast<std::size_t>(metric)];
+    if (histogram.count == 0) {
+        return {};
+    }
+    return {
+        histogram.count,
+        histogram.sum / static_cast<double>(histogram.count),
+        histogram.percentile(0.50),
+        histogram.percentile(0.95),
+        histogram.percentile(0.99),
+        histogram.max
+    };
+}
+
+std::uint64_t tinygl::frame_stats::frame_count() const
+{
+    return p->frames;
+}
+
+std::uint64_t tinygl::frame_stats::hitch_count() const
+{
+    return p->hitches;
+}
+
+std::vector<tinygl::frame_stats::sample> tinygl::frame_stats::samples() const
+{
+    std::vector<sample> samples;
+    samples.reserve(p->size);
+    auto oldest = p->size == p->ring.size() ? p->next : 0;
+    for (std::size_t i = 0; i < p->size; ++i) {
+        samples.push_back(p->ring[(oldest + i) % p->ring.size()]);
+    }
+    return samples;
+}
+
+void tinygl::frame_stats::draw_ui()
+{
+    if (!ImGui::Begin("Frame statistics", &p->graph_visible)) {
+        ImGui::End();
+        return;
+    }
+    for (auto m : {metric::frame, metric::cpu, metric::gpu, metric::swap}) {
+        auto s = recent(m);
+        ImGui::Text("%-5s p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms", metric_name(static_cast<std::size_t>(m)),
+                    s.p50, s.p95, s.p99, s.max);
+    }
+    ImGui::Text("hitches %llu / %llu frames", static_cast<unsigned long long>(p->hitches),
+                static_cast<unsigned long long>(p->frames));
+
+    // The ring is plotted in place: the stride skips the other members, the offset starts at the oldest sample.
+    auto count = static_cast<int>(p->size);
+    auto offset = p->size == p->ring.size() ? static_cast<int>(p->next) : 0;
+    auto stride = static_cast<int>(sizeof(sample));
+    auto scale_max = static_cast<float>(std::max(recent(metric::frame).p99, recent(metric::cpu).p99) * 1.5);
+    ImVec2 size{0.0f, 80.0f};
+    ImGui::PlotLines("frame", &p->ring[0].frame_ms, count, offset, nullptr, 0.0f, scale_max, size, stride);
+    ImGui::PlotLines("cpu", &p->ring[0].cpu_ms, count, offset, nullptr, 0.0f, scale_max, size, stride);
+    ImGui::PlotLines("gpu", &p->ring[0].gpu_ms, count, offset, nullptr, 0.0f, scale_max, size, stride);
+    ImGui::PlotLines("swap", &p->ring[0].swap_ms, count, offset, nullptr, 0.0f, scale_max, size, stride);
+    ImGui::End();
+}
+
+void tinygl::frame_stats::set_graph_visible(bool visible)
+{
+    p->graph_visible = visible;
+}
+
+bool tinygl::frame_stats::graph_visible() const
+{
+    return p->graph_visible;
+}
+
+void tinygl::frame_stats::write_csv(const std::filesystem::path& path) const
+{
+    std::ofstream file{path};
+    file << "frame,frame_ms,cpu_ms,gpu_ms,swap_ms,hitch\n";
+    for (const auto& sample : samples()) {
+        file << fmt::format("{},{:.3f},{:.3f},{:.3f},{:.3f},{}\n", sample.frame, sample.frame_ms, sample.cpu_ms,
+                            sample.gpu_ms, sample.swap_ms, sample.hitch ? 1 : 0);
+    }
+    if (!file) {
+        throw std::runtime_error(fmt::format("tinygl::frame_stats::write_csv(): could not write {}!", path.string()));
+    }
+}
+
+void tinygl::frame_stats::write_json(const std::filesystem::path& path) const
+{
+    auto write_summary = [](std::ofstream& file, const summary& s) {
+        file << fmt::format(
+            "{{ \"count\": {}, \"mean\": {:.3f}, \"p50\": {:.3f}, \"p95\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f} }}",
+            s.count, s.mean, s.p50, s.p95, s.p99, s.max);
+    };
+
+    std::ofstream file{path};
+    file << "{\n";
+    file << fmt::format("  \"frames\": {},\n  \"hitches\": {},\n  \"bin_width_ms\": {},\n", p->frames, p->hitches,
+                        bin_width_ms);
+    file << "  \"metrics\": {\n";
+    for (std::size_t m = 0; m < metric_count; ++m) {
+        file << fmt::format("    \"{}\": {{\n      \"overall\": ", metric_name(m));
+        write_summary(file, overall(static_cast<metric>(m)));
+        file << ",\n      \"recent\": ";
+        write_summary(file, recent(static_cast<metric>(m)));
+        // Sparse histogram as [bin, count] pairs; the last bin is open-ended.
+        file << ",\n      \"histogram\": [";
+        const auto& bins = p->histograms[m].bins;
+        auto first = true;
+        for (std::size_t i = 0; i < bins.size(); ++i) {
+            if (bins[i] != 0) {
+                file << fmt::format("{}[{}, {}]", first ? "" : ", ", i, bins[i]);
+                first = false;
+            }
+        }
+        file << fmt::format("]\n    }}{}\n", m + 1 < metric_count ? "," : "");
+    }
+    file << "  }\n}\n";
+    if (!file) {
+        throw std::runtime_error(fmt::format("tinygl::frame_stats::write_json(): could not write {}!", path.string()));
+    }
+}
+
+void tinygl::frame_stats::set_export_paths(std::filesystem::path csv, std::filesystem::path json)
+{
+    p->csv_path = std::move(csv);
+    p->json_path = std::move(json);
+}
@@ -0,0 +1,355 @@
+#include "tinygl/framebuffer.h"
+#include "texture_utils.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr GLenum gl_enum(tinygl::framebuffer::binding_target target)
+    {
+        switch(target) {
+        case tinygl::framebuffer::binding_target::gl_framebuffer: return GL_FRAMEBUFFER;
+        case tinygl::framebuffer::binding_target::gl_draw_framebuffer: return GL_DRAW_FRAMEBUFFER;
+        case tinygl::framebuffer::binding_target::gl_read_framebuffer: return GL_READ_FRAMEBUFFER;
+        }
+    }
+
+    constexpr GLenum gl_enum(tinygl::framebuffer::attachment attachment)
+    {
+        switch(attachment) {
+        case tinygl::framebuffer::attachment::gl_color_attachment0: return GL_COLOR_ATTACHMENT0;
+        case tinygl::framebuffer::attachment::gl_color_attachment1: return GL_COLOR_ATTACHMENT1;
+        case tinygl::framebuffer::attachment::gl_color_attachment2: return GL_COLOR_ATTACHMENT2;
+        case tinygl::framebuffer::attachment::gl_color_attachment3: return GL_COLOR_ATTACHMENT3;
+        case tinygl::framebuffer::attachment::gl_color_attachment4: return GL_COLOR_ATTACHMENT4;
+        case tinygl::framebuffer::attachment::gl_color_attachment5: return GL_COLOR_ATTACHMENT5;
+        case tinygl::framebuffer::attachment::gl_color_attachment6: return GL_COLOR_ATTACHMENT6;
+        case tinygl::framebuffer::attachment::gl_color_attachment7: return GL_COLOR_ATTACHMENT7;
+        case tinygl::framebuffer::attachment::gl_depth_attachment: return GL_DEPTH_ATTACHMENT;
+        case tinygl::framebuffer::attachment::gl_stencil_attachment: return GL_STENCIL_ATTACHMENT;
+        case tinygl::framebuffer::attachment::gl_depth_stencil_attachment: return GL_DEPTH_STENCIL_ATTACHMENT;
+        }
+    }
+
+    constexpr tinygl::framebuffer::status to_status(GLenum status)
+    {
+        using tinygl::framebuffer;
+        switch(status) {
+        case GL_FRAMEBUFFER_COMPLETE: return framebuffer::status::gl_framebuffer_complete;
+        case GL_FRAMEBUFFER_UNDEFINED: return framebuffer::status::gl_framebuffer_undefined;
+        case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT: return framebuffer::status::gl_framebuffer_incomplete_attachment;
+        case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+            return framebuffer::status::gl_framebuffer_incomplete_missing_attachment;
+        case GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER: return framebuffer::status::gl_framebuffer_incomplete_draw_buffer;
+        case GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER: return framebuffer::status::gl_framebuffer_incomplete_read_buffer;
+        case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE: return framebuffer::status::gl_framebuffer_incomplete_multisample;
+        case GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS:
+            return framebuffer::status::gl_framebuffer_incomplete_layer_targets;
+        default: return framebuffer::status::gl_framebuffer_unsupported;
+        }
+    }
+
+    constexpr GLenum gl_enum(tinygl::framebuffer::blit_filter filter)
+    {
+        switch(filter) {
+        case tinygl::framebuffer::blit_filter::nearest: return GL_NEAREST;
+        case tinygl::framebuffer::blit_filter::linear: return GL_LINEAR;
+        }
+    }
+}
+
+struct tinygl::renderbuffer::renderbuffer_private
+{
+    renderbuffer_private();
+    ~renderbuffer_private();
+
+    GLuint id = 0;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    GLsizei samples = 0;
+};
+
+tinygl::renderbuffer::renderbuffer_private::renderbuffer_private()
+{
+    glGenRenderbuffers(1, &id);
+}
+
+tinygl::renderbuffer::renderbuffer_private::~renderbuffer_private()
+{
+    glDeleteRenderbuffers(1, &id);
+}
+
+tinygl::renderbuffer::renderbuffer(
+        texture::internal_format internal_format, std::int32_t width, std::int32_t height, std::int32_t samples,
+        std::source_location call_site) :
+    p{std::make_unique<renderbuffer_private>()}
+{
+    p->width = width;
+    p->height = height;
+    p->samples = samples;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, p->id);
+    if (samples > 0) {
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, utils::gl_int(internal_format), width, height);
+    } else {
+        glRenderbufferStorage(GL_RENDERBUFFER, utils::gl_int(internal_format), width, height);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    validation::check(call_site);
+}
+
+tinygl::renderbuffer::~renderbuffer() = default;
+
+tinygl::renderbuffer::renderbuffer(renderbuffer&& other) noexcept = default;
+
+tinygl::renderbuffer& tinygl::renderbuffer::operator=(renderbuffer&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+std::int32_t tinygl::renderbuffer::width() const
+{
+    return p->width;
+}
+
+std::int32_t tinygl::renderbuffer::height() const
+{
+    return p->height;
+}
+
+std::int32_t tinygl::renderbuffer::samples() const
+{
+    return p->samples;
+}
+
+std::uint32_t tinygl::renderbuffer::id() const
+{
+    return p->id;
+}
+
+struct tinygl::framebuffer::framebuffer_private
+{
+    framebuffer_private();
+    ~framebuffer_private();
+
+    struct attachment_state
+    {
+        GLsizei width;
+        GLsizei height;
+        bool transient;
+    };
+
+    bool bound() const;
+    void attached(attachment attachment, GLsizei width, GLsizei height, bool transient);
+    void detached(attachment attachment);
+    void update_size();
+
+    GLuint id = 0;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    std::map<attachment, attachment_state> attachments;
+};
+
+tinygl::framebuffer::framebuffer_private::framebuffer_private()
+{
+    glGenFramebuffers(1, &id);
+}
+
+tinygl::framebuffer::framebuffer_private::~framebuffer_private()
+{
+    glDeleteFramebuffers(1, &id);
+}
+
+bool tinygl::framebuffer::framebuffer_private::bound() const
+{
+    GLint bound_id;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound_id);
+    return id == static_cast<GLuint>(bound_id);
+}
+
+void tinygl::framebuffer::framebuffer_private::attached(
+        attachment attachment, GLsizei attachment_width, GLsizei attachment_height, bool transient)
+{
+    attachments[attachment] = {attachment_width, attachment_height, transient};
+    update_size();
+}
+
+void tinygl::framebuffer::framebuffer_private::detached(attachment attachment)
+{
+    attachments.erase(attachment);
+    update_size();
+}
+
+void tinygl::framebuffer::framebuffer_private::update_size()
+{
+    // A framebuffer is as large as its smallest attachment, re-attached ones counting with their new size.
+    width = 0;
+    height = 0;
+    for (auto it = attachments.begin(); it != attachments.end(); ++it) {
+        const auto& state = it->second;
+        width = it == attachments.begin() ? state.width : std::min(width, state.width);
+        height = it == attachments.begin() ? state.height : std::min(height, state.height);
+    }
+}
+
+tinygl::framebuffer::framebuffer() : p{std::make_unique<framebuffer_private>()}
+{
+}
+
+tinygl::framebuffer::~framebuffer() = default;
+
+tinygl::framebuffer::framebuffer(framebuffer&& other) noexcept = default;
+
+tinygl::framebuffer& tinygl::framebuffer::operator=(framebuffer&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::framebuffer::bind(binding_target binding_target, std::source_location call_site)
+{
+    glBindFramebuffer(gl_enum(binding_target), p->id);
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::unbind(binding_target binding_target, std::source_location call_site)
+{
+    glBindFramebuffer(gl_enum(binding_target), 0);
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::attach(attachment attachment, texture& texture, std::int32_t level, bool transient,
+                                 std::source_location call_site)
+{
+    assert(p->bound());
+    glFramebufferTexture(GL_DRAW_FRAMEBUFFER, gl_enum(attachment), texture.id(), level);
+    p->attached(attachment, std::max(1, texture.width() >> level), std::max(1, texture.height() >> level), transient);
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::attach(attachment attachment, renderbuffer& renderbuffer, bool transient,
+                                 std::source_location call_site)
+{
+    assert(p->bound());
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, gl_enum(attachment), GL_RENDERBUFFER, renderbuffer.id());
+    p->attached(attachment, renderbuffer.width(), renderbuffer.height(), transient);
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::detach(attachment attachment, std::source_location call_site)
+{
+    assert(p->bound());
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, gl_enum(attachment), GL_RENDERBUFFER, 0);
+    p->detached(attachment);
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::set_draw_buffers(std::initializer_list<attachment> attachments,
+                                           std::source_location call_site)
+{
+    set_draw_buffers(std::span<const attachment>{attachments.begin(), attachments.size()}, call_site);
+}
+
+void tinygl::framebuffer::set_draw_buffers(std::span<const attachment> attachments, std::source_location call_site)
+{
+    assert(p->bound());
+    std::vector<GLenum> buffers;
+    buffers.reserve(attachments.size());
+    for (auto attachment : attachments) {
+        buffers.push_back(gl_enum(attachment));
+    }
+    glDrawBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+    validation::check(call_site);
+}
+
+tinygl::framebuffer::status tinygl::framebuffer::check_status()
+{
+    assert(p->bound());
+    return to_status(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER));
+}
+
+bool tinygl::framebuffer::complete()
+{
+    return check_status() == status::gl_framebuffer_complete;
+}
+
+void tinygl::framebuffer::invalidate(std::initializer_list<attachment> attachments, std::source_location call_site)
+{
+    assert(p->bound());
+    std::vector<GLenum> buffers;
+    buffers.reserve(attachments.size());
+    for (auto attachment : attachments) {
+        buffers.push_back(gl_enum(attachment));
+    }
+    glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLsizei>(buffers.size()), buffers.data());
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::discard(std::source_location call_site)
+{
+    assert(p->bound());
+    std::vector<GLenum> buffers;
+    for (const auto& [attachment, state] : p->attachments) {
+        if (state.transient) {
+            buffers.push_back(gl_enum(attachment));
+        }
+    }
+    if (!buffers.empty()) {
+        glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLsizei>(buffers.size()), buffers.data());
+    }
+    validation::check(call_site);
+}
+
+void tinygl::framebuffer::blit(framebuffer* target, buffer_bit mask, blit_filter filter)
+{
+    auto width = target ? target->p->width : p->width;
+    auto height = target ? target->p->height : p->height;
+    blit(target, mask, p->width, p->height, width, height, filter);
+}
+
+void tinygl::framebuffer::blit(framebuffer* target, buffer_bit mask, std::int32_t width, std::int32_t height,
+                               std::int32_t target_width, std::int32_t target_height, blit_filter filter,
+                               std::source_location call_site)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, p->id);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->p->id : 0);
+    glBlitFramebuffer(
+        0, 0, width, height, 0, 0, target_width, target_height, static_cast<GLbitfield>(mask), gl_enum(filter));
+    validation::check(call_site);
+}
+
+std::int32_t tinygl::framebuffer::width() const
+{
+    return p->width;
+}
+
+std::int32_t tinygl::framebuffer::height() const
+{
+    return p->height;
+}
+
+std::string tinygl::framebuffer::to_string(const status& status)
+{
+    switch (status) {
+        case status::gl_framebuffer_complete: return "GL_FRAMEBUFFER_COMPLETE";
+        case status::gl_framebuffer_undefined: return "GL_FRAMEBUFFER_UNDEFINED";
+        case status::gl_framebuffer_incomplete_attachment: return "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
+        case status::gl_framebuffer_incomplete_missing_attachment:
+            return "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
+        case status::gl_framebuffer_incomplete_draw_buffer: return "GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER";
+        case status::gl_framebuffer_incomplete_read_buffer: return "GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER";
+        case status::gl_framebuffer_unsupported: return "GL_FRAMEBUFFER_UNSUPPORTED";
+        case status::gl_framebuffer_incomplete_multisample: return "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
+        case status::gl_framebuffer_incomplete_layer_targets: return "GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS";
+        default: return "";
+    }
+}
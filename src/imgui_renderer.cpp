@@ -0,0 +1,426 @@
+#include "imgui_renderer.h"
+#include "imgui.h"
+
+#include "tinygl/shader_program.h"
+#include "tinygl/streaming_buffer.h"
+#include "tinygl/vertex_array_object.h"
+#include "state_cache.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+    constexpr auto vertex_shader_source = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uv;
+layout (location = 2) in vec4 color;
+uniform mat4 projection;
+out vec2 fragment_uv;
+out vec4 fragment_color;
+void main()
+{
+    fragment_uv = uv;
+    fragment_color = color;
+    gl_Position = projection * vec4(position, 0.0, 1.0);
+}
+)";
+
+    constexpr auto fragment_shader_source = R"(
+#version 330 core
+uniform sampler2D atlas;
+in vec2 fragment_uv;
+in vec4 fragment_color;
+out vec4 output_color;
+void main()
+{
+    output_color = fragment_color * texture(atlas, fragment_uv);
+}
+)";
+
+    // ImTextureID is a pointer in older Dear ImGui versions and an integer in newer ones.
+    template<typename T>
+    GLuint texture_name(T id)
+    {
+        if constexpr (std::is_pointer_v<T>) {
+            return static_cast<GLuint>(reinterpret_cast<std::intptr_t>(id));
+        } else {
+            return static_cast<GLuint>(id);
+        }
+    }
+
+    template<typename T = ImTextureID>
+    T texture_id(GLuint name)
+    {
+        if constexpr (std::is_pointer_v<T>) {
+            return reinterpret_cast<T>(static_cast<std::intptr_t>(name));
+        } else {
+            return static_cast<T>(name);
+        }
+    }
+
+    constexpr std::array ui_capabilities = {
+        tinygl::capability::gl_blend,
+        tinygl::capability::gl_cull_face,
+        tinygl::capability::gl_depth_test,
+        tinygl::capability::gl_stencil_test,
+        tinygl::capability::gl_scissor_test,
+        tinygl::capability::gl_primitive_restart
+    };
+
+    // Previous state, as far as the state cache knows it.
+    struct saved_state
+    {
+        std::array<bool, ui_capabilities.size()> capabilities;
+        tinygl::state_cache::blend_state blend;
+        GLuint program;
+        GLuint vertex_array;
+        GLuint active_unit;
+        GLuint texture;
+    };
+}
+
+struct tinygl::imgui_renderer::imgui_renderer_private
+{
+    imgui_renderer_private();
+
+#if IMGUI_VERSION_NUM >= 19200
+    static void update_texture(ImTextureData* texture);
+    static void destroy_texture(ImTextureData* texture);
+#else
+    void create_font_texture();
+    void destroy_font_texture();
+#endif
+    void setup_render_state(const ImDrawData* draw_data, std::size_t vertex_offset);
+
+    tinygl::shader_program program;
+    tinygl::vertex_array_object vao;
+    // Vertices and indices of a frame share one region; 256 KiB covers a busy debug UI, larger frames grow it.
+    tinygl::streaming_buffer stream{buffer::binding_target::gl_array_buffer, 256 << 10};
+    int projection_location = -1;
+#if IMGUI_VERSION_NUM < 19200
+    GLuint font_texture = 0;
+#endif
+};
+
+tinygl::imgui_renderer::imgui_renderer_private::imgui_renderer_private()
+{
+    program.add_shader_from_source_code(shader::type::gl_vertex_shader, vertex_shader_source);
+    program.add_shader_from_source_code(shader::type::gl_fragment_shader, fragment_shader_source);
+    program.link();
+    projection_location = program.uniform_location("projection");
+
+    // The sampler uniform never changes; set it once and leave the previous program bound.
+    auto previous_program = state_cache::program();
+    program.use();
+    program.set_uniform_value(program.uniform_location("atlas"), std::int32_t{0});
+    state_cache::use_program(previous_program);
+
+    auto previous_vertex_array = state_cache::vertex_array();
+    vao.bind();
+    vao.enable_attribute_array(0);
+    vao.enable_attribute_array(1);
+    vao.enable_attribute_array(2);
+    state_cache::bind_vertex_array(previous_vertex_array);
+}
+
+#if IMGUI_VERSION_NUM >= 19200
+void tinygl::imgui_renderer::imgui_renderer_private::update_texture(ImTextureData* texture)
+{
+    if (texture->Status == ImTextureStatus_WantDestroy && texture->UnusedFrames > 0) {
+        destroy_texture(texture);
+        return;
+    }
+    if (texture->Status != ImTextureStatus_WantCreate && texture->Status != ImTextureStatus_WantUpdates) {
+        return;
+    }
+
+    // Coverage-only atlases take a quarter of the RGBA upload, expanded to white with alpha by the swizzle.
+    auto alpha = texture->Format == ImTextureFormat_Alpha8;
+    auto format = alpha ? GL_RED : GL_RGBA;
+    auto previous_texture = state_cache::texture_2d(0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (texture->Status == ImTextureStatus_WantCreate) {
+        GLuint name = 0;
+        glGenTextures(1, &name);
+        state_cache::bind_texture(0, GL_TEXTURE_2D, name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, alpha ? GL_R8 : GL_RGBA8, texture->Width, texture->Height, 0, format,
+                     GL_UNSIGNED_BYTE, texture->GetPixels());
+        if (alpha) {
+            constexpr std::array<GLint, 4> swizzle = {GL_ONE, GL_ONE, GL_ONE, GL_RED};
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle.data());
+        }
+        texture->SetTexID(texture_id(name));
+    } else {
+        // Only the rectangles Dear ImGui touched, read straight out of its full-size pixel array.
+        state_cache::bind_texture(0, GL_TEXTURE_2D, texture_name(texture->GetTexID()));
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, texture->Width);
+        for (const auto& rect : texture->Updates) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.w, rect.h, format, GL_UNSIGNED_BYTE,
+                            texture->GetPixelsAt(rect.x, rect.y));
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    state_cache::bind_texture(0, GL_TEXTURE_2D, previous_texture);
+    texture->SetStatus(ImTextureStatus_OK);
+}
+
+void tinygl::imgui_renderer::imgui_renderer_private::destroy_texture(ImTextureData* texture)
+{
+    auto name = texture_name(texture->GetTexID());
+    if (name) {
+        state_cache::forget_texture(name);
+        glDeleteTextures(1, &name);
+    }
+    texture->SetTexID(ImTextureID_Invalid);
+    texture->SetStatus(ImTextureStatus_Destroyed);
+}
+#else
+void tinygl::imgui_renderer::imgui_renderer_private::create_font_texture()
+{
+    auto& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+
+    auto previous_texture = state_cache::texture_2d(0);
+    glGenTextures(1, &font_texture);
+    state_cache::bind_texture(0, GL_TEXTURE_2D, font_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    auto colored = false;
+#if IMGUI_VERSION_NUM >= 18700
+    colored = io.Fonts->TexPixelsUseColors;
+#endif
+    if (colored) {
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    } else {
+        // A quarter of the RGBA upload: coverage only, expanded to white with alpha by the swizzle.
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        constexpr std::array<GLint, 4> swizzle = {GL_ONE, GL_ONE, GL_ONE, GL_RED};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle.data());
+    }
+    state_cache::bind_texture(0, GL_TEXTURE_2D, previous_texture);
+    io.Fonts->SetTexID(texture_id(font_texture));
+}
+
+void tinygl::imgui_renderer::imgui_renderer_private::destroy_font_texture()
+{
+    if (font_texture) {
+        state_cache::forget_texture(font_texture);
+        glDeleteTextures(1, &font_texture);
+        font_texture = 0;
+        ImGui::GetIO().Fonts->SetTexID(texture_id(0));
+    }
+}
+#endif
+
+void tinygl::imgui_renderer::imgui_renderer_private::setup_render_state(
+        const ImDrawData* draw_data, std::size_t vertex_offset)
+{
+    state_cache::set_enabled(capability::gl_blend, true);
+    state_cache::set_enabled(capability::gl_cull_face, false);
+    state_cache::set_enabled(capability::gl_depth_test, false);
+    state_cache::set_enabled(capability::gl_stencil_test, false);
+    state_cache::set_enabled(capability::gl_scissor_test, true);
+    state_cache::set_enabled(capability::gl_primitive_restart, false);
+    state_cache::set_blend({
+        GL_FUNC_ADD, GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA});
+
+    auto width = static_cast<GLsizei>(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    auto height = static_cast<GLsizei>(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    glViewport(0, 0, width, height);
+
+    auto left = draw_data->DisplayPos.x;
+    auto right = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+    auto top = draw_data->DisplayPos.y;
+    auto bottom = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+    const float projection[16] = {
+        2.0f / (right - left), 0.0f, 0.0f, 0.0f,
+        0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
+        0.0f, 0.0f, -1.0f, 0.0f,
+        (right + left) / (left - right), (top + bottom) / (bottom - top), 0.0f, 1.0f
+    };
+    program.use();
+    program.set_uniform_value(projection_location, projection);
+
+    // The region moves every frame, so the attribute pointers do too; the element binding is part of the VAO.
+    vao.bind();
+    stream.bind(buffer::binding_target::gl_array_buffer);
+    stream.bind(buffer::binding_target::gl_element_array_buffer);
+    auto offset = static_cast<int>(vertex_offset);
+    constexpr auto stride = static_cast<int>(sizeof(ImDrawVert));
+    vao.set_attribute_array(
+        0, 2, data_type::gl_float, normalization::keep, stride, offset + static_cast<int>(offsetof(ImDrawVert, pos)));
+    vao.set_attribute_array(
+        1, 2, data_type::gl_float, normalization::keep, stride, offset + static_cast<int>(offsetof(ImDrawVert, uv)));
+    vao.set_attribute_array(
+        2, 4, data_type::gl_unsigned_byte, normalization::normalize, stride,
+        offset + static_cast<int>(offsetof(ImDrawVert, col)));
+}
+
+tinygl::imgui_renderer::imgui_renderer(std::source_location call_site) :
+    p{std::make_unique<imgui_renderer_private>()}
+{
+    auto& io = ImGui::GetIO();
+    io.BackendRendererName = "tinygl";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#if IMGUI_VERSION_NUM >= 19200
+    // Dear ImGui hands over the font atlas and its other textures in ImDrawData::Textures.
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+#endif
+    validation::check(call_site);
+}
+
+tinygl::imgui_renderer::~imgui_renderer()
+{
+#if IMGUI_VERSION_NUM >= 19200
+    for (auto* texture : ImGui::GetPlatformIO().Textures) {
+        if (texture->RefCount == 1) {
+            imgui_renderer_private::destroy_texture(texture);
+        }
+    }
+#else
+    p->destroy_font_texture();
+#endif
+    auto& io = ImGui::GetIO();
+    io.BackendRendererName = nullptr;
+    io.BackendFlags &= ~ImGuiBackendFlags_RendererHasVtxOffset;
+#if IMGUI_VERSION_NUM >= 19200
+    io.BackendFlags &= ~ImGuiBackendFlags_RendererHasTextures;
+#endif
+}
+
+void tinygl::imgui_renderer::new_frame(std::source_location call_site)
+{
+#if IMGUI_VERSION_NUM >= 19200
+    // Texture requests arrive with the draw data, see render().
+    static_cast<void>(call_site);
+#else
+    auto* fonts = ImGui::GetIO().Fonts;
+    if (!p->font_texture || texture_name(fonts->TexID) != p->font_texture) {
+        p->destroy_font_texture();
+        p->create_font_texture();
+        validation::check(call_site);
+    }
+#endif
+}
+
+void tinygl::imgui_renderer::render(ImDrawData* draw_data, std::source_location call_site)
+{
+#if IMGUI_VERSION_NUM >= 19200
+    // Even when nothing is drawn, e.g. while minimized, so that destroyed textures are released.
+    if (draw_data->Textures) {
+        for (auto* texture : *draw_data->Textures) {
+            if (texture->Status != ImTextureStatus_OK) {
+                imgui_renderer_private::update_texture(texture);
+            }
+        }
+        validation::check(call_site);
+    }
+#endif
+
+    auto framebuffer_width = static_cast<int>(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    auto framebuffer_height = static_cast<int>(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (framebuffer_width <= 0 || framebuffer_height <= 0 || draw_data->TotalVtxCount == 0) {
+        return;
+    }
+
+    // Copy every draw list into this frame's region: all vertices first, then all indices.
+    constexpr std::size_t alignment = 16;
+    auto vertex_bytes = static_cast<std::size_t>(draw_data->TotalVtxCount) * sizeof(ImDrawVert);
+    auto index_bytes = static_cast<std::size_t>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
+    p->stream.begin_frame(vertex_bytes + index_bytes + 2 * alignment, call_site);
+    auto vertices = p->stream.allocate(vertex_bytes, alignment);
+    auto indices = p->stream.allocate(index_bytes, alignment);
+    auto* vertex_data = static_cast<std::uint8_t*>(vertices.data);
+    auto* index_data = static_cast<std::uint8_t*>(indices.data);
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const auto* list = draw_data->CmdLists[n];
+        auto list_vertex_bytes = static_cast<std::size_t>(list->VtxBuffer.Size) * sizeof(ImDrawVert);
+        auto list_index_bytes = static_cast<std::size_t>(list->IdxBuffer.Size) * sizeof(ImDrawIdx);
+        std::memcpy(vertex_data, list->VtxBuffer.Data, list_vertex_bytes);
+        std::memcpy(index_data, list->IdxBuffer.Data, list_index_bytes);
+        vertex_data += list_vertex_bytes;
+        index_data += list_index_bytes;
+    }
+    p->stream.flush(call_site);
+
+    saved_state saved{};
+    for (std::size_t i = 0; i < ui_capabilities.size(); ++i) {
+        saved.capabilities[i] = state_cache::enabled(ui_capabilities[i]);
+    }
+    saved.blend = state_cache::blend();
+    saved.program = state_cache::program();
+    saved.vertex_array = state_cache::vertex_array();
+    saved.active_unit = state_cache::active_texture();
+    saved.texture = state_cache::texture_2d(0);
+
+    p->setup_render_state(draw_data, vertices.offset);
+
+    constexpr GLenum index_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    auto clip_offset = draw_data->DisplayPos;
+    auto clip_scale = draw_data->FramebufferScale;
+    GLint list_vertex_offset = 0;
+    std::size_t list_index_offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const auto* list = draw_data->CmdLists[n];
+        for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+            const auto& command = list->CmdBuffer[i];
+            if (command.UserCallback) {
+                if (command.UserCallback == ImDrawCallback_ResetRenderState) {
+                    p->setup_render_state(draw_data, vertices.offset);
+                } else {
+                    command.UserCallback(list, &command);
+                }
+                continue;
+            }
+
+            auto min_x = (command.ClipRect.x - clip_offset.x) * clip_scale.x;
+            auto min_y = (command.ClipRect.y - clip_offset.y) * clip_scale.y;
+            auto max_x = (command.ClipRect.z - clip_offset.x) * clip_scale.x;
+            auto max_y = (command.ClipRect.w - clip_offset.y) * clip_scale.y;
+            if (max_x <= min_x || max_y <= min_y) {
+                continue;
+            }
+            glScissor(static_cast<GLint>(min_x), static_cast<GLint>(framebuffer_height - max_y),
+                      static_cast<GLsizei>(max_x - min_x), static_cast<GLsizei>(max_y - min_y));
+            state_cache::bind_texture(0, GL_TEXTURE_2D, texture_name(command.GetTexID()));
+            auto index_offset = indices.offset + (list_index_offset + command.IdxOffset) * sizeof(ImDrawIdx);
+            glDrawElementsBaseVertex(
+                GL_TRIANGLES, static_cast<GLsizei>(command.ElemCount), index_type,
+                reinterpret_cast<const void*>(index_offset),
+                list_vertex_offset + static_cast<GLint>(command.VtxOffset));
+        }
+        list_vertex_offset += list->VtxBuffer.Size;
+        list_index_offset += static_cast<std::size_t>(list->IdxBuffer.Size);
+    }
+    p->stream.end_frame(call_site);
+
+    for (std::size_t i = 0; i < ui_capabilities.size(); ++i) {
+        state_cache::set_enabled(ui_capabilities[i], saved.capabilities[i]);
+    }
+    state_cache::set_blend(saved.blend);
+    state_cache::use_program(saved.program);
+    state_cache::bind_vertex_array(saved.vertex_array);
+    state_cache::bind_texture(0, GL_TEXTURE_2D, saved.texture);
+    state_cache::active_texture(saved.active_unit);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    validation::check(call_site);
+}
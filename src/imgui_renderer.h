@@ -0,0 +1,37 @@
+#ifndef TINYGL_IMGUI_RENDERER_H
+#define TINYGL_IMGUI_RENDERER_H
+
+#include <memory>
+#include <source_location>
+
+struct ImDrawData;
+
+namespace tinygl {
+    /**
+     * Dear ImGui renderer backend on top of tinygl: draw lists are copied into a persistently mapped
+     * streaming_buffer and drawn from a single vertex array object with base-vertex draws. Instead of saving and
+     * restoring GL state with glGet, it sets state through tinygl's state cache and puts back what the cache knew.
+     * From Dear ImGui 1.92 on, the font atlas and any other textures come and go through ImDrawData::Textures
+     * (ImGuiBackendFlags_RendererHasTextures) and are updated by the rectangles that changed.
+     */
+    class imgui_renderer final
+    {
+    public:
+        // Requires a current context and a Dear ImGui context.
+        imgui_renderer(std::source_location call_site = std::source_location::current());
+        ~imgui_renderer();
+
+        imgui_renderer(const imgui_renderer&) = delete;
+        imgui_renderer& operator=(const imgui_renderer&) = delete;
+
+        // Uploads the font atlas the first time it is needed (or after it was rebuilt).
+        void new_frame(std::source_location call_site = std::source_location::current());
+        void render(ImDrawData* draw_data, std::source_location call_site = std::source_location::current());
+
+    private:
+        struct imgui_renderer_private;
+        std::unique_ptr<imgui_renderer_private> p;
+    };
+}
+
+#endif // TINYGL_IMGUI_RENDERER_H
@@ -0,0 +1,127 @@
+#include "mapped_file.h"
+#include "stb/stb_image.h"
+#include <fmt/format.h>
+#include <climits>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    [[noreturn]] void fail(const std::filesystem::path& file_name, const char* reason)
+    {
+        throw std::runtime_error(fmt::format("tinygl::utils::mapped_file: {} {}!", reason, file_name.string()));
+    }
+}
+
+tinygl::utils::mapped_file::mapped_file(const std::filesystem::path& file_name)
+{
+#ifdef _WIN32
+    auto file = CreateFileW(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        fail(file_name, "could not open");
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        fail(file_name, "could not query the size of");
+    }
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    if (length > 0) {
+        auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            bytes = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            // The view keeps the mapping alive.
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    auto file = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        fail(file_name, "could not open");
+    }
+    struct stat status{};
+    if (::fstat(file, &status) != 0) {
+        ::close(file);
+        fail(file_name, "could not query the size of");
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if (length > 0) {
+        auto* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (address != MAP_FAILED) {
+            bytes = static_cast<const std::uint8_t*>(address);
+            // Decoders read front to back.
+            ::madvise(address, length, MADV_SEQUENTIAL);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(file);
+#endif
+    if (length > 0 && !bytes) {
+        fail(file_name, "could not map");
+    }
+}
+
+tinygl::utils::mapped_file::~mapped_file()
+{
+    release();
+}
+
+tinygl::utils::mapped_file::mapped_file(mapped_file&& other) noexcept :
+    bytes{std::exchange(other.bytes, nullptr)}, length{std::exchange(other.length, 0)}
+{
+}
+
+tinygl::utils::mapped_file& tinygl::utils::mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+void tinygl::utils::mapped_file::release()
+{
+    if (!bytes) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+#else
+    ::munmap(const_cast<std::uint8_t*>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+unsigned char* tinygl::utils::load_image(const std::filesystem::path& file_name, int& width, int& height,
+                                         int& channels, int desired_channels, std::string& error)
+{
+    try {
+        mapped_file file{file_name};
+        if (file.size() > INT_MAX) {
+            error = fmt::format("{} is too large", file_name.string());
+            return nullptr;
+        }
+        auto* pixels = stbi_load_from_memory(
+            file.data(), static_cast<int>(file.size()), &width, &height, &channels, desired_channels);
+        if (!pixels) {
+            error = fmt::format("could not load {}: {}", file_name.string(), stbi_failure_reason());
+        }
+        return pixels;
+    } catch (const std::runtime_error& e) {
+        error = e.what();
+        return nullptr;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef TINYGL_MAPPED_FILE_H
+#define TINYGL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+
+namespace tinygl::utils {
+    /**
+     * Read-only memory mapping of a whole file. Pages are read on first access and belong to the page cache, so
+     * decoding or uploading straight from the mapping needs no heap copy of the file.
+     */
+    class mapped_file final
+    {
+    public:
+        // Throws if the file cannot be opened or mapped.
+        explicit mapped_file(const std::filesystem::path& file_name);
+        ~mapped_file();
+
+        mapped_file(mapped_file&& other) noexcept;
+        mapped_file& operator=(mapped_file&& other) noexcept;
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const std::uint8_t* data() const { return bytes; }
+        std::size_t size() const { return length; }
+        std::span<const std::uint8_t> span() const { return {bytes, length}; }
+
+    private:
+        void release();
+
+        const std::uint8_t* bytes = nullptr;
+        std::size_t length = 0;
+    };
+
+    /**
+     * Decodes an image with stb_image from a mapping of the file rather than through stdio, so the encoded file is
+     * never copied to the heap. Returns nullptr and sets `error` on failure; free the pixels with stbi_image_free().
+     */
+    unsigned char* load_image(const std::filesystem::path& file_name, int& width, int& height, int& channels,
+                              int desired_channels, std::string& error);
+}
+
+#endif // TINYGL_MAPPED_FILE_H
@@ -0,0 +1,409 @@
+#include "tinygl/mipmap_generator.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Rows of the next level filtered per task.
+    constexpr std::int32_t band_rows = 16;
+
+    // Taps of an output texel at x, reading source texels 2 * x + first onwards.
+    struct kernel
+    {
+        std::int32_t first = 0;
+        std::vector<float> weights;
+    };
+
+    float bessel_i0(float x)
+    {
+        auto sum = 1.0f;
+        auto term = 1.0f;
+        for (int k = 1; k < 20; ++k) {
+            auto factor = x / (2.0f * static_cast<float>(k));
+            term *= factor * factor;
+            sum += term;
+        }
+        return sum;
+    }
+
+    kernel make_kernel(tinygl::mipmap_filter filter, std::int32_t source_size)
+    {
+        if (source_size == 1) {
+            return {0, {1.0f}};
+        }
+        if (filter == tinygl::mipmap_filter::box) {
+            return {0, {0.5f, 0.5f}};
+        }
+
+        constexpr auto alpha = 4.0f;
+        constexpr auto radius = 2.0f;
+        kernel result{-3, {}};
+        auto sum = 0.0f;
+        for (int tap = -3; tap <= 4; ++tap) {
+            // Distance between the tap and the centre of the output texel, in output texels; never zero.
+            auto x = (static_cast<float>(tap) - 0.5f) / 2.0f;
+            auto sinc = std::sin(std::numbers::pi_v<float> * x) / (std::numbers::pi_v<float> * x);
+            auto ratio = x / radius;
+            auto window = bessel_i0(alpha * std::sqrt(1.0f - ratio * ratio)) / bessel_i0(alpha);
+            result.weights.push_back(sinc * window);
+            sum += sinc * window;
+        }
+        for (auto& weight : result.weights) {
+            weight /= sum;
+        }
+        return result;
+    }
+
+    const std::array<float, 256>& srgb_to_linear()
+    {
+        static const auto table = [] {
+            std::array<float, 256> result;
+            for (std::size_t i = 0; i < result.size(); ++i) {
+                auto value = static_cast<float>(i) / 255.0f;
+                result[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    std::uint8_t linear_to_srgb(float value)
+    {
+        // Linear interpolation between 4096 samples is exact to well below one step of 8 bits.
+        constexpr std::size_t steps = 4096;
+        static const auto table = [] {
+            std::array<float, steps + 1> result;
+            for (std::size_t i = 0; i <= steps; ++i) {
+                auto linear = static_cast<float>(i) / steps;
+                result[i] = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+            }
+            return result;
+        }();
+        auto position = std::clamp(value, 0.0f, 1.0f) * steps;
+        auto index = std::min(static_cast<std::size_t>(position), steps - 1);
+        auto fraction = position - static_cast<float>(index);
+        auto encoded = table[index] + (table[index + 1] - table[index]) * fraction;
+        return static_cast<std::uint8_t>(std::lround(encoded * 255.0f));
+    }
+
+    // Texels are always four floats, whatever the channel count, so one SSE register holds one texel.
+    void filter_row(const float* source, std::int32_t source_width, float* target, std::int32_t target_width,
+                    const kernel& kernel)
+    {
+        auto taps = static_cast<std::int32_t>(kernel.weights.size());
+        for (std::int32_t x = 0; x < target_width; ++x) {
+#if defined(__SSE2__)
+            auto sum = _mm_setzero_ps();
+            for (std::int32_t tap = 0; tap < taps; ++tap) {
+                auto source_x = std::clamp(2 * x + kernel.first + tap, 0, source_width - 1);
+                auto weight = _mm_set1_ps(kernel.weights[static_cast<std::size_t>(tap)]);
+                sum = _mm_add_ps(sum, _mm_mul_ps(weight, _mm_loadu_ps(source + 4 * source_x)));
+            }
+            _mm_storeu_ps(target + 4 * x, sum);
+#else
+            std::array<float, 4> sum{};
+            for (std::int32_t tap = 0; tap < taps; ++tap) {
+                auto source_x = std::clamp(2 * x + kernel.first + tap, 0, source_width - 1);
+                auto weight = kernel.weights[static_cast<std::size_t>(tap)];
+                for (std::size_t c = 0; c < 4; ++c) {
+                    sum[c] += weight * source[4 * source_x + c];
+                }
+            }
+            std::copy(sum.begin(), sum.end(), target + 4 * x);
+#endif
+        }
+    }
+
+    // Weighted sum of `rows`, each `count` floats long; `count` is a multiple of four.
+    void blend_rows(const std::vector<const float*>& rows, const std::vector<float>& weights, float* target,
+                    std::size_t count)
+    {
+#if defined(__SSE2__)
+        for (std::size_t i = 0; i < count; i += 4) {
+            auto sum = _mm_setzero_ps();
+            for (std::size_t tap = 0; tap < rows.size(); ++tap) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(rows[tap] + i)));
+            }
+            _mm_storeu_ps(target + i, sum);
+        }
+#else
+        std::fill_n(target, count, 0.0f);
+        for (std::size_t tap = 0; tap < rows.size(); ++tap) {
+            for (std::size_t i = 0; i < count; ++i) {
+                target[i] += weights[tap] * rows[tap][i];
+            }
+        }
+#endif
+    }
+
+    struct chain
+    {
+        tinygl::image_view source;
+        std::int32_t level_count;
+        float coverage = 0.0f;     // of the base level, if alpha coverage is preserved
+        float alpha_scale = 1.0f;  // of the level being written
+        kernel horizontal;
+        kernel vertical;
+        // Linear, four floats per texel.
+        std::int32_t width;
+        std::int32_t height;
+        std::vector<float> current;
+        std::vector<float> next;
+        std::vector<tinygl::image_level> levels;
+    };
+
+    struct band
+    {
+        chain* owner;
+        std::int32_t first_row;
+        std::int32_t rows;
+    };
+
+    std::vector<band> make_bands(const std::vector<chain*>& chains, std::int32_t level)
+    {
+        std::vector<band> result;
+        for (auto* chain : chains) {
+            auto height = level == 0 ? chain->height : std::max(1, chain->height / 2);
+            for (std::int32_t row = 0; row < height; row += band_rows) {
+                result.push_back({chain, row, std::min(band_rows, height - row)});
+            }
+        }
+        return result;
+    }
+
+    void decode_band(const band& band, bool srgb)
+    {
+        const auto& source = band.owner->source;
+        const auto& to_linear = srgb_to_linear();
+        for (auto y = band.first_row; y < band.first_row + band.rows; ++y) {
+            for (std::int32_t x = 0; x < source.width; ++x) {
+                auto index = static_cast<std::size_t>(y) * source.width + x;
+                const auto* in = source.pixels + index * source.channels;
+                auto* out = band.owner->current.data() + index * 4;
+                out[3] = 1.0f;
+                for (std::int32_t c = 0; c < source.channels; ++c) {
+                    out[c] = srgb && c < 3 ? to_linear[in[c]] : static_cast<float>(in[c]) / 255.0f;
+                }
+            }
+        }
+    }
+
+    void filter_band(const band& band)
+    {
+        const auto& chain = *band.owner;
+        auto next_width = std::max(1, chain.width / 2);
+        auto stride = static_cast<std::size_t>(next_width) * 4;
+        const auto& vertical = chain.vertical;
+
+        // Every source row the band reads is filtered horizontally once; rows past the edges are clamped.
+        auto first_source_row = 2 * band.first_row + vertical.first;
+        auto source_rows = 2 * (band.rows - 1) + static_cast<std::int32_t>(vertical.weights.size());
+        std::vector<float> filtered(static_cast<std::size_t>(source_rows) * stride);
+        for (std::int32_t i = 0; i < source_rows; ++i) {
+            auto y = std::clamp(first_source_row + i, 0, chain.height - 1);
+            filter_row(chain.current.data() + static_cast<std::size_t>(y) * chain.width * 4, chain.width,
+                       filtered.data() + static_cast<std::size_t>(i) * stride, next_width, chain.horizontal);
+        }
+
+        std::vector<const float*> rows(vertical.weights.size());
+        for (auto y = band.first_row; y < band.first_row + band.rows; ++y) {
+            for (std::size_t tap = 0; tap < rows.size(); ++tap) {
+                auto row = 2 * y + vertical.first + static_cast<std::int32_t>(tap) - first_source_row;
+                rows[tap] = filtered.data() + static_cast<std::size_t>(row) * stride;
+            }
+            blend_rows(rows, vertical.weights, band.owner->next.data() + static_cast<std::size_t>(y) * stride, stride);
+        }
+    }
+
+    void encode_band(const band& band, bool srgb)
+    {
+        auto& chain = *band.owner;
+        auto& level = chain.levels.back();
+        auto channels = chain.source.channels;
+        for (auto y = band.first_row; y < band.first_row + band.rows; ++y) {
+            for (std::int32_t x = 0; x < level.width; ++x) {
+                auto index = static_cast<std::size_t>(y) * level.width + x;
+                const auto* in = chain.next.data() + index * 4;
+                auto* out = level.pixels.data() + index * channels;
+                for (std::int32_t c = 0; c < channels; ++c) {
+                    auto value = c == 3 ? in[c] * chain.alpha_scale : in[c];
+                    out[c] = srgb && c < 3 ? linear_to_srgb(value)
+                                           : static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+                }
+            }
+        }
+    }
+
+    float coverage(const std::vector<float>& texels, float cutoff, float scale)
+    {
+        std::size_t passing = 0;
+        for (std::size_t i = 3; i < texels.size(); i += 4) {
+            passing += texels[i] * scale >= cutoff ? 1 : 0;
+        }
+        return static_cast<float>(passing) / static_cast<float>(texels.size() / 4);
+    }
+
+    // Scale, up to 4, whose coverage is closest to the base level's; coverage only grows with the scale.
+    float alpha_scale(const chain& chain, float cutoff)
+    {
+        auto low = 0.0f;
+        auto high = 4.0f;
+        for (int i = 0; i < 12; ++i) {
+            auto middle = (low + high) / 2.0f;
+            if (coverage(chain.next, cutoff, middle) < chain.coverage) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        auto below = chain.coverage - coverage(chain.next, cutoff, low);
+        auto above = coverage(chain.next, cutoff, high) - chain.coverage;
+        return below < above ? low : high;
+    }
+}
+
+struct tinygl::mipmap_generator::mipmap_generator_private
+{
+    explicit mipmap_generator_private(std::size_t thread_count) : workers{std::max<std::size_t>(thread_count, 1)} {}
+
+    // Runs job(0) to job(count - 1) on the workers and waits for all of them; rethrows the first exception.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& job);
+
+    utils::thread_pool workers;
+};
+
+void tinygl::mipmap_generator::mipmap_generator_private::parallel_for(
+        std::size_t count, const std::function<void(std::size_t)>& job)
+{
+    std::latch done{static_cast<std::ptrdiff_t>(count)};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    for (std::size_t i = 0; i < count; ++i) {
+        workers.submit([&, i] {
+            try {
+                job(i);
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                error = error ? error : std::current_exception();
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+tinygl::mipmap_generator::mipmap_generator(std::size_t thread_count) :
+    p{std::make_unique<mipmap_generator_private>(thread_count)}
+{
+}
+
+tinygl::mipmap_generator::~mipmap_generator() = default;
+
+tinygl::mipmap_generator::mipmap_generator(mipmap_generator&& other) noexcept = default;
+
+tinygl::mipmap_generator& tinygl::mipmap_generator::operator=(mipmap_generator&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+std::vector<tinygl::image_level> tinygl::mipmap_generator::generate(
+        const image_view& image, const mipmap_settings& settings)
+{
+    return std::move(generate(std::span{&image, 1}, settings).front());
+}
+
+std::vector<std::vector<tinygl::image_level>> tinygl::mipmap_generator::generate(
+        std::span<const image_view> images, const mipmap_settings& settings)
+{
+    std::vector<chain> chains;
+    chains.reserve(images.size());
+    for (const auto& image : images) {
+        if (!image.pixels || image.width < 1 || image.height < 1) {
+            throw std::invalid_argument("tinygl::mipmap_generator::generate(): empty image!");
+        }
+        if (image.channels < 1 || image.channels > 4) {
+            throw std::invalid_argument("tinygl::mipmap_generator::generate(): images have 1 to 4 channels!");
+        }
+        auto full = full_level_count(image.width, image.height);
+        auto level_count = settings.level_count > 0 ? std::min(settings.level_count, full) : full;
+        auto& chain = chains.emplace_back(image, level_count);
+        chain.width = image.width;
+        chain.height = image.height;
+    }
+
+    auto preserve_coverage = [&](const chain& chain) {
+        return settings.alpha_cutoff > 0.0f && chain.source.channels == 4;
+    };
+
+    std::vector<chain*> active;
+    for (auto& chain : chains) {
+        if (chain.level_count > 1) {
+            chain.current.resize(static_cast<std::size_t>(chain.width) * chain.height * 4);
+            active.push_back(&chain);
+        }
+    }
+    auto bands = make_bands(active, 0);
+    p->parallel_for(bands.size(), [&](std::size_t i) { decode_band(bands[i], settings.srgb); });
+    for (auto* chain : active) {
+        if (preserve_coverage(*chain)) {
+            chain->coverage = coverage(chain->current, settings.alpha_cutoff, 1.0f);
+        }
+    }
+
+    for (std::int32_t level = 1; !active.empty(); ++level) {
+        for (auto* chain : active) {
+            chain->horizontal = make_kernel(settings.filter, chain->width);
+            chain->vertical = make_kernel(settings.filter, chain->height);
+            auto width = std::max(1, chain->width / 2);
+            auto height = std::max(1, chain->height / 2);
+            chain->next.resize(static_cast<std::size_t>(width) * height * 4);
+            chain->levels.push_back({width, height, chain->source.channels,
+                                     std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height *
+                                                               chain->source.channels)});
+        }
+        bands = make_bands(active, level);
+        p->parallel_for(bands.size(), [&](std::size_t i) { filter_band(bands[i]); });
+        p->parallel_for(active.size(), [&](std::size_t i) {
+            if (preserve_coverage(*active[i])) {
+                active[i]->alpha_scale = alpha_scale(*active[i], settings.alpha_cutoff);
+            }
+        });
+        p->parallel_for(bands.size(), [&](std::size_t i) { encode_band(bands[i], settings.srgb); });
+
+        for (auto* chain : active) {
+            std::swap(chain->current, chain->next);
+            chain->width = chain->levels.back().width;
+            chain->height = chain->levels.back().height;
+        }
+        std::erase_if(active, [level](const chain* chain) { return level + 1 >= chain->level_count; });
+    }
+
+    std::vector<std::vector<image_level>> result;
+    result.reserve(chains.size());
+    for (auto& chain : chains) {
+        result.push_back(std::move(chain.levels));
+    }
+    return result;
+}
+
+std::int32_t tinygl::mipmap_generator::full_level_count(std::int32_t width, std::int32_t height)
+{
+    return static_cast<std::int32_t>(std::bit_width(static_cast<std::uint32_t>(std::max({width, height, 1}))));
+}
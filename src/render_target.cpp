@@ -0,0 +1,248 @@
+#include "tinygl/render_target.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    std::int32_t bucket(std::int32_t size, std::int32_t granularity)
+    {
+        return (std::max(size, 1) + granularity - 1) / granularity * granularity;
+    }
+
+    bool is_color(tinygl::framebuffer::attachment attachment)
+    {
+        using tinygl::framebuffer;
+        return attachment != framebuffer::attachment::gl_depth_attachment &&
+               attachment != framebuffer::attachment::gl_stencil_attachment &&
+               attachment != framebuffer::attachment::gl_depth_stencil_attachment;
+    }
+}
+
+struct tinygl::render_target::render_target_private
+{
+    // Reallocates the attachments when the scaled output size left the allocated bucket.
+    void allocate();
+
+    std::vector<attachment_spec> specs;
+    float scale = 1.0f;
+    std::int32_t samples = 0;
+    std::int32_t granularity = 64;
+
+    std::int32_t output_width = 1;
+    std::int32_t output_height = 1;
+    std::int32_t width = 1;
+    std::int32_t height = 1;
+    std::int32_t allocated_width = 0;
+    std::int32_t allocated_height = 0;
+    std::uint64_t reallocations = 0;
+
+    std::optional<tinygl::framebuffer> framebuffer;
+    std::vector<std::pair<tinygl::framebuffer::attachment, texture>> textures;
+    std::vector<renderbuffer> renderbuffers;
+};
+
+void tinygl::render_target::render_target_private::allocate()
+{
+    auto new_width = bucket(width, granularity);
+    auto new_height = bucket(height, granularity);
+    if (framebuffer && new_width == allocated_width && new_height == allocated_height) {
+        return;
+    }
+
+    // Release the old storage first, holding both at once is what makes large targets run out of memory.
+    framebuffer.reset();
+    textures.clear();
+    renderbuffers.clear();
+    renderbuffers.reserve(specs.size());
+
+    framebuffer.emplace();
+    framebuffer->bind();
+    std::vector<tinygl::framebuffer::attachment> draw_buffers;
+    for (const auto& spec : specs) {
+        if (spec.sampled) {
+            auto target = samples > 0 ? texture::target::gl_texture_2d_multisample : texture::target::gl_texture_2d;
+            auto& [attachment, texture] = textures.emplace_back(
+                spec.attachment, tinygl::texture{target, spec.internal_format, new_width, new_height, 0, samples});
+            framebuffer->attach(attachment, texture, 0, spec.transient);
+        } else {
+            auto& renderbuffer = renderbuffers.emplace_back(spec.internal_format, new_width, new_height, samples);
+            framebuffer->attach(spec.attachment, renderbuffer, spec.transient);
+        }
+        if (is_color(spec.attachment)) {
+            draw_buffers.push_back(spec.attachment);
+        }
+    }
+    framebuffer->set_draw_buffers(draw_buffers);
+
+    auto status = framebuffer->check_status();
+    framebuffer->unbind();
+    if (status != tinygl::framebuffer::status::gl_framebuffer_complete) {
+        throw std::runtime_error(fmt::format(
+            "tinygl::render_target::allocate(): framebuffer is incomplete: {}!",
+            tinygl::framebuffer::to_string(status)));
+    }
+
+    allocated_width = new_width;
+    allocated_height = new_height;
+    ++reallocations;
+}
+
+tinygl::render_target::render_target(
+        std::vector<attachment_spec> attachments, float scale, std::int32_t samples, std::int32_t granularity) :
+    p{std::make_unique<render_target_private>()}
+{
+    if (attachments.empty() || scale <= 0.0f || granularity < 1) {
+        throw std::invalid_argument("tinygl::render_target::render_target(): invalid arguments!");
+    }
+    p->specs = std::move(attachments);
+    p->scale = scale;
+    p->samples = samples;
+    p->granularity = granularity;
+}
+
+tinygl::render_target::~render_target() = default;
+
+tinygl::render_target::render_target(render_target&& other) noexcept = default;
+
+tinygl::render_target& tinygl::render_target::operator=(render_target&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::render_target::resize(std::int32_t width, std::int32_t height)
+{
+    p->output_width = std::max(width, 1);
+    p->output_height = std::max(height, 1);
+    p->width = std::max(static_cast<std::int32_t>(std::lround(p->output_width * p->scale)), 1);
+    p->height = std::max(static_cast<std::int32_t>(std::lround(p->output_height * p->scale)), 1);
+}
+
+void tinygl::render_target::bind(std::source_location call_site)
+{
+    p->allocate();
+    p->framebuffer->bind(framebuffer::binding_target::gl_framebuffer, call_site);
+    glViewport(0, 0, p->width, p->height);
+    validation::check(call_site);
+}
+
+void tinygl::render_target::unbind(std::source_location call_site)
+{
+    if (p->framebuffer) {
+        p->framebuffer->unbind(framebuffer::binding_target::gl_framebuffer, call_site);
+    }
+    glViewport(0, 0, p->output_width, p->output_height);
+    validation::check(call_site);
+}
+
+tinygl::framebuffer& tinygl::render_target::get_framebuffer()
+{
+    p->allocate();
+    return *p->framebuffer;
+}
+
+tinygl::texture* tinygl::render_target::get_texture(framebuffer::attachment attachment)
+{
+    p->allocate();
+    auto it = std::ranges::find(p->textures, attachment, &std::pair<framebuffer::attachment, texture>::first);
+    return it != p->textures.end() ? &it->second : nullptr;
+}
+
+std::int32_t tinygl::render_target::width() const
+{
+    return p->width;
+}
+
+std::int32_t tinygl::render_target::height() const
+{
+    return p->height;
+}
+
+std::tuple<float, float> tinygl::render_target::uv_scale() const
+{
+    auto allocated_width = bucket(p->width, p->granularity);
+    auto allocated_height = bucket(p->height, p->granularity);
+    return {static_cast<float>(p->width) / allocated_width, static_cast<float>(p->height) / allocated_height};
+}
+
+void tinygl::render_target::blit(framebuffer* target, buffer_bit mask, framebuffer::blit_filter filter)
+{
+    p->allocate();
+    auto target_width = target ? target->width() : p->output_width;
+    auto target_height = target ? target->height() : p->output_height;
+    p->framebuffer->blit(target, mask, p->width, p->height, target_width, target_height, filter);
+}
+
+std::uint64_t tinygl::render_target::reallocation_count() const
+{
+    return p->reallocations;
+}
+
+struct tinygl::render_target_registry::render_target_registry_private
+{
+    std::vector<std::weak_ptr<render_target>> targets;
+    std::int32_t granularity = 64;
+    std::int32_t width = 1;
+    std::int32_t height = 1;
+};
+
+tinygl::render_target_registry::render_target_registry() : p{std::make_unique<render_target_registry_private>()}
+{
+}
+
+tinygl::render_target_registry::~render_target_registry() = default;
+
+tinygl::render_target_registry::render_target_registry(render_target_registry&& other) noexcept = default;
+
+tinygl::render_target_registry& tinygl::render_target_registry::operator=(render_target_registry&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+std::shared_ptr<tinygl::render_target> tinygl::render_target_registry::create(
+        std::vector<render_target::attachment_spec> attachments, float scale, std::int32_t samples)
+{
+    auto target = std::make_shared<render_target>(std::move(attachments), scale, samples, p->granularity);
+    target->resize(p->width, p->height);
+    std::erase_if(p->targets, [](const auto& target) { return target.expired(); });
+    p->targets.push_back(target);
+    return target;
+}
+
+void tinygl::render_target_registry::set_granularity(std::int32_t pixels)
+{
+    if (pixels < 1) {
+        throw std::invalid_argument("tinygl::render_target_registry::set_granularity(): granularity must be positive!");
+    }
+    p->granularity = pixels;
+}
+
+void tinygl::render_target_registry::resize(std::int32_t width, std::int32_t height)
+{
+    p->width = width;
+    p->height = height;
+    std::erase_if(p->targets, [width, height](const auto& weak) {
+        auto target = weak.lock();
+        if (!target) {
+            return true;
+        }
+        target->resize(width, height);
+        return false;
+    });
+}
+
+std::size_t tinygl::render_target_registry::size()
+{
+    std::erase_if(p->targets, [](const auto& target) { return target.expired(); });
+    return p->targets.size();
+}
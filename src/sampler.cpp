@@ -0,0 +1,97 @@
+#include "tinygl/sampler.h"
+#include "state_cache.h"
+#include "texture_utils.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <algorithm>
+
+namespace {
+    constexpr GLenum gl_enum(tinygl::compare_func compare_func)
+    {
+        switch (compare_func) {
+        case tinygl::compare_func::gl_never: return GL_NEVER;
+        case tinygl::compare_func::gl_less: return GL_LESS;
+        case tinygl::compare_func::gl_equal: return GL_EQUAL;
+        case tinygl::compare_func::gl_lequal: return GL_LEQUAL;
+        case tinygl::compare_func::gl_greater: return GL_GREATER;
+        case tinygl::compare_func::gl_notequal: return GL_NOTEQUAL;
+        case tinygl::compare_func::gl_gequal: return GL_GEQUAL;
+        case tinygl::compare_func::gl_always: return GL_ALWAYS;
+        }
+    }
+}
+
+struct tinygl::sampler::sampler_private
+{
+    explicit sampler_private(const sampler_state& state);
+    ~sampler_private();
+
+    GLuint id = 0;
+    sampler_state state;
+};
+
+tinygl::sampler::sampler_private::sampler_private(const sampler_state& state) : state{state}
+{
+    glGenSamplers(1, &id);
+}
+
+tinygl::sampler::sampler_private::~sampler_private()
+{
+    state_cache::forget_sampler(id);
+    glDeleteSamplers(1, &id);
+}
+
+tinygl::sampler::sampler(const sampler_state& state,
+                         std::source_location call_site) : p{std::make_unique<sampler_private>(state)}
+{
+    auto id = p->id;
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_S, utils::gl_int(state.wrap_s));
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_T, utils::gl_int(state.wrap_t));
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_R, utils::gl_int(state.wrap_r));
+    glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, utils::gl_int(state.min_filter));
+    glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, utils::gl_int(state.mag_filter));
+    glSamplerParameterf(id, GL_TEXTURE_LOD_BIAS, state.lod_bias);
+    glSamplerParameterf(id, GL_TEXTURE_MIN_LOD, state.min_lod);
+    glSamplerParameterf(id, GL_TEXTURE_MAX_LOD, state.max_lod);
+    glSamplerParameteri(id, GL_TEXTURE_COMPARE_MODE, state.compare ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+    glSamplerParameteri(id, GL_TEXTURE_COMPARE_FUNC, static_cast<GLint>(gl_enum(state.compare_func)));
+    const auto& border = state.border_color;
+    const GLfloat border_color[] = {border.r, border.g, border.b, border.a};
+    glSamplerParameterfv(id, GL_TEXTURE_BORDER_COLOR, border_color);
+    // Same enums for ARB_texture_filter_anisotropic, EXT_texture_filter_anisotropic and OpenGL 4.6.
+    if (state.max_anisotropy > 1.0f && (GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic)) {
+        GLfloat max_anisotropy = 1.0f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_anisotropy);
+        glSamplerParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, std::min(state.max_anisotropy, max_anisotropy));
+    }
+    validation::check(call_site);
+}
+
+tinygl::sampler::~sampler() = default;
+
+tinygl::sampler::sampler(sampler&& other) noexcept = default;
+
+tinygl::sampler& tinygl::sampler::operator=(sampler&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::sampler::bind(std::uint32_t unit, std::source_location call_site) const
+{
+    state_cache::bind_sampler(unit, p->id);
+    validation::check(call_site);
+}
+
+void tinygl::sampler::unbind(std::uint32_t unit, std::source_location call_site)
+{
+    state_cache::bind_sampler(unit, 0);
+    validation::check(call_site);
+}
+
+const tinygl::sampler_state& tinygl::sampler::state() const
+{
+    return p->state;
+}
@@ -0,0 +1,84 @@
+#include "tinygl/sampler_cache.h"
+#include <bit>
+#include <unordered_map>
+
+namespace {
+    // FNV-1a over the fields, so padding never takes part.
+    struct sampler_state_hash
+    {
+        std::size_t operator()(const tinygl::sampler_state& state) const
+        {
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            auto add = [&hash](std::uint32_t value) {
+                for (int byte = 0; byte < 4; ++byte) {
+                    hash = (hash ^ ((value >> (8 * byte)) & 0xffu)) * 0x100000001b3ull;
+                }
+            };
+            // -0.0f == 0.0f, so both have to hash alike.
+            auto add_float = [&add](float value) { add(std::bit_cast<std::uint32_t>(value == 0.0f ? 0.0f : value)); };
+
+            add(static_cast<std::uint32_t>(state.wrap_s));
+            add(static_cast<std::uint32_t>(state.wrap_t));
+            add(static_cast<std::uint32_t>(state.wrap_r));
+            add(static_cast<std::uint32_t>(state.min_filter));
+            add(static_cast<std::uint32_t>(state.mag_filter));
+            add_float(state.max_anisotropy);
+            add_float(state.lod_bias);
+            add_float(state.min_lod);
+            add_float(state.max_lod);
+            add(state.compare ? 1u : 0u);
+            add(static_cast<std::uint32_t>(state.compare_func));
+            add_float(state.border_color.r);
+            add_float(state.border_color.g);
+            add_float(state.border_color.b);
+            add_float(state.border_color.a);
+            return static_cast<std::size_t>(hash);
+        }
+    };
+}
+
+struct tinygl::sampler_cache::sampler_cache_private
+{
+    // Nodes of an unordered_map stay put on rehashing, so references to the samplers remain valid.
+    std::unordered_map<sampler_state, sampler, sampler_state_hash> samplers;
+};
+
+tinygl::sampler_cache::sampler_cache() : p{std::make_unique<sampler_cache_private>()}
+{
+}
+
+tinygl::sampler_cache::~sampler_cache() = default;
+
+tinygl::sampler_cache::sampler_cache(sampler_cache&& other) noexcept = default;
+
+tinygl::sampler_cache& tinygl::sampler_cache::operator=(sampler_cache&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+const tinygl::sampler& tinygl::sampler_cache::get(const sampler_state& state)
+{
+    auto it = p->samplers.find(state);
+    if (it == p->samplers.end()) {
+        it = p->samplers.try_emplace(state, state).first;
+    }
+    return it->second;
+}
+
+void tinygl::sampler_cache::bind(std::uint32_t unit, const sampler_state& state, std::source_location call_site)
+{
+    get(state).bind(unit, call_site);
+}
+
+std::size_t tinygl::sampler_cache::size() const
+{
+    return p->samplers.size();
+}
+
+void tinygl::sampler_cache::clear()
+{
+    p->samplers.clear();
+}
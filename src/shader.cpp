@@ -1,4 +1,5 @@
 #include "tinygl/shader.h"
+#include "validation.h"
 #include <GL/glew.h>
 #include <fmt/format.h>
 #include <iostream>
@@ -60,6 +61,7 @@ void tinygl::shader::shader_private::create()
             fmt::format("tinygl::shader::shader_private::create(): could not create {} shader!", to_string(shader_type))
         );
     }
+    validation::check();
 }
 
 void tinygl::shader::shader_private::compile()
@@ -86,6 +88,7 @@ void tinygl::shader::shader_private::compile()
             fmt::format("tinygl::shader: could not compile {} shader!", to_string(shader_type))
         );
     }
+    validation::check();
 }
 
 void tinygl::shader::shader_private::compile_source_code(std::string_view source)
@@ -1,4 +1,6 @@
 #include "tinygl/shader_program.h"
+#include "state_cache.h"
+#include "validation.h"
 #include <GL/glew.h>
 #include <fmt/format.h>
 #include <algorithm>
@@ -53,7 +55,7 @@ tinygl::shader_program& tinygl::shader_program::operator=(shader_program&& other
     return *this;
 }
 
-void tinygl::shader_program::add_shader(const std::shared_ptr<shader>& shader) {
+void tinygl::shader_program::add_shader(const std::shared_ptr<shader>& shader, std::source_location call_site) {
     if (std::find(p->shaders.begin(), p->shaders.end(), shader) != p->shaders.end()) {
         std::cout << "Shader is already added to the program!" << std::endl;
         return;
@@ -63,6 +65,7 @@ void tinygl::shader_program::add_shader(const std::shared_ptr<shader>& shader) {
         p->linked = false;
         p->shaders.push_back(shader);
     }
+    validation::check(call_site);
 }
 
 void tinygl::shader_program::add_shader_from_source_code(tinygl::shader::type type, std::string_view source)
@@ -77,7 +80,7 @@ void tinygl::shader_program::add_shader_from_source_file(tinygl::shader::type ty
     add_shader(s);
 }
 
-void tinygl::shader_program::remove_shader(std::shared_ptr<shader> shader)
+void tinygl::shader_program::remove_shader(std::shared_ptr<shader> shader, std::source_location call_site)
 {
     if (p->id && shader) {
         glDetachShader(p->id, shader->id());
@@ -85,9 +88,10 @@ void tinygl::shader_program::remove_shader(std::shared_ptr<shader> shader)
         shaders.erase(std::remove(shaders.begin(), shaders.end(), shader), shaders.end());
     }
     p->linked = false;
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::link()
+void tinygl::shader_program::link(std::source_location call_site)
 {
     if (!p->id || p->shaders.empty()) {
         return;
@@ -107,16 +111,18 @@ void tinygl::shader_program::link()
         std::cerr << info_log << std::endl;
         throw std::runtime_error("tinygl::shader_program::link(): could not link shader program!");
     }
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::use() {
+void tinygl::shader_program::use(std::source_location call_site) {
     if (!p->id) {
         return;
     }
     if (!p->linked) {
         link();
     }
-    glUseProgram(p->id);
+    state_cache::use_program(p->id);
+    validation::check(call_site);
 }
 
 int tinygl::shader_program::attribute_location(std::string_view name) const {
@@ -127,102 +133,125 @@ int tinygl::shader_program::attribute_location(std::string_view name) const {
     }
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLfloat value)
+void tinygl::shader_program::set_uniform_value(int location, GLfloat value, std::source_location call_site)
 {
     glUniform1f(location, value);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLint value)
+void tinygl::shader_program::set_uniform_value(int location, GLint value, std::source_location call_site)
 {
     glUniform1i(location, value);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLuint value)
+void tinygl::shader_program::set_uniform_value(int location, GLuint value, std::source_location call_site)
 {
     glUniform1ui(location, value);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y)
+void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y, std::source_location call_site)
 {
     glUniform2f(location, x, y);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y, GLfloat z)
+void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y, GLfloat z,
+                                               std::source_location call_site)
 {
     glUniform3f(location, x, y, z);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+void tinygl::shader_program::set_uniform_value(int location, GLfloat x, GLfloat y, GLfloat z, GLfloat w,
+                                               std::source_location call_site)
 {
     glUniform4f(location, x, y, z, w);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec2f& v)
+void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec2f& v, std::source_location call_site)
 {
     glUniform2fv(location, 1, v.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec3f& v)
+void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec3f& v, std::source_location call_site)
 {
     glUniform3fv(location, 1, v.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec4f& v)
+void tinygl::shader_program::set_uniform_value(int location, const tinyla::vec4f& v, std::source_location call_site)
 {
     glUniform4fv(location, 1, v.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const tinyla::mat4f& m)
+void tinygl::shader_program::set_uniform_value(int location, const tinyla::mat4f& m, std::source_location call_site)
 {
     glUniformMatrix4fv(location, 1, GL_FALSE, m.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const GLfloat m[4][4])
+void tinygl::shader_program::set_uniform_value(int location, const GLfloat m[4][4], std::source_location call_site)
 {
     glUniformMatrix4fv(location, 1, GL_FALSE, m[0]);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_uniform_value(int location, const GLfloat m[16])
+void tinygl::shader_program::set_uniform_value(int location, const GLfloat m[16], std::source_location call_site)
 {
     glUniformMatrix4fv(location, 1, GL_FALSE, m);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, GLfloat value)
+void tinygl::shader_program::set_attribute_value(int location, GLfloat value, std::source_location call_site)
 {
     glVertexAttrib1fv(location, &value);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y)
+void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y, std::source_location call_site)
 {
     GLfloat values[2] = {x, y};
     glVertexAttrib2fv(location, values);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y, GLfloat z)
+void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y, GLfloat z,
+                                                 std::source_location call_site)
 {
     GLfloat values[3] = {x, y, z};
     glVertexAttrib3fv(location, values);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+void tinygl::shader_program::set_attribute_value(int location, GLfloat x, GLfloat y, GLfloat z, GLfloat w,
+                                                 std::source_location call_site)
 {
     GLfloat values[4] = {x, y, z, w};
     glVertexAttrib4fv(location, values);
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec2f& v)
+void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec2f& v, std::source_location call_site)
 {
     glVertexAttrib2fv(location, v.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec3f& v)
+void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec3f& v, std::source_location call_site)
 {
     glVertexAttrib3fv(location, v.data());
+    validation::check(call_site);
 }
 
-void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec4f& v)
+void tinygl::shader_program::set_attribute_value(int location, const tinyla::vec4f& v, std::source_location call_site)
 {
     glVertexAttrib4fv(location, v.data());
+    validation::check(call_site);
 }
 
 int tinygl::shader_program::uniform_location(std::string_view name) const
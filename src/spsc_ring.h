@@ -0,0 +1,79 @@
+#ifndef TINYGL_SPSC_RING_H
+#define TINYGL_SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+
+namespace tinygl::utils {
+    /**
+     * Fixed-capacity ring for exactly one producer and one consumer thread. Neither side ever blocks or allocates;
+     * try_push() fails when the ring is full. Each side caches the other's index and only reloads it when the
+     * cached value says the ring is full (or empty), so the shared cache lines are touched rarely.
+     */
+    template<typename T, std::size_t Capacity>
+    class spsc_ring final
+    {
+        static_assert(std::has_single_bit(Capacity), "capacity must be a power of two");
+
+    public:
+        bool try_push(const T& value)
+        {
+            auto tail = producer.tail.load(std::memory_order_relaxed);
+            if (tail - producer.cached_head == Capacity) {
+                producer.cached_head = consumer.head.load(std::memory_order_acquire);
+                if (tail - producer.cached_head == Capacity) {
+                    return false;
+                }
+            }
+            cells[tail & (Capacity - 1)] = value;
+            producer.tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop(T& value)
+        {
+            auto head = consumer.head.load(std::memory_order_relaxed);
+            if (head == consumer.cached_tail) {
+                consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+                if (head == consumer.cached_tail) {
+                    return false;
+                }
+            }
+            value = cells[head & (Capacity - 1)];
+            consumer.head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Exact on the consumer thread, a hint anywhere else.
+        bool empty() const
+        {
+            return consumer.head.load(std::memory_order_acquire) == producer.tail.load(std::memory_order_acquire);
+        }
+
+        static constexpr std::size_t capacity() { return Capacity; }
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+
+        struct alignas(cache_line) producer_side
+        {
+            std::atomic<std::size_t> tail{0};
+            std::size_t cached_head = 0;
+        };
+
+        struct alignas(cache_line) consumer_side
+        {
+            std::atomic<std::size_t> head{0};
+            std::size_t cached_tail = 0;
+        };
+
+        producer_side producer;
+        consumer_side consumer;
+        std::array<T, Capacity> cells{};
+    };
+}
+
+#endif // TINYGL_SPSC_RING_H
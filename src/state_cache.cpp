@@ -0,0 +1,283 @@
+#include "state_cache.h"
+#include <array>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+    constexpr GLenum gl_enum(tinygl::capability capability)
+    {
+        switch(capability) {
+        case tinygl::capability::gl_blend: return GL_BLEND;
+        case tinygl::capability::gl_clip_distance0: return GL_CLIP_DISTANCE0;
+        case tinygl::capability::gl_clip_distance1: return GL_CLIP_DISTANCE1;
+        case tinygl::capability::gl_clip_distance2: return GL_CLIP_DISTANCE2;
+        case tinygl::capability::gl_clip_distance3: return GL_CLIP_DISTANCE3;
+        case tinygl::capability::gl_clip_distance4: return GL_CLIP_DISTANCE4;
+        case tinygl::capability::gl_clip_distance5: return GL_CLIP_DISTANCE5;
+        case tinygl::capability::gl_color_logic_op: return GL_COLOR_LOGIC_OP;
+        case tinygl::capability::gl_cull_face: return GL_CULL_FACE;
+        case tinygl::capability::gl_debug_output: return GL_DEBUG_OUTPUT;
+        case tinygl::capability::gl_debug_output_synchronous: return GL_DEBUG_OUTPUT_SYNCHRONOUS;
+        case tinygl::capability::gl_depth_clamp: return GL_DEPTH_CLAMP;
+        case tinygl::capability::gl_depth_test: return GL_DEPTH_TEST;
+        case tinygl::capability::gl_dither: return GL_DITHER;
+        case tinygl::capability::gl_framebuffer_srgb: return GL_FRAMEBUFFER_SRGB;
+        case tinygl::capability::gl_line_smooth: return GL_LINE_SMOOTH;
+        case tinygl::capability::gl_multisample: return GL_MULTISAMPLE;
+        case tinygl::capability::gl_polygon_offset_fill: return GL_POLYGON_OFFSET_FILL;
+        case tinygl::capability::gl_polygon_offset_line: return GL_POLYGON_OFFSET_LINE;
+        case tinygl::capability::gl_polygon_offset_point: return GL_POLYGON_OFFSET_POINT;
+        case tinygl::capability::gl_polygon_smooth: return GL_POLYGON_SMOOTH;
+        case tinygl::capability::gl_primitive_restart: return GL_PRIMITIVE_RESTART;
+        case tinygl::capability::gl_primitive_restart_fixed_index: return GL_PRIMITIVE_RESTART_FIXED_INDEX;
+        case tinygl::capability::gl_rasterizer_discard: return GL_RASTERIZER_DISCARD;
+        case tinygl::capability::gl_sample_alpha_to_coverage: return GL_SAMPLE_ALPHA_TO_COVERAGE;
+        case tinygl::capability::gl_sample_alpha_to_one: return GL_SAMPLE_ALPHA_TO_ONE;
+        case tinygl::capability::gl_sample_coverage: return GL_SAMPLE_COVERAGE;
+        case tinygl::capability::gl_sample_shading: return GL_SAMPLE_SHADING;
+        case tinygl::capability::gl_sample_mask: return GL_SAMPLE_MASK;
+        case tinygl::capability::gl_scissor_test: return GL_SCISSOR_TEST;
+        case tinygl::capability::gl_stencil_test: return GL_STENCIL_TEST;
+        case tinygl::capability::gl_texture_cube_map_seamless: return GL_TEXTURE_CUBE_MAP_SEAMLESS;
+        case tinygl::capability::gl_program_point_size: return GL_PROGRAM_POINT_SIZE;
+        }
+    }
+
+    constexpr std::size_t capability_count = static_cast<std::size_t>(tinygl::capability::gl_program_point_size) + 1;
+    constexpr std::size_t texture_unit_count = tinygl::state_cache::cached_texture_units;
+
+    struct cache
+    {
+        std::array<std::optional<bool>, capability_count> capabilities;
+        std::optional<GLuint> program;
+        std::optional<GLuint> vertex_array;
+        std::optional<GLuint> active_unit;
+        std::array<std::optional<GLuint>, texture_unit_count> textures_2d;
+        std::array<std::optional<GLuint>, texture_unit_count> samplers;
+        std::optional<tinygl::state_cache::blend_state> blend;
+    };
+
+    // A context is only ever current on one thread; each thread keeps a cache for every context it made current.
+    thread_local std::unordered_map<const void*, cache> caches;
+    thread_local cache* current_cache = nullptr;
+
+    cache& current()
+    {
+        if (!current_cache) {
+            current_cache = &caches[nullptr];
+        }
+        return *current_cache;
+    }
+
+    GLuint get_integer(GLenum name)
+    {
+        GLint value = 0;
+        glGetIntegerv(name, &value);
+        return static_cast<GLuint>(value);
+    }
+}
+
+void tinygl::state_cache::set_enabled(capability capability, bool enabled)
+{
+    auto& cached = current().capabilities[static_cast<std::size_t>(capability)];
+    if (cached == enabled) {
+        return;
+    }
+    if (enabled) {
+        glEnable(gl_enum(capability));
+    } else {
+        glDisable(gl_enum(capability));
+    }
+    cached = enabled;
+}
+
+bool tinygl::state_cache::enabled(capability capability)
+{
+    auto& cached = current().capabilities[static_cast<std::size_t>(capability)];
+    if (!cached) {
+        cached = glIsEnabled(gl_enum(capability)) == GL_TRUE;
+    }
+    return *cached;
+}
+
+void tinygl::state_cache::use_program(GLuint program)
+{
+    if (current().program != program) {
+        glUseProgram(program);
+        current().program = program;
+    }
+}
+
+GLuint tinygl::state_cache::program()
+{
+    if (!current().program) {
+        current().program = get_integer(GL_CURRENT_PROGRAM);
+    }
+    return *current().program;
+}
+
+void tinygl::state_cache::bind_vertex_array(GLuint vertex_array)
+{
+    if (current().vertex_array != vertex_array) {
+        glBindVertexArray(vertex_array);
+        current().vertex_array = vertex_array;
+    }
+}
+
+GLuint tinygl::state_cache::vertex_array()
+{
+    if (!current().vertex_array) {
+        current().vertex_array = get_integer(GL_VERTEX_ARRAY_BINDING);
+    }
+    return *current().vertex_array;
+}
+
+void tinygl::state_cache::forget_vertex_array(GLuint vertex_array)
+{
+    if (current().vertex_array == vertex_array) {
+        current().vertex_array = 0;
+    }
+}
+
+void tinygl::state_cache::active_texture(GLuint unit)
+{
+    if (current().active_unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        current().active_unit = unit;
+    }
+}
+
+GLuint tinygl::state_cache::active_texture()
+{
+    if (!current().active_unit) {
+        current().active_unit = get_integer(GL_ACTIVE_TEXTURE) - GL_TEXTURE0;
+    }
+    return *current().active_unit;
+}
+
+void tinygl::state_cache::bind_texture(GLuint unit, GLenum target, GLuint texture)
+{
+    // The unit is made active even when the binding is cached: texture methods work on whatever is bound to the
+    // active unit.
+    active_texture(unit);
+    auto cacheable = target == GL_TEXTURE_2D && unit < texture_unit_count;
+    if (cacheable && current().textures_2d[unit] == texture) {
+        return;
+    }
+    glBindTexture(target, texture);
+    if (cacheable) {
+        current().textures_2d[unit] = texture;
+    }
+}
+
+GLuint tinygl::state_cache::texture_2d(GLuint unit)
+{
+    if (unit >= texture_unit_count) {
+        active_texture(unit);
+        return get_integer(GL_TEXTURE_BINDING_2D);
+    }
+    auto& cached = current().textures_2d[unit];
+    if (!cached) {
+        active_texture(unit);
+        cached = get_integer(GL_TEXTURE_BINDING_2D);
+    }
+    return *cached;
+}
+
+void tinygl::state_cache::forget_texture(GLuint texture)
+{
+    // Texture names are shared between contexts and may be handed out again.
+    for (auto& [context, state] : caches) {
+        for (auto& cached : state.textures_2d) {
+            if (cached == texture) {
+                cached = 0;
+            }
+        }
+    }
+}
+
+void tinygl::state_cache::bind_sampler(GLuint unit, GLuint sampler)
+{
+    if (unit >= texture_unit_count) {
+        glBindSampler(unit, sampler);
+        return;
+    }
+    auto& cached = current().samplers[unit];
+    if (cached != sampler) {
+        glBindSampler(unit, sampler);
+        cached = sampler;
+    }
+}
+
+GLuint tinygl::state_cache::sampler(GLuint unit)
+{
+    if (unit >= texture_unit_count) {
+        active_texture(unit);
+        return get_integer(GL_SAMPLER_BINDING);
+    }
+    auto& cached = current().samplers[unit];
+    if (!cached) {
+        active_texture(unit);
+        cached = get_integer(GL_SAMPLER_BINDING);
+    }
+    return *cached;
+}
+
+void tinygl::state_cache::forget_sampler(GLuint sampler)
+{
+    // Sampler objects are shared between contexts like textures.
+    for (auto& [context, state] : caches) {
+        for (auto& cached : state.samplers) {
+            if (cached == sampler) {
+                cached = 0;
+            }
+        }
+    }
+}
+
+void tinygl::state_cache::set_blend(const blend_state& blend)
+{
+    if (current().blend == blend) {
+        return;
+    }
+    glBlendEquationSeparate(blend.rgb_equation, blend.alpha_equation);
+    glBlendFuncSeparate(blend.src_rgb, blend.dst_rgb, blend.src_alpha, blend.dst_alpha);
+    current().blend = blend;
+}
+
+tinygl::state_cache::blend_state tinygl::state_cache::blend()
+{
+    if (!current().blend) {
+        current().blend = blend_state{
+            get_integer(GL_BLEND_EQUATION_RGB),
+            get_integer(GL_BLEND_EQUATION_ALPHA),
+            get_integer(GL_BLEND_SRC_RGB),
+            get_integer(GL_BLEND_DST_RGB),
+            get_integer(GL_BLEND_SRC_ALPHA),
+            get_integer(GL_BLEND_DST_ALPHA)
+        };
+    }
+    return *current().blend;
+}
+
+void tinygl::state_cache::invalidate()
+{
+    current() = {};
+}
+
+void tinygl::state_cache::make_current(const void* context)
+{
+    current_cache = &caches[context];
+}
+
+void tinygl::state_cache::forget_context(const void* context)
+{
+    auto it = caches.find(context);
+    if (it == caches.end()) {
+        return;
+    }
+    if (current_cache == &it->second) {
+        current_cache = nullptr;
+    }
+    caches.erase(it);
+}
@@ -0,0 +1,62 @@
+#ifndef TINYGL_STATE_CACHE_H
+#define TINYGL_STATE_CACHE_H
+
+#include "tinygl/tinygl.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+/**
+ * Shadow copy of the GL state tinygl sets, for the context current on the calling thread. Setters skip the GL call
+ * when the state is already known to match; getters answer from the cache and only query GL the first time (or after
+ * invalidate()). Deleted objects have to be forgotten, GL unbinds them and may hand out their names again.
+ */
+namespace tinygl::state_cache {
+    struct blend_state
+    {
+        GLenum rgb_equation;
+        GLenum alpha_equation;
+        GLenum src_rgb;
+        GLenum dst_rgb;
+        GLenum src_alpha;
+        GLenum dst_alpha;
+
+        bool operator==(const blend_state&) const = default;
+    };
+
+    void set_enabled(capability capability, bool enabled);
+    bool enabled(capability capability);
+
+    void use_program(GLuint program);
+    GLuint program();
+
+    void bind_vertex_array(GLuint vertex_array);
+    GLuint vertex_array();
+    void forget_vertex_array(GLuint vertex_array);
+
+    // Texture and sampler bindings are cached for the units below this; higher ones are queried from GL.
+    constexpr GLuint cached_texture_units = 32;
+
+    void active_texture(GLuint unit);
+    GLuint active_texture();
+    // Leaves `unit` active. Only GL_TEXTURE_2D bindings are cached; other targets still go through the cached
+    // active unit.
+    void bind_texture(GLuint unit, GLenum target, GLuint texture);
+    GLuint texture_2d(GLuint unit);
+    void forget_texture(GLuint texture);
+
+    // Sampler bindings are per unit and do not involve the active unit.
+    void bind_sampler(GLuint unit, GLuint sampler);
+    GLuint sampler(GLuint unit);
+    void forget_sampler(GLuint sampler);
+
+    void set_blend(const blend_state& state);
+    blend_state blend();
+
+    void invalidate();
+
+    // Selects the cache of `context`; has to be called whenever the calling thread makes another context current.
+    void make_current(const void* context);
+    void forget_context(const void* context);
+}
+
+#endif // TINYGL_STATE_CACHE_H
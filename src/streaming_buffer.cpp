@@ -0,0 +1,200 @@
+#include "tinygl/streaming_buffer.h"
+#include "buffer_utils.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <bit>
+#include <stdexcept>
+#include <vector>
+
+struct tinygl::streaming_buffer::streaming_buffer_private
+{
+    streaming_buffer_private(buffer::binding_target target, std::size_t frame_capacity, std::size_t frames_in_flight);
+    ~streaming_buffer_private();
+
+    void allocate_storage();
+    void release_storage();
+
+    GLenum target;
+    GLuint id = 0;
+    std::size_t frame_capacity;
+    std::vector<GLsync> fences;
+    std::size_t region = 0;
+    std::size_t used = 0;
+    std::size_t flushed = 0;
+    bool in_frame = false;
+
+    bool persistent = false;
+    std::uint8_t* mapping = nullptr;
+    // Without persistent mapping a frame is assembled here and uploaded by end_frame().
+    std::vector<std::uint8_t> staging;
+};
+
+tinygl::streaming_buffer::streaming_buffer_private::streaming_buffer_private(
+        buffer::binding_target binding_target, std::size_t frame_capacity, std::size_t frames_in_flight) :
+    target{utils::gl_enum(binding_target)},
+    frame_capacity{std::max<std::size_t>(frame_capacity, 256)},
+    fences(std::max<std::size_t>(frames_in_flight, 1), nullptr),
+    persistent{GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage}
+{
+    allocate_storage();
+}
+
+tinygl::streaming_buffer::streaming_buffer_private::~streaming_buffer_private()
+{
+    release_storage();
+}
+
+void tinygl::streaming_buffer::streaming_buffer_private::allocate_storage()
+{
+    auto size = static_cast<GLsizeiptr>(frame_capacity * fences.size());
+    glGenBuffers(1, &id);
+    glBindBuffer(target, id);
+    if (persistent) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, size, nullptr, flags);
+        mapping = static_cast<std::uint8_t*>(glMapBufferRange(target, 0, size, flags));
+        if (!mapping) {
+            spdlog::warn("[tinygl::streaming_buffer] persistent mapping failed, falling back to glBufferSubData");
+            glDeleteBuffers(1, &id);
+            persistent = false;
+            allocate_storage();
+            return;
+        }
+    } else {
+        glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+        staging.resize(frame_capacity);
+    }
+    region = 0;
+}
+
+void tinygl::streaming_buffer::streaming_buffer_private::release_storage()
+{
+    for (auto& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (id) {
+        if (mapping) {
+            glBindBuffer(target, id);
+            glUnmapBuffer(target);
+            mapping = nullptr;
+        }
+        // The driver keeps the storage alive until the GPU no longer uses it.
+        glDeleteBuffers(1, &id);
+        id = 0;
+    }
+}
+
+tinygl::streaming_buffer::streaming_buffer(
+        buffer::binding_target binding_target, std::size_t frame_capacity, std::size_t frames_in_flight,
+        std::source_location call_site) :
+    p{std::make_unique<streaming_buffer_private>(binding_target, frame_capacity, frames_in_flight)}
+{
+    validation::check(call_site);
+}
+
+tinygl::streaming_buffer::~streaming_buffer() = default;
+
+tinygl::streaming_buffer::streaming_buffer(streaming_buffer&& other) noexcept = default;
+
+tinygl::streaming_buffer& tinygl::streaming_buffer::operator=(streaming_buffer&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::streaming_buffer::bind(std::source_location call_site)
+{
+    glBindBuffer(p->target, p->id);
+    validation::check(call_site);
+}
+
+void tinygl::streaming_buffer::bind(buffer::binding_target binding_target, std::source_location call_site)
+{
+    glBindBuffer(utils::gl_enum(binding_target), p->id);
+    validation::check(call_site);
+}
+
+void tinygl::streaming_buffer::begin_frame(std::size_t required_size, std::source_location call_site)
+{
+    if (p->in_frame) {
+        throw std::logic_error("tinygl::streaming_buffer::begin_frame(): end_frame() was not called!");
+    }
+    if (required_size > p->frame_capacity) {
+        p->release_storage();
+        p->frame_capacity = std::bit_ceil(required_size);
+        p->allocate_storage();
+    }
+
+    auto& fence = p->fences[p->region];
+    if (fence) {
+        // Normally signalled long ago; only a GPU more than `frames_in_flight` frames behind makes this wait.
+        auto status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    p->used = 0;
+    p->flushed = 0;
+    p->in_frame = true;
+    validation::check(call_site);
+}
+
+tinygl::streaming_buffer::allocation tinygl::streaming_buffer::allocate(std::size_t size, std::size_t alignment)
+{
+    if (!p->in_frame) {
+        throw std::logic_error("tinygl::streaming_buffer::allocate(): begin_frame() was not called!");
+    }
+    auto start = (p->used + alignment - 1) / alignment * alignment;
+    if (start + size > p->frame_capacity) {
+        throw std::runtime_error(fmt::format(
+            "tinygl::streaming_buffer::allocate(): {} bytes do not fit into the {} byte region!", size,
+            p->frame_capacity));
+    }
+    p->used = start + size;
+    auto offset = p->region * p->frame_capacity + start;
+    auto* data = p->persistent ? p->mapping + offset : p->staging.data() + start;
+    return {data, offset};
+}
+
+void tinygl::streaming_buffer::flush(std::source_location call_site)
+{
+    // Coherent persistent mappings need nothing, the writes are visible to commands issued after them.
+    if (p->persistent || p->flushed == p->used) {
+        return;
+    }
+    glBindBuffer(p->target, p->id);
+    glBufferSubData(p->target, static_cast<GLintptr>(p->region * p->frame_capacity + p->flushed),
+                    static_cast<GLsizeiptr>(p->used - p->flushed), p->staging.data() + p->flushed);
+    p->flushed = p->used;
+    validation::check(call_site);
+}
+
+void tinygl::streaming_buffer::end_frame(std::source_location call_site)
+{
+    if (!p->in_frame) {
+        return;
+    }
+    p->fences[p->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    p->region = (p->region + 1) % p->fences.size();
+    p->in_frame = false;
+    validation::check(call_site);
+}
+
+std::size_t tinygl::streaming_buffer::frame_capacity() const
+{
+    return p->frame_capacity;
+}
+
+bool tinygl::streaming_buffer::persistent() const
+{
+    return p->persistent;
+}
@@ -1,196 +1,39 @@
 #include "tinygl/exceptions.h"
 #include "tinygl/texture.h"
+#include "tinygl/buffer.h"
+#include "tinygl/compressed_image.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
+#include "mapped_file.h"
+#include "state_cache.h"
+#include "texture_utils.h"
+#include "utils.h"
+#include "validation.h"
 #include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
 #include <map>
 #include <stdexcept>
-
-namespace {
-    constexpr GLenum gl_enum(tinygl::texture::target target)
-    {
-        switch(target) {
-            case tinygl::texture::target::gl_texture_1d: return GL_TEXTURE_1D;
-            case tinygl::texture::target::gl_texture_2d: return GL_TEXTURE_2D;
-            case tinygl::texture::target::gl_texture_3d: return GL_TEXTURE_3D;
-            case tinygl::texture::target::gl_texture_1d_array: return GL_TEXTURE_1D_ARRAY;
-            case tinygl::texture::target::gl_texture_2d_array: return GL_TEXTURE_2D_ARRAY;
-            case tinygl::texture::target::gl_texture_rectangle: return GL_TEXTURE_RECTANGLE;
-            case tinygl::texture::target::gl_texture_cube_map: return GL_TEXTURE_CUBE_MAP;
-            case tinygl::texture::target::gl_texture_cube_map_array: return GL_TEXTURE_CUBE_MAP_ARRAY;
-            case tinygl::texture::target::gl_texture_buffer: return GL_TEXTURE_BUFFER;
-            case tinygl::texture::target::gl_texture_2d_multisample: return GL_TEXTURE_2D_MULTISAMPLE;
-            case tinygl::texture::target::gl_texture_2d_multisample_array: return GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
-        }
-    }
-
-    constexpr GLenum gl_get_gl_enum(tinygl::texture::target target)
-    {
-        switch(target) {
-            case tinygl::texture::target::gl_texture_1d: return GL_TEXTURE_BINDING_1D;
-            case tinygl::texture::target::gl_texture_2d: return GL_TEXTURE_BINDING_2D;
-            case tinygl::texture::target::gl_texture_3d: return GL_TEXTURE_BINDING_3D;
-            case tinygl::texture::target::gl_texture_1d_array: return GL_TEXTURE_BINDING_1D_ARRAY;
-            case tinygl::texture::target::gl_texture_2d_array: return GL_TEXTURE_BINDING_2D_ARRAY;
-            case tinygl::texture::target::gl_texture_rectangle: return GL_TEXTURE_BINDING_RECTANGLE;
-            case tinygl::texture::target::gl_texture_cube_map: return GL_TEXTURE_BINDING_CUBE_MAP;
-            case tinygl::texture::target::gl_texture_cube_map_array: return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
-            case tinygl::texture::target::gl_texture_buffer: return GL_TEXTURE_BINDING_BUFFER;
-            case tinygl::texture::target::gl_texture_2d_multisample: return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
-            case tinygl::texture::target::gl_texture_2d_multisample_array: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
-        }
-    }
-
-    constexpr GLenum gl_enum(tinygl::texture::coordinate coordinate_direction)
-    {
-        switch(coordinate_direction) {
-        case tinygl::texture::coordinate::s: return GL_TEXTURE_WRAP_S;
-        case tinygl::texture::coordinate::t: return GL_TEXTURE_WRAP_T;
-        case tinygl::texture::coordinate::r: return GL_TEXTURE_WRAP_R;
-        }
-    }
-
-    constexpr GLint gl_int(tinygl::texture::wrap_mode wrap_mode)
-    {
-        switch(wrap_mode) {
-        case tinygl::texture::wrap_mode::gl_clamp_to_edge: return GL_CLAMP_TO_EDGE;
-        case tinygl::texture::wrap_mode::gl_clamp_to_border: return GL_CLAMP_TO_BORDER;
-        case tinygl::texture::wrap_mode::gl_mirrored_repeat: return GL_MIRRORED_REPEAT;
-        case tinygl::texture::wrap_mode::gl_repeat: return GL_REPEAT;
-        case tinygl::texture::wrap_mode::gl_mirror_clamp_to_edge: return GL_MIRROR_CLAMP_TO_EDGE;
-        }
-    }
-
-    constexpr GLint gl_int(tinygl::texture::filter filter)
-    {
-        switch(filter) {
-        case tinygl::texture::filter::nearest: return GL_NEAREST;
-        case tinygl::texture::filter::linear: return GL_LINEAR;
-        case tinygl::texture::filter::nearest_mip_map_nearest: return GL_NEAREST_MIPMAP_NEAREST;
-        case tinygl::texture::filter::nearest_mip_map_linear: return GL_NEAREST_MIPMAP_LINEAR;
-        case tinygl::texture::filter::linear_mip_map_nearest: return GL_LINEAR_MIPMAP_NEAREST;
-        case tinygl::texture::filter::linear_mip_map_linear: return GL_LINEAR_MIPMAP_LINEAR;
-        }
-    }
-
-    constexpr GLint gl_int(tinygl::texture::internal_format internal_format) {
-        switch(internal_format) {
-        case tinygl::texture::internal_format::gl_depth_component: return GL_DEPTH_COMPONENT;
-        case tinygl::texture::internal_format::gl_depth_stencil: return GL_DEPTH_STENCIL;
-        case tinygl::texture::internal_format::gl_red: return GL_RED;
-        case tinygl::texture::internal_format::gl_rg: return GL_RG;
-        case tinygl::texture::internal_format::gl_rgb: return GL_RGB;
-        case tinygl::texture::internal_format::gl_rgba: return GL_RGBA;
-        case tinygl::texture::internal_format::gl_r8: return GL_R8;
-        case tinygl::texture::internal_format::gl_r8_snorm: return GL_R8_SNORM;
-        case tinygl::texture::internal_format::gl_r16: return GL_R16;
-        case tinygl::texture::internal_format::gl_r16_snorm: return GL_R16_SNORM;
-        case tinygl::texture::internal_format::gl_rg8: return GL_RG8;
-        case tinygl::texture::internal_format::gl_rg8_snorm: return GL_RG8_SNORM;
-        case tinygl::texture::internal_format::gl_rg16: return GL_RG16;
-        case tinygl::texture::internal_format::gl_rg16_snorm: return GL_RG16_SNORM;
-        case tinygl::texture::internal_format::gl_r3_g3_b2: return GL_R3_G3_B2;
-        case tinygl::texture::internal_format::gl_rgb4: return GL_RGB4;
-        case tinygl::texture::internal_format::gl_rgb5: return GL_RGB5;
-        case tinygl::texture::internal_format::gl_rgb8: return GL_RGB8;
-        case tinygl::texture::internal_format::gl_rgb8_snorm: return GL_RGB8_SNORM;
-        case tinygl::texture::internal_format::gl_rgb10: return GL_RGB10;
-        case tinygl::texture::internal_format::gl_rgb12: return GL_RGB12;
-        case tinygl::texture::internal_format::gl_rgb16_snorm: return GL_RGB16_SNORM;
-        case tinygl::texture::internal_format::gl_rgba2: return GL_RGBA2;
-        case tinygl::texture::internal_format::gl_rgba4: return GL_RGBA4;
-        case tinygl::texture::internal_format::gl_rgb5_a1: return GL_RGB5_A1;
-        case tinygl::texture::internal_format::gl_rgba8: return GL_RGBA8;
-        case tinygl::texture::internal_format::gl_rgba8_snorm: return GL_RGBA8_SNORM;
-        case tinygl::texture::internal_format::gl_rgb10_a2: return GL_RGB10_A2;
-        case tinygl::texture::internal_format::gl_rgb10_a2ui: return GL_RGB10_A2UI;
-        case tinygl::texture::internal_format::gl_rgba12: return GL_RGBA12;
-        case tinygl::texture::internal_format::gl_rgba16: return GL_RGBA16;
-        case tinygl::texture::internal_format::gl_srgb8: return GL_SRGB8;
-        case tinygl::texture::internal_format::gl_srgb8_alpha8: return GL_SRGB8_ALPHA8;
-        case tinygl::texture::internal_format::gl_r16f: return GL_R16F;
-        case tinygl::texture::internal_format::gl_rg16f: return GL_RG16F;
-        case tinygl::texture::internal_format::gl_rgb16f: return GL_RGB16F;
-        case tinygl::texture::internal_format::gl_rgba16f: return GL_RGBA16F;
-        case tinygl::texture::internal_format::gl_r32f: return GL_R32F;
-        case tinygl::texture::internal_format::gl_rg32f: return GL_RG32F;
-        case tinygl::texture::internal_format::gl_rgb32f: return GL_RGB32F;
-        case tinygl::texture::internal_format::gl_rgba32f: return GL_RGBA32F;
-        case tinygl::texture::internal_format::gl_r11f_g11f_b10f: return GL_R11F_G11F_B10F;
-        case tinygl::texture::internal_format::gl_rgb9_e5: return GL_RGB9_E5;
-        case tinygl::texture::internal_format::gl_r8i: return GL_R8I;
-        case tinygl::texture::internal_format::gl_r8ui: return GL_R8UI;
-        case tinygl::texture::internal_format::gl_r16i: return GL_R16I;
-        case tinygl::texture::internal_format::gl_r16ui: return GL_R16UI;
-        case tinygl::texture::internal_format::gl_r32i: return GL_R32I;
-        case tinygl::texture::internal_format::gl_r32ui: return GL_R32UI;
-        case tinygl::texture::internal_format::gl_rg8i: return GL_RG8I;
-        case tinygl::texture::internal_format::gl_rg8ui: return GL_RG8UI;
-        case tinygl::texture::internal_format::gl_rg16i: return GL_RG16I;
-        case tinygl::texture::internal_format::gl_rg16ui: return GL_RG16UI;
-        case tinygl::texture::internal_format::gl_rg32i: return GL_RG32I;
-        case tinygl::texture::internal_format::gl_rg32ui: return GL_RG32UI;
-        case tinygl::texture::internal_format::gl_rgb8i: return GL_RGB8I;
-        case tinygl::texture::internal_format::gl_rgb8ui: return GL_RGB8UI;
-        case tinygl::texture::internal_format::gl_rgb16i: return GL_RGB16I;
-        case tinygl::texture::internal_format::gl_rgb16ui: return GL_RGB16UI;
-        case tinygl::texture::internal_format::gl_rgb32i: return GL_RGB32I;
-        case tinygl::texture::internal_format::gl_rgb32ui: return GL_RGB32UI;
-        case tinygl::texture::internal_format::gl_rgba8i: return GL_RGBA8I;
-        case tinygl::texture::internal_format::gl_rgba8ui: return GL_RGBA8UI;
-        case tinygl::texture::internal_format::gl_rgba16i: return GL_RGBA16I;
-        case tinygl::texture::internal_format::gl_rgba16ui: return GL_RGBA16UI;
-        case tinygl::texture::internal_format::gl_rgba32i: return GL_RGBA32I;
-        case tinygl::texture::internal_format::gl_rgba32ui: return GL_RGBA32UI;
-        case tinygl::texture::internal_format::gl_compressed_red: return GL_COMPRESSED_RED;
-        case tinygl::texture::internal_format::gl_compressed_rg: return GL_COMPRESSED_RG;
-        case tinygl::texture::internal_format::gl_compressed_rgb: return GL_COMPRESSED_RGB;
-        case tinygl::texture::internal_format::gl_compressed_rgba: return GL_COMPRESSED_RGBA;
-        case tinygl::texture::internal_format::gl_compressed_srgb: return GL_COMPRESSED_SRGB;
-        case tinygl::texture::internal_format::gl_compressed_srgb_alpha: return GL_COMPRESSED_SRGB_ALPHA;
-        case tinygl::texture::internal_format::gl_compressed_red_rgtc1: return GL_COMPRESSED_RED_RGTC1;
-        case tinygl::texture::internal_format::gl_compressed_signed_red_rgtc1: return GL_COMPRESSED_SIGNED_RED_RGTC1;
-        case tinygl::texture::internal_format::gl_compressed_rg_rgtc2: return GL_COMPRESSED_RG_RGTC2;
-        case tinygl::texture::internal_format::gl_compressed_signed_rg_rgtc2: return GL_COMPRESSED_SIGNED_RG_RGTC2;
-        case tinygl::texture::internal_format::gl_compressed_rgba_bptc_unorm: return GL_COMPRESSED_RGBA_BPTC_UNORM;
-        case tinygl::texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
-        case tinygl::texture::internal_format::gl_compressed_rgb_bptc_signed_float: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
-        case tinygl::texture::internal_format::gl_compressed_rgb_bptc_unsigned_float: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
-        }
-    }
-
-    constexpr GLenum gl_enum(tinygl::texture::format format)
-    {
-        switch(format) {
-        case tinygl::texture::format::gl_red: return GL_RED;
-        case tinygl::texture::format::gl_rg: return GL_RG;
-        case tinygl::texture::format::gl_rgb: return GL_RGB;
-        case tinygl::texture::format::gl_bgr: return GL_BGR;
-        case tinygl::texture::format::gl_rgba: return GL_RGBA;
-        case tinygl::texture::format::gl_bgra: return GL_BGRA;
-        case tinygl::texture::format::gl_red_integer: return GL_RED_INTEGER;
-        case tinygl::texture::format::gl_rg_integer: return GL_RG_INTEGER;
-        case tinygl::texture::format::gl_rgb_integer: return GL_RGB_INTEGER;
-        case tinygl::texture::format::gl_bgr_integer: return GL_BGR_INTEGER;
-        case tinygl::texture::format::gl_rgba_integer: return GL_RGBA_INTEGER;
-        case tinygl::texture::format::gl_bgra_integer: return GL_BGRA_INTEGER;
-        case tinygl::texture::format::gl_stencil_index: return GL_STENCIL_INDEX;
-        case tinygl::texture::format::gl_depth_component: return GL_DEPTH_COMPONENT;
-        case tinygl::texture::format::gl_depth_stencil: return GL_DEPTH_STENCIL;
-        }
-    }
-}
+#include <vector>
 
 struct tinygl::texture::texture_private
 {
     explicit texture_private(target target, GLuint unit);
-    ~texture_private() = default;
+    ~texture_private();
 
     bool bound();
 
     target texture_target;
+    texture::internal_format internal_format = texture::internal_format::gl_rgba8;
     GLuint id = 0;
     GLuint unit = 0;
+    std::uint64_t serial = 0;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    GLsizei depth = 1;
+    GLsizei levels = 1;
 
     // Initially, GL_TEXTURE_WRAP_S/T/R are set to GL_REPEAT.
     std::map<texture::coordinate, texture::wrap_mode> wrap_modes = {
@@ -206,13 +49,21 @@ struct tinygl::texture::texture_private
 tinygl::texture::texture_private::texture_private(target target, GLuint unit) :
         texture_target{target}, unit{unit}
 {
+    static std::atomic<std::uint64_t> next_serial{1};
+    serial = next_serial.fetch_add(1, std::memory_order_relaxed);
     glGenTextures(1, &id);
 }
 
+tinygl::texture::texture_private::~texture_private()
+{
+    state_cache::forget_texture(id);
+    glDeleteTextures(1, &id);
+}
+
 bool tinygl::texture::texture_private::bound()
 {
     GLint bound_id;
-    glGetIntegerv(gl_get_gl_enum(texture_target), &bound_id);
+    glGetIntegerv(utils::gl_get_gl_enum(texture_target), &bound_id);
     return id == static_cast<GLuint>(bound_id);
 }
 
@@ -220,29 +71,263 @@ tinygl::texture::texture(target target,
      const std::filesystem::path& file_name,
      internal_format internal_format,
      format format,
-     std::uint32_t unit)
-    : p{std::make_unique<texture_private>(target, unit)}
+     std::uint32_t unit,
+     std::source_location call_site)
 {
+    // Cube map faces are addressed top row first, all other targets bottom row first.
+    auto flipped = target != target::gl_texture_cube_map;
     int width, height, channels;
-    stbi_set_flip_vertically_on_load(true);
-    auto* data = stbi_load(file_name.string().c_str(), &width, &height, &channels, 0);
+    std::string error;
+    stbi_set_flip_vertically_on_load(flipped);
+    std::unique_ptr<unsigned char, decltype(&stbi_image_free)> data{
+        utils::load_image(file_name, width, height, channels, 0, error), stbi_image_free};
     if (!data) {
-        throw std::runtime_error("Failed to load texture!");
+        throw std::runtime_error("[tinygl::texture] " + error + "!");
     }
 
-    bind();
-
+    // Layers and faces are stacked from top to bottom in the file, each as high as the image is wide.
+    auto layers = 1;
     switch (target) {
         case target::gl_texture_2d:
-            glTexImage2D(GL_TEXTURE_2D, 0, gl_int(internal_format), width, height, 0, gl_enum(format), GL_UNSIGNED_BYTE, data);
+        case target::gl_texture_rectangle:
+            break;
+        case target::gl_texture_2d_array:
+            if (height % width != 0) {
+                throw std::invalid_argument("[tinygl::texture] 2D array layers have to be stacked square images!");
+            }
+            layers = height / width;
+            break;
+        case target::gl_texture_cube_map:
+            if (height != 6 * width) {
+                throw std::invalid_argument("[tinygl::texture] cube map faces have to be six stacked square images!");
+            }
+            layers = 6;
             break;
         default:
-            stbi_image_free(data);
-            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+            throw std::invalid_argument("[tinygl::texture] texture target cannot be loaded from a file!");
+    }
+    auto layer_height = height / layers;
+    auto depth = target == target::gl_texture_2d_array ? layers : 1;
+    auto levels = target == target::gl_texture_rectangle ? 1 : 0;
+    p = std::move(texture{storage{target, internal_format, width, layer_height, depth, levels}, unit, call_site}.p);
+
+    bind(call_site);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    auto layer_size = static_cast<std::size_t>(width) * layer_height * channels;
+    for (auto layer = 0; layer < layers; ++layer) {
+        // Flipping also reversed the order of the layers.
+        auto* pixels = data.get() + static_cast<std::size_t>(flipped ? layers - 1 - layer : layer) * layer_size;
+        if (layers == 1) {
+            update(0, 0, 0, width, layer_height, format, data_type::gl_unsigned_byte, pixels, call_site);
+        } else {
+            update(0, 0, 0, layer, width, layer_height, 1, format, data_type::gl_unsigned_byte, pixels, call_site);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    unbind(call_site);
+    validation::check(call_site);
+}
+
+tinygl::texture::texture(target target,
+     internal_format internal_format,
+     std::int32_t width,
+     std::int32_t height,
+     std::uint32_t unit,
+     std::int32_t samples,
+     std::int32_t levels,
+     std::source_location call_site)
+    : texture{storage{target, internal_format, width, height, 1, levels, samples}, unit, call_site}
+{
+}
+
+tinygl::texture::texture(const storage& storage, std::uint32_t unit, std::source_location call_site)
+    : p{std::make_unique<texture_private>(storage.target, unit)}
+{
+    if (utils::generic_compressed(storage.internal_format)) {
+        throw std::invalid_argument(
+            "[tinygl::texture] generic compressed formats cannot be allocated as immutable storage!");
+    }
+    // glTexStorage*() and glTexBufferRange() only take sized formats.
+    auto sized_format = utils::sized(storage.internal_format);
+    auto internal_format = utils::gl_int(sized_format);
+    auto gl_target = utils::gl_enum(storage.target);
+    auto full_levels = [](std::int32_t size) {
+        return static_cast<GLsizei>(std::bit_width(static_cast<std::uint32_t>(std::max(size, 1))));
+    };
+    auto level_count = [&storage](GLsizei full) {
+        return storage.levels > 0 ? std::min(storage.levels, full) : full;
+    };
+    auto fixed_sample_locations = static_cast<GLboolean>(storage.fixed_sample_locations ? GL_TRUE : GL_FALSE);
+    switch (storage.target) {
+        case target::gl_texture_cube_map:
+            if (storage.width != storage.height) {
+                throw std::invalid_argument("[tinygl::texture] cube map faces have to be square!");
+            }
+            break;
+        case target::gl_texture_cube_map_array:
+            if (storage.width != storage.height || storage.depth % 6 != 0) {
+                throw std::invalid_argument(
+                    "[tinygl::texture] cube map array faces have to be square and come in multiples of 6!");
+            }
+            break;
+        case target::gl_texture_2d_multisample:
+        case target::gl_texture_2d_multisample_array:
+            if (storage.samples < 1) {
+                throw std::invalid_argument("[tinygl::texture] multisample textures need at least one sample!");
+            }
+            break;
+        case target::gl_texture_buffer: {
+            if (!storage.buffer) {
+                throw std::invalid_argument("[tinygl::texture] buffer textures need a buffer to read from!");
+            }
+            GLint alignment = 1;
+            glGetIntegerv(GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            if (alignment > 0 && storage.buffer_offset % static_cast<std::size_t>(alignment) != 0) {
+                throw std::invalid_argument(
+                    "[tinygl::texture] the buffer offset has to be a multiple of GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT!");
+            }
+            auto buffer_size = storage.buffer->size();
+            if (storage.buffer_offset >= buffer_size ||
+                storage.buffer_size > buffer_size - storage.buffer_offset) {
+                throw std::invalid_argument("[tinygl::texture] the buffer range does not fit into the buffer!");
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    p->internal_format = sized_format;
+    p->width = storage.width;
+    p->height = storage.height;
+
+    bind(call_site);
+
+    switch (storage.target) {
+        case target::gl_texture_1d:
+            p->height = 1;
+            p->levels = level_count(full_levels(storage.width));
+            glTexStorage1D(gl_target, p->levels, internal_format, p->width);
+            break;
+        case target::gl_texture_2d:
+        case target::gl_texture_cube_map:
+            p->levels = level_count(full_levels(std::max(storage.width, storage.height)));
+            glTexStorage2D(gl_target, p->levels, internal_format, p->width, p->height);
+            break;
+        case target::gl_texture_1d_array:
+            // The height counts layers, which are not reduced along the mip chain.
+            p->levels = level_count(full_levels(storage.width));
+            glTexStorage2D(gl_target, p->levels, internal_format, p->width, p->height);
+            break;
+        case target::gl_texture_rectangle:
+            glTexStorage2D(gl_target, 1, internal_format, p->width, p->height);
+            break;
+        case target::gl_texture_3d:
+            p->depth = storage.depth;
+            p->levels = level_count(full_levels(std::max({storage.width, storage.height, storage.depth})));
+            glTexStorage3D(gl_target, p->levels, internal_format, p->width, p->height, p->depth);
+            break;
+        case target::gl_texture_2d_array:
+        case target::gl_texture_cube_map_array:
+            p->depth = storage.depth;
+            p->levels = level_count(full_levels(std::max(storage.width, storage.height)));
+            glTexStorage3D(gl_target, p->levels, internal_format, p->width, p->height, p->depth);
+            break;
+        case target::gl_texture_2d_multisample:
+            glTexStorage2DMultisample(
+                gl_target, storage.samples, internal_format, p->width, p->height, fixed_sample_locations);
+            break;
+        case target::gl_texture_2d_multisample_array:
+            p->depth = storage.depth;
+            glTexStorage3DMultisample(
+                gl_target, storage.samples, internal_format, p->width, p->height, p->depth, fixed_sample_locations);
+            break;
+        case target::gl_texture_buffer: {
+            auto size = storage.buffer_size > 0 ? storage.buffer_size : storage.buffer->size() - storage.buffer_offset;
+            glTexBufferRange(gl_target, static_cast<GLenum>(internal_format), storage.buffer->id(),
+                             static_cast<GLintptr>(storage.buffer_offset), static_cast<GLsizeiptr>(size));
+            p->width = static_cast<GLsizei>(size / utils::image_size(sized_format, 1, 1));
+            p->height = 1;
+            break;
+        }
     }
 
-    unbind();
-    stbi_image_free(data);
+    // The default minification filter samples mipmaps, which a single-level texture does not have. Rectangle
+    // textures default to GL_LINEAR, multisample and buffer textures are not filtered.
+    auto filtered = storage.target != target::gl_texture_rectangle && storage.target != target::gl_texture_buffer &&
+                    storage.target != target::gl_texture_2d_multisample &&
+                    storage.target != target::gl_texture_2d_multisample_array;
+    if (filtered && p->levels == 1) {
+        glTexParameteri(gl_target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        p->min_filter = filter::linear;
+    }
+
+    unbind(call_site);
+    validation::check(call_site);
+}
+
+tinygl::texture::texture(const compressed_image& image, std::uint32_t unit, std::source_location call_site)
+    : p{std::make_unique<texture_private>(target::gl_texture_2d, unit)}
+{
+    auto internal_format = utils::gl_int(image.internal_format());
+    auto s3tc = internal_format >= GL_COMPRESSED_RGB_S3TC_DXT1_EXT && internal_format <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    auto s3tc_srgb =
+        internal_format >= GL_COMPRESSED_SRGB_S3TC_DXT1_EXT && internal_format <= GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    if ((s3tc || s3tc_srgb) && !GLEW_EXT_texture_compression_s3tc) {
+        throw std::runtime_error("[tinygl::texture] S3TC compressed textures are not supported!");
+    }
+    if (s3tc_srgb && !GLEW_EXT_texture_sRGB) {
+        throw std::runtime_error("[tinygl::texture] sRGB S3TC compressed textures are not supported!");
+    }
+
+    p->internal_format = image.internal_format();
+    p->width = image.width();
+    p->height = image.height();
+    p->levels = image.level_count();
+
+    bind(call_site);
+    glTexStorage2D(GL_TEXTURE_2D, image.level_count(), internal_format, image.width(), image.height());
+
+    // The blocks are copied once, from the file mapping into a pixel-unpack buffer the driver uploads from
+    // asynchronously. Should mapping the buffer fail, they are passed from the file mapping directly.
+    std::vector<std::size_t> offsets;
+    std::size_t size = 0;
+    for (std::int32_t level = 0; level < image.level_count(); ++level) {
+        offsets.push_back(size);
+        size += (image.level_data(level).size() + 15) / 16 * 16;
+    }
+    buffer staging{buffer::binding_target::gl_pixel_unpack_buffer, buffer::usage_pattern::gl_stream_draw};
+    staging.bind(call_site);
+    staging.create(size, nullptr, call_site);
+    auto* mapped = static_cast<std::uint8_t*>(staging.map_range(
+        0, size, buffer::map_access::gl_map_write_bit | buffer::map_access::gl_map_invalidate_buffer_bit, call_site));
+    if (mapped) {
+        for (std::int32_t level = 0; level < image.level_count(); ++level) {
+            auto data = image.level_data(level);
+            std::memcpy(mapped + offsets[static_cast<std::size_t>(level)], data.data(), data.size());
+        }
+        if (!staging.unmap(call_site)) {
+            mapped = nullptr;
+        }
+    }
+    if (!mapped) {
+        staging.unbind(call_site);
+    }
+    for (std::int32_t level = 0; level < image.level_count(); ++level) {
+        auto data = image.level_data(level);
+        const void* pixels = mapped ? reinterpret_cast<const void*>(offsets[static_cast<std::size_t>(level)])
+                                    : data.data();
+        glCompressedTexSubImage2D(
+            GL_TEXTURE_2D, level, 0, 0, image.level_width(level), image.level_height(level),
+            static_cast<GLenum>(internal_format), static_cast<GLsizei>(data.size()), pixels);
+    }
+    staging.unbind(call_site);
+    if (image.level_count() == 1) {
+        // The default minification filter samples mipmaps, which a single-level texture does not have.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        p->min_filter = filter::linear;
+    }
+    unbind(call_site);
+    validation::check(call_site);
 }
 
 tinygl::texture::~texture() = default;
@@ -257,24 +342,60 @@ tinygl::texture& tinygl::texture::operator=(tinygl::texture&& other) noexcept
     return *this;
 }
 
-void tinygl::texture::bind()
+void tinygl::texture::bind(std::source_location call_site)
+{
+    state_cache::bind_texture(p->unit, utils::gl_enum(p->texture_target), p->id);
+    validation::check(call_site);
+}
+
+void tinygl::texture::unbind(std::source_location call_site)
 {
-    glActiveTexture(GL_TEXTURE0 + p->unit);
-    glBindTexture(gl_enum(p->texture_target), p->id);
+    state_cache::bind_texture(p->unit, utils::gl_enum(p->texture_target), 0);
+    validation::check(call_site);
 }
 
-void tinygl::texture::unbind()
+void tinygl::texture::generate_mipmaps(std::source_location call_site)
 {
-    glActiveTexture(GL_TEXTURE0 + p->unit);
-    glBindTexture(gl_enum(p->texture_target), 0);
+    glGenerateMipmap(utils::gl_enum(p->texture_target));
+    validation::check(call_site);
 }
 
-void tinygl::texture::generate_mipmaps()
+void tinygl::texture::update(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t width,
+                             std::int32_t height, format format, data_type type, const void* pixels,
+                             std::source_location call_site)
 {
-    glGenerateMipmap(gl_enum(p->texture_target));
+    assert(p->bound());
+
+    switch (p->texture_target) {
+        case target::gl_texture_2d:
+        case target::gl_texture_rectangle:
+        case target::gl_texture_1d_array:
+            glTexSubImage2D(utils::gl_enum(p->texture_target), level, x, y, width, height, utils::gl_enum(format),
+                            utils::gl_enum(type), pixels);
+            break;
+        default:
+            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+    }
+    validation::check(call_site);
+}
+
+void tinygl::texture::update(std::int32_t level, std::int32_t x, std::int32_t width, format format, data_type type,
+                             const void* pixels,
+                             std::source_location call_site)
+{
+    assert(p->bound());
+
+    switch (p->texture_target) {
+        case target::gl_texture_1d:
+            glTexSubImage1D(GL_TEXTURE_1D, level, x, width, utils::gl_enum(format), utils::gl_enum(type), pixels);
+            break;
+        default:
+            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+    }
+    validation::check(call_site);
 }
 
-void tinygl::texture::set_wrap_mode(tinygl::texture::wrap_mode mode)
+void tinygl::texture::set_wrap_mode(tinygl::texture::wrap_mode mode, std::source_location call_site)
 {
     assert(p->bound());
 
@@ -283,7 +404,7 @@ void tinygl::texture::set_wrap_mode(tinygl::texture::wrap_mode mode)
         case target::gl_texture_1d_array:
         case target::gl_texture_buffer:
             p->wrap_modes.at(coordinate::s) = mode;
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, utils::gl_int(mode));
             break;
         case target::gl_texture_2d:
         case target::gl_texture_2d_array:
@@ -293,23 +414,25 @@ void tinygl::texture::set_wrap_mode(tinygl::texture::wrap_mode mode)
         case target::gl_texture_2d_multisample_array:
         case target::gl_texture_rectangle:
             p->wrap_modes.at(coordinate::s) = p->wrap_modes.at(coordinate::t) = mode;
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, gl_int(mode));
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_T, gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, utils::gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_T, utils::gl_int(mode));
             break;
         case target::gl_texture_3d:
             p->wrap_modes.at(coordinate::s) =
                 p->wrap_modes.at(coordinate::t) =
                     p->wrap_modes.at(coordinate::r) = mode;
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, gl_int(mode));
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_T, gl_int(mode));
-            glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_WRAP_R, gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_S, utils::gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_T, utils::gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_WRAP_R, utils::gl_int(mode));
             break;
     }
+    validation::check(call_site);
 }
 
 void tinygl::texture::set_wrap_mode(
         tinygl::texture::coordinate direction,
-        tinygl::texture::wrap_mode mode)
+        tinygl::texture::wrap_mode mode,
+        std::source_location call_site)
 {
     assert(p->bound());
 
@@ -319,7 +442,7 @@ void tinygl::texture::set_wrap_mode(
         case target::gl_texture_buffer:
             assert(direction == coordinate::s);
             p->wrap_modes.at(direction) = mode;
-            glTexParameteri(gl_enum(p->texture_target), gl_enum(direction), gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), utils::gl_enum(direction), utils::gl_int(mode));
             break;
         case texture::target::gl_texture_2d:
         case texture::target::gl_texture_2d_array:
@@ -330,13 +453,14 @@ void tinygl::texture::set_wrap_mode(
         case texture::target::gl_texture_rectangle:
             assert(direction == coordinate::s || direction == coordinate::t);
             p->wrap_modes.at(direction) = mode;
-            glTexParameteri(gl_enum(p->texture_target), gl_enum(direction), gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), utils::gl_enum(direction), utils::gl_int(mode));
             break;
         case target::gl_texture_3d:
             p->wrap_modes.at(direction) = mode;
-            glTexParameteri(gl_enum(p->texture_target), gl_enum(direction), gl_int(mode));
+            glTexParameteri(utils::gl_enum(p->texture_target), utils::gl_enum(direction), utils::gl_int(mode));
             break;
     }
+    validation::check(call_site);
 }
 
 tinygl::texture::wrap_mode tinygl::texture::get_wrap_mode(tinygl::texture::coordinate direction) const
@@ -344,11 +468,12 @@ tinygl::texture::wrap_mode tinygl::texture::get_wrap_mode(tinygl::texture::coord
     return p->wrap_modes.at(direction);
 }
 
-void tinygl::texture::set_minification_filter(tinygl::texture::filter filter)
+void tinygl::texture::set_minification_filter(tinygl::texture::filter filter, std::source_location call_site)
 {
     assert(p->bound());
-    glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_MIN_FILTER, gl_int(filter));
+    glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_MIN_FILTER, utils::gl_int(filter));
     p->min_filter = filter;
+    validation::check(call_site);
 }
 
 tinygl::texture::filter tinygl::texture::minification_filter() const
@@ -356,11 +481,12 @@ tinygl::texture::filter tinygl::texture::minification_filter() const
     return p->min_filter;
 }
 
-void tinygl::texture::set_magnification_filter(tinygl::texture::filter filter)
+void tinygl::texture::set_magnification_filter(tinygl::texture::filter filter, std::source_location call_site)
 {
     assert(p->bound());
-    glTexParameteri(gl_enum(p->texture_target), GL_TEXTURE_MAG_FILTER, gl_int(filter));
+    glTexParameteri(utils::gl_enum(p->texture_target), GL_TEXTURE_MAG_FILTER, utils::gl_int(filter));
     p->mag_filter = filter;
+    validation::check(call_site);
 }
 
 tinygl::texture::filter tinygl::texture::magnification_filter() const
@@ -369,11 +495,53 @@ tinygl::texture::filter tinygl::texture::magnification_filter() const
 }
 
 void tinygl::texture::set_min_mag_filters(
-    tinygl::texture::filter minification_filter, tinygl::texture::filter magnification_filter)
+    tinygl::texture::filter minification_filter,
+    tinygl::texture::filter magnification_filter,
+    std::source_location call_site)
 {
     assert(p->bound());
-    set_minification_filter(minification_filter);
-    set_magnification_filter(magnification_filter);
+    set_minification_filter(minification_filter, call_site);
+    set_magnification_filter(magnification_filter, call_site);
+}
+
+std::int32_t tinygl::texture::width() const
+{
+    return p->width;
+}
+
+std::int32_t tinygl::texture::height() const
+{
+    return p->height;
+}
+
+std::int32_t tinygl::texture::depth() const
+{
+    return p->depth;
+}
+
+std::int32_t tinygl::texture::levels() const
+{
+    return p->levels;
+}
+
+tinygl::texture::target tinygl::texture::get_target() const
+{
+    return p->texture_target;
+}
+
+tinygl::texture::internal_format tinygl::texture::get_internal_format() const
+{
+    return p->internal_format;
+}
+
+std::uint32_t tinygl::texture::id() const
+{
+    return p->id;
+}
+
+std::uint64_t tinygl::texture::serial() const
+{
+    return p->serial;
 }
 
 std::string tinygl::texture::to_string(const tinygl::texture::coordinate& direction)
@@ -403,3 +571,73 @@ std::string tinygl::texture::to_string(const tinygl::texture::target& target)
         default: return "";
     }
 }
+
+void tinygl::texture::update(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t z, std::int32_t width,
+                             std::int32_t height, std::int32_t depth, format format, data_type type,
+                             const void* pixels,
+                             std::source_location call_site)
+{
+    assert(p->bound());
+
+    switch (p->texture_target) {
+        case target::gl_texture_3d:
+        case target::gl_texture_2d_array:
+        case target::gl_texture_cube_map_array:
+            glTexSubImage3D(utils::gl_enum(p->texture_target), level, x, y, z, width, height, depth,
+                            utils::gl_enum(format), utils::gl_enum(type), pixels);
+            break;
+        case target::gl_texture_cube_map:
+            assert(depth == 1 && z >= 0 && z < 6);
+            glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(z), level, x, y, width, height,
+                            utils::gl_enum(format), utils::gl_enum(type), pixels);
+            break;
+        default:
+            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+    }
+    validation::check(call_site);
+}
+
+void tinygl::texture::update_compressed(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t width,
+                                        std::int32_t height, internal_format internal_format, std::size_t size,
+                                        const void* data,
+                                        std::source_location call_site)
+{
+    assert(p->bound());
+
+    switch (p->texture_target) {
+        case target::gl_texture_2d:
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height,
+                                      static_cast<GLenum>(utils::gl_int(internal_format)),
+                                      static_cast<GLsizei>(size), data);
+            break;
+        default:
+            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+    }
+    validation::check(call_site);
+}
+
+void tinygl::texture::update_compressed(std::int32_t level, std::int32_t x, std::int32_t y, std::int32_t z,
+                                        std::int32_t width, std::int32_t height, std::int32_t depth,
+                                        internal_format internal_format, std::size_t size, const void* data,
+                                        std::source_location call_site)
+{
+    assert(p->bound());
+
+    auto gl_format = static_cast<GLenum>(utils::gl_int(internal_format));
+    switch (p->texture_target) {
+        case target::gl_texture_3d:
+        case target::gl_texture_2d_array:
+        case target::gl_texture_cube_map_array:
+            glCompressedTexSubImage3D(utils::gl_enum(p->texture_target), level, x, y, z, width, height, depth,
+                                      gl_format, static_cast<GLsizei>(size), data);
+            break;
+        case target::gl_texture_cube_map:
+            assert(depth == 1 && z >= 0 && z < 6);
+            glCompressedTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(z), level, x, y, width,
+                                      height, gl_format, static_cast<GLsizei>(size), data);
+            break;
+        default:
+            throw std::runtime_error("[tinygl::texture] texture target is not handled yet!");
+    }
+    validation::check(call_site);
+}
@@ -0,0 +1,362 @@
+#include "tinygl/texture_atlas.h"
+#include "stb/stb_image.h"
+#include "mapped_file.h"
+#include "texture_utils.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    struct position
+    {
+        std::int32_t x;
+        std::int32_t y;
+    };
+
+    // Bottom-left skyline packer for one layer: the top edge of everything placed so far, as horizontal segments.
+    class skyline
+    {
+    public:
+        skyline(std::int32_t width, std::int32_t height) : width{width}, height{height}, segments{{0, 0, width}} {}
+
+        std::optional<position> insert(std::int32_t rectangle_width, std::int32_t rectangle_height);
+
+    private:
+        struct segment
+        {
+            std::int32_t x;
+            std::int32_t y;
+            std::int32_t width;
+        };
+
+        // Height at which a rectangle starting at segments[index] rests, if it fits there at all.
+        std::optional<std::int32_t> fit(std::size_t index, std::int32_t rectangle_width,
+                                        std::int32_t rectangle_height) const;
+
+        std::int32_t width;
+        std::int32_t height;
+        std::vector<segment> segments;
+    };
+
+    std::optional<std::int32_t> skyline::fit(std::size_t index, std::int32_t rectangle_width,
+                                             std::int32_t rectangle_height) const
+    {
+        if (segments[index].x + rectangle_width > width) {
+            return std::nullopt;
+        }
+        std::int32_t y = 0;
+        // The segments cover the whole width, so the loop ends before running out of them.
+        for (auto remaining = rectangle_width; remaining > 0; remaining -= segments[index++].width) {
+            y = std::max(y, segments[index].y);
+            if (y + rectangle_height > height) {
+                return std::nullopt;
+            }
+        }
+        return y;
+    }
+
+    std::optional<position> skyline::insert(std::int32_t rectangle_width, std::int32_t rectangle_height)
+    {
+        // Lowest top edge first, then the narrowest segment, which leaves wider gaps for later rectangles.
+        auto best = segments.size();
+        auto best_top = INT_MAX;
+        std::int32_t best_y = 0;
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            auto y = fit(i, rectangle_width, rectangle_height);
+            if (y && (*y + rectangle_height < best_top ||
+                      (*y + rectangle_height == best_top && segments[i].width < segments[best].width))) {
+                best = i;
+                best_top = *y + rectangle_height;
+                best_y = *y;
+            }
+        }
+        if (best == segments.size()) {
+            return std::nullopt;
+        }
+
+        position result{segments[best].x, best_y};
+        segments.insert(segments.begin() + static_cast<std::ptrdiff_t>(best),
+                        {result.x, best_top, rectangle_width});
+        // Cut the segments now hidden below the new one.
+        for (auto i = best + 1; i < segments.size();) {
+            auto end = segments[i - 1].x + segments[i - 1].width;
+            if (segments[i].x >= end) {
+                break;
+            }
+            auto overlap = end - segments[i].x;
+            segments[i].x += overlap;
+            segments[i].width -= overlap;
+            if (segments[i].width > 0) {
+                break;
+            }
+            segments.erase(segments.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        for (std::size_t i = 0; i + 1 < segments.size();) {
+            if (segments[i].y == segments[i + 1].y) {
+                segments[i].width += segments[i + 1].width;
+                segments.erase(segments.begin() + static_cast<std::ptrdiff_t>(i + 1));
+            } else {
+                ++i;
+            }
+        }
+        return result;
+    }
+}
+
+struct tinygl::texture_atlas::texture_atlas_private
+{
+    struct image
+    {
+        std::int32_t width;
+        std::int32_t height;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // Size of an image's cell: the image, its gutter and the alignment.
+    std::int32_t cell_size(std::int32_t size) const
+    {
+        return (size + 2 * padding + alignment - 1) / alignment * alignment;
+    }
+
+    texture::target target;
+    texture::internal_format internal_format;
+    texture::format format;
+    std::int32_t channels;
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t padding;
+    std::int32_t levels;
+    std::int32_t alignment;
+
+    std::vector<image> images;
+    std::vector<region> regions;
+    std::int32_t layer_count = 0;
+    std::optional<texture> atlas;
+    std::unique_ptr<mipmap_generator> mip_generator;
+};
+
+tinygl::texture_atlas::texture_atlas(
+        texture::target target,
+        texture::internal_format internal_format,
+        texture::format format,
+        std::int32_t width,
+        std::int32_t height,
+        std::int32_t padding,
+        std::int32_t levels) :
+    p{std::make_unique<texture_atlas_private>()}
+{
+    if (target != texture::target::gl_texture_2d && target != texture::target::gl_texture_2d_array) {
+        throw std::invalid_argument(
+            "tinygl::texture_atlas::texture_atlas(): target has to be gl_texture_2d or gl_texture_2d_array!");
+    }
+    if (utils::channel_count(format) == 0) {
+        throw std::invalid_argument("tinygl::texture_atlas::texture_atlas(): format is not a colour format!");
+    }
+    if (levels < 1 || levels > mipmap_generator::full_level_count(width, height) || padding < 0) {
+        throw std::invalid_argument("tinygl::texture_atlas::texture_atlas(): invalid level count or padding!");
+    }
+    p->target = target;
+    p->internal_format = internal_format;
+    p->format = format;
+    p->channels = utils::channel_count(format);
+    p->width = width;
+    p->height = height;
+    p->padding = padding;
+    p->levels = levels;
+    p->alignment = 1 << (levels - 1);
+    if (width % p->alignment != 0 || height % p->alignment != 0) {
+        throw std::invalid_argument(
+            "tinygl::texture_atlas::texture_atlas(): the size has to be a multiple of 2^(levels - 1)!");
+    }
+}
+
+tinygl::texture_atlas::~texture_atlas() = default;
+
+tinygl::texture_atlas::texture_atlas(texture_atlas&& other) noexcept = default;
+
+tinygl::texture_atlas& tinygl::texture_atlas::operator=(texture_atlas&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+std::size_t tinygl::texture_atlas::add(const image_view& image)
+{
+    if (image.channels != p->channels) {
+        throw std::invalid_argument("tinygl::texture_atlas::add(): the channel count does not match the format!");
+    }
+    if (!image.pixels || image.width < 1 || image.height < 1) {
+        throw std::invalid_argument("tinygl::texture_atlas::add(): empty image!");
+    }
+    if (p->cell_size(image.width) > p->width || p->cell_size(image.height) > p->height) {
+        throw std::invalid_argument("tinygl::texture_atlas::add(): the image is larger than a layer!");
+    }
+    auto size = static_cast<std::size_t>(image.width) * image.height * image.channels;
+    p->images.push_back({image.width, image.height, {image.pixels, image.pixels + size}});
+    p->regions.push_back({});
+    return p->images.size() - 1;
+}
+
+std::size_t tinygl::texture_atlas::add(const std::filesystem::path& file_name)
+{
+    int width, height, channels;
+    std::string error;
+    stbi_set_flip_vertically_on_load(true);
+    auto* pixels = utils::load_image(file_name, width, height, channels, p->channels, error);
+    if (!pixels) {
+        throw std::runtime_error("tinygl::texture_atlas::add(): " + error + "!");
+    }
+    try {
+        auto id = add(image_view{pixels, width, height, p->channels});
+        stbi_image_free(pixels);
+        return id;
+    } catch (...) {
+        stbi_image_free(pixels);
+        throw;
+    }
+}
+
+void tinygl::texture_atlas::build(std::uint32_t unit, std::source_location call_site)
+{
+    GLint max_layers = 1;
+    if (p->target == texture::target::gl_texture_2d_array) {
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    }
+
+    // Tallest first, which keeps the skyline flat.
+    std::vector<std::size_t> order(p->images.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::ranges::stable_sort(order, [this](std::size_t a, std::size_t b) {
+        const auto& first = p->images[a];
+        const auto& second = p->images[b];
+        return std::pair{first.height, first.width} > std::pair{second.height, second.width};
+    });
+
+    std::vector<skyline> layers;
+    for (auto id : order) {
+        const auto& image = p->images[id];
+        auto cell_width = p->cell_size(image.width);
+        auto cell_height = p->cell_size(image.height);
+        std::optional<position> cell;
+        std::size_t layer = 0;
+        for (; layer < layers.size() && !cell; ++layer) {
+            cell = layers[layer].insert(cell_width, cell_height);
+        }
+        if (!cell) {
+            if (static_cast<GLint>(layers.size()) == max_layers) {
+                throw std::runtime_error("tinygl::texture_atlas::build(): the images do not fit!");
+            }
+            cell = layers.emplace_back(p->width, p->height).insert(cell_width, cell_height);
+            layer = layers.size();
+        }
+
+        auto& region = p->regions[id];
+        region.layer = static_cast<std::int32_t>(layer - 1);
+        region.x = cell->x + p->padding;
+        region.y = cell->y + p->padding;
+        region.width = image.width;
+        region.height = image.height;
+        region.u0 = static_cast<float>(region.x) / static_cast<float>(p->width);
+        region.v0 = static_cast<float>(region.y) / static_cast<float>(p->height);
+        region.u1 = static_cast<float>(region.x + region.width) / static_cast<float>(p->width);
+        region.v1 = static_cast<float>(region.y + region.height) / static_cast<float>(p->height);
+    }
+    p->layer_count = std::max<std::int32_t>(static_cast<std::int32_t>(layers.size()), 1);
+
+    // The gutter and the alignment slack of every cell repeat the image's edge texels.
+    auto pixel_size = static_cast<std::size_t>(p->channels);
+    std::vector<std::vector<std::uint8_t>> pages(
+        static_cast<std::size_t>(p->layer_count),
+        std::vector<std::uint8_t>(static_cast<std::size_t>(p->width) * p->height * pixel_size));
+    for (std::size_t id = 0; id < p->images.size(); ++id) {
+        const auto& image = p->images[id];
+        const auto& region = p->regions[id];
+        auto& page = pages[static_cast<std::size_t>(region.layer)];
+        auto left = region.x - p->padding;
+        auto bottom = region.y - p->padding;
+        for (std::int32_t y = 0; y < p->cell_size(image.height); ++y) {
+            auto source_y = std::clamp(y - p->padding, 0, image.height - 1);
+            auto* row = page.data() + (static_cast<std::size_t>(bottom + y) * p->width + left) * pixel_size;
+            for (std::int32_t x = 0; x < p->cell_size(image.width); ++x) {
+                auto source_x = std::clamp(x - p->padding, 0, image.width - 1);
+                std::memcpy(row + static_cast<std::size_t>(x) * pixel_size,
+                            image.pixels.data() + (static_cast<std::size_t>(source_y) * image.width + source_x) *
+                                pixel_size,
+                            pixel_size);
+            }
+        }
+    }
+
+    // A box filter over aligned cells never reaches into the neighbouring cell.
+    std::vector<std::vector<image_level>> mips;
+    if (p->levels > 1) {
+        if (!p->mip_generator) {
+            p->mip_generator = std::make_unique<mipmap_generator>();
+        }
+        std::vector<image_view> views;
+        for (const auto& page : pages) {
+            views.push_back({page.data(), p->width, p->height, p->channels});
+        }
+        mips = p->mip_generator->generate(
+            views, {mipmap_filter::box, utils::srgb(p->internal_format), 0.0f, p->levels});
+    }
+
+    p->atlas.emplace(
+        texture::storage{p->target, p->internal_format, p->width, p->height, p->layer_count, p->levels}, unit,
+        call_site);
+    p->atlas->bind(call_site);
+    // Rows are tightly packed, e.g. 3 bytes per pixel.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (std::size_t layer = 0; layer < pages.size(); ++layer) {
+        for (std::int32_t level = 0; level < p->levels; ++level) {
+            auto level_width = std::max(p->width >> level, 1);
+            auto level_height = std::max(p->height >> level, 1);
+            const auto* pixels = level == 0 ? pages[layer].data()
+                                            : mips[layer][static_cast<std::size_t>(level - 1)].pixels.data();
+            if (p->target == texture::target::gl_texture_2d_array) {
+                p->atlas->update(level, 0, 0, static_cast<std::int32_t>(layer), level_width, level_height, 1,
+                                 p->format, data_type::gl_unsigned_byte, pixels, call_site);
+            } else {
+                p->atlas->update(level, 0, 0, level_width, level_height, p->format, data_type::gl_unsigned_byte,
+                                 pixels, call_site);
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    p->atlas->set_wrap_mode(texture::wrap_mode::gl_clamp_to_edge, call_site);
+    p->atlas->unbind(call_site);
+    validation::check(call_site);
+}
+
+tinygl::texture& tinygl::texture_atlas::get_texture()
+{
+    if (!p->atlas) {
+        throw std::logic_error("tinygl::texture_atlas::get_texture(): build() was not called!");
+    }
+    return *p->atlas;
+}
+
+const tinygl::texture_atlas::region& tinygl::texture_atlas::get_region(std::size_t id) const
+{
+    return p->regions.at(id);
+}
+
+std::size_t tinygl::texture_atlas::size() const
+{
+    return p->images.size();
+}
+
+std::int32_t tinygl::texture_atlas::layer_count() const
+{
+    return p->layer_count;
+}
@@ -0,0 +1,397 @@
+#include "tinygl/texture_loader.h"
+#include "tinygl/compressed_image.h"
+#include "tinygl/streaming_buffer.h"
+#include "stb/stb_image.h"
+#include "mapped_file.h"
+#include "texture_utils.h"
+#include "thread_pool.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    int channel_count(tinygl::texture::format format)
+    {
+        auto channels = tinygl::utils::channel_count(format);
+        if (channels == 0) {
+            throw std::invalid_argument("tinygl::texture_loader::load(): format cannot be decoded from a file!");
+        }
+        return channels;
+    }
+
+    // KTX2 and DDS files are uploaded as they are, straight from their mapping.
+    bool block_compressed(const std::filesystem::path& file_name)
+    {
+        auto extension = file_name.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        return extension == ".ktx2" || extension == ".dds";
+    }
+
+    struct image_deleter
+    {
+        void operator()(stbi_uc* pixels) const { stbi_image_free(pixels); }
+    };
+}
+
+struct tinygl::texture_handle::texture_handle_private
+{
+    std::filesystem::path file_name;
+    texture::internal_format internal_format;
+    texture::format format;
+    std::uint32_t unit;
+    std::optional<mipmap_settings> mip_settings;
+    std::shared_ptr<texture> placeholder;
+
+    std::atomic<status> state{status::loading};
+    std::optional<tinygl::texture> loaded;
+    std::string error;
+
+    // Written by a worker before the handle is queued for upload, then only touched by update().
+    std::unique_ptr<stbi_uc, image_deleter> pixels;
+    std::optional<compressed_image> compressed;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    std::vector<image_level> mip_levels;
+    std::int32_t uploaded_level = 0;
+    std::int32_t uploaded_rows = 0;
+
+    // A level as rows the upload can be split at: rows of pixels, or rows of 4x4 blocks if compressed.
+    struct level_layout
+    {
+        const std::uint8_t* data;
+        std::int32_t width;
+        std::int32_t height;
+        std::int32_t rows;
+        std::size_t row_size;
+    };
+
+    std::int32_t level_count() const;
+    level_layout layout(std::int32_t level) const;
+};
+
+std::int32_t tinygl::texture_handle::texture_handle_private::level_count() const
+{
+    return compressed ? compressed->level_count() : 1 + static_cast<std::int32_t>(mip_levels.size());
+}
+
+tinygl::texture_handle::texture_handle_private::level_layout
+tinygl::texture_handle::texture_handle_private::layout(std::int32_t level) const
+{
+    if (compressed) {
+        auto level_width = compressed->level_width(level);
+        auto level_height = compressed->level_height(level);
+        return {compressed->level_data(level).data(), level_width, level_height, (level_height + 3) / 4,
+                utils::image_size(compressed->internal_format(), level_width, 1)};
+    }
+    auto channels = static_cast<std::size_t>(channel_count(format));
+    if (level == 0) {
+        return {pixels.get(), width, height, height, static_cast<std::size_t>(width) * channels};
+    }
+    const auto& mip = mip_levels[static_cast<std::size_t>(level - 1)];
+    return {mip.pixels.data(), mip.width, mip.height, mip.height, static_cast<std::size_t>(mip.width) * channels};
+}
+
+tinygl::texture_handle::texture_handle() = default;
+
+tinygl::texture& tinygl::texture_handle::get() const
+{
+    if (!p) {
+        throw std::logic_error("tinygl::texture_handle::get(): empty handle!");
+    }
+    return ready() ? *p->loaded : *p->placeholder;
+}
+
+tinygl::texture_handle::status tinygl::texture_handle::get_status() const
+{
+    return p ? p->state.load(std::memory_order_acquire) : status::failed;
+}
+
+bool tinygl::texture_handle::ready() const
+{
+    return get_status() == status::ready;
+}
+
+std::string tinygl::texture_handle::error() const
+{
+    return get_status() == status::failed && p ? p->error : std::string{};
+}
+
+long tinygl::texture_handle::use_count() const
+{
+    return p.use_count();
+}
+
+tinygl::texture_handle::operator bool() const
+{
+    return static_cast<bool>(p);
+}
+
+struct tinygl::texture_loader::texture_loader_private
+{
+    texture_loader_private(std::size_t bytes_per_frame, std::size_t worker_count, color placeholder_color);
+
+    std::shared_ptr<texture> placeholder(std::uint32_t unit);
+    void decode(const std::shared_ptr<texture_handle::texture_handle_private>& handle);
+
+    std::size_t bytes_per_frame;
+    color placeholder_color;
+    std::optional<mipmap_settings> mip_settings;
+    // Created by the first set_mipmap_settings(); shared by all workers.
+    std::unique_ptr<mipmap_generator> mip_generator;
+    std::map<std::uint32_t, std::shared_ptr<texture>> placeholders;
+    streaming_buffer staging;
+    std::atomic<std::size_t> pending{0};
+
+    std::mutex decoded_mutex;
+    std::vector<std::shared_ptr<texture_handle::texture_handle_private>> decoded;
+    // Render thread only: partially uploaded images, oldest first.
+    std::deque<std::shared_ptr<texture_handle::texture_handle_private>> uploads;
+
+    // Declared last: destroyed first, so no worker outlives the state it uses.
+    utils::thread_pool workers;
+};
+
+tinygl::texture_loader::texture_loader_private::texture_loader_private(
+        std::size_t bytes_per_frame, std::size_t worker_count, color placeholder_color) :
+    bytes_per_frame{std::max<std::size_t>(bytes_per_frame, 1)},
+    placeholder_color{placeholder_color},
+    staging{buffer::binding_target::gl_pixel_unpack_buffer, this->bytes_per_frame},
+    workers{std::max<std::size_t>(worker_count, 1)}
+{
+}
+
+std::shared_ptr<tinygl::texture> tinygl::texture_loader::texture_loader_private::placeholder(std::uint32_t unit)
+{
+    auto& placeholder = placeholders[unit];
+    if (!placeholder) {
+        auto to_byte = [](float value) {
+            return static_cast<std::uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        };
+        const std::uint8_t pixel[4] = {
+            to_byte(placeholder_color.r), to_byte(placeholder_color.g), to_byte(placeholder_color.b),
+            to_byte(placeholder_color.a)};
+        placeholder = std::make_shared<texture>(
+            texture::target::gl_texture_2d, texture::internal_format::gl_rgba8, 1, 1, unit);
+        placeholder->bind();
+        placeholder->update(0, 0, 0, 1, 1, texture::format::gl_rgba, data_type::gl_unsigned_byte, pixel);
+        placeholder->unbind();
+    }
+    return placeholder;
+}
+
+void tinygl::texture_loader::texture_loader_private::decode(
+        const std::shared_ptr<texture_handle::texture_handle_private>& handle)
+{
+    auto fail = [&] {
+        spdlog::error("[tinygl::texture_loader] {}", handle->error);
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        handle->state.store(texture_handle::status::failed, std::memory_order_release);
+    };
+
+    if (block_compressed(handle->file_name)) {
+        try {
+            handle->compressed.emplace(handle->file_name);
+        } catch (const std::runtime_error& e) {
+            handle->error = e.what();
+            fail();
+            return;
+        }
+        handle->width = handle->compressed->width();
+        handle->height = handle->compressed->height();
+    } else {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load_thread(true);
+        auto* pixels = utils::load_image(
+            handle->file_name, width, height, channels, channel_count(handle->format), handle->error);
+        if (!pixels) {
+            fail();
+            return;
+        }
+        handle->pixels.reset(pixels);
+        handle->width = width;
+        handle->height = height;
+        if (handle->mip_settings) {
+            auto level = image_view{pixels, width, height, channel_count(handle->format)};
+            handle->mip_levels = mip_generator->generate(level, *handle->mip_settings);
+        }
+    }
+
+    std::lock_guard lock{decoded_mutex};
+    decoded.push_back(handle);
+}
+
+tinygl::texture_loader::texture_loader(std::size_t bytes_per_frame, std::size_t worker_count, color placeholder) :
+    p{std::make_unique<texture_loader_private>(bytes_per_frame, worker_count, placeholder)}
+{
+}
+
+tinygl::texture_loader::~texture_loader() = default;
+
+tinygl::texture_handle tinygl::texture_loader::load(
+        const std::filesystem::path& file_name,
+        texture::internal_format internal_format,
+        texture::format format,
+        std::uint32_t unit)
+{
+    // Rejects formats that cannot be decoded before anything is queued.
+    channel_count(format);
+
+    texture_handle handle;
+    handle.p = std::make_shared<texture_handle::texture_handle_private>();
+    handle.p->file_name = file_name;
+    handle.p->internal_format = internal_format;
+    handle.p->format = format;
+    handle.p->unit = unit;
+    if (p->mip_settings) {
+        handle.p->mip_settings = p->mip_settings;
+        handle.p->mip_settings->srgb = utils::srgb(internal_format);
+    }
+    handle.p->placeholder = p->placeholder(unit);
+
+    p->pending.fetch_add(1, std::memory_order_relaxed);
+    std::weak_ptr<texture_handle::texture_handle_private> weak = handle.p;
+    p->workers.submit([loader = p.get(), weak] {
+        // Nobody is waiting for textures whose handles were all dropped.
+        if (auto handle = weak.lock()) {
+            loader->decode(handle);
+        } else {
+            loader->pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+    });
+    return handle;
+}
+
+void tinygl::texture_loader::update(std::source_location call_site)
+{
+    {
+        std::lock_guard lock{p->decoded_mutex};
+        for (auto& handle : p->decoded) {
+            p->uploads.push_back(std::move(handle));
+        }
+        p->decoded.clear();
+    }
+    std::erase_if(p->uploads, [this](const auto& handle) {
+        if (handle.use_count() > 1) {
+            return false;
+        }
+        p->pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    });
+    if (p->uploads.empty()) {
+        return;
+    }
+
+    struct strip
+    {
+        texture_handle::texture_handle_private* handle;
+        std::int32_t level;
+        std::int32_t first_row;
+        std::int32_t rows;
+        std::size_t offset;
+        std::size_t size;
+    };
+    std::vector<strip> strips;
+
+    // At least one row is uploaded per frame, however large, so every image makes progress.
+    const auto& front = *p->uploads.front();
+    p->staging.begin_frame(std::max(p->bytes_per_frame, front.layout(front.uploaded_level).row_size), call_site);
+    auto budget = p->bytes_per_frame;
+    auto full = false;
+    for (auto it = p->uploads.begin(); it != p->uploads.end() && !full; ++it) {
+        auto& handle = **it;
+        while (handle.uploaded_level < handle.level_count()) {
+            auto level = handle.layout(handle.uploaded_level);
+            auto rows = static_cast<std::int32_t>(
+                std::min<std::size_t>(level.rows - handle.uploaded_rows, budget / level.row_size));
+            if (rows == 0) {
+                if (!strips.empty()) {
+                    full = true;
+                    break;
+                }
+                rows = 1;
+            }
+            auto bytes = level.row_size * static_cast<std::size_t>(rows);
+            auto allocation = p->staging.allocate(bytes, 4);
+            std::memcpy(allocation.data, level.data + level.row_size * handle.uploaded_rows, bytes);
+            strips.push_back({&handle, handle.uploaded_level, handle.uploaded_rows, rows, allocation.offset, bytes});
+            handle.uploaded_rows += rows;
+            // Counting the padding of the next allocation keeps everything within the region.
+            budget -= std::min(budget, (bytes + 3) / 4 * 4);
+            if (handle.uploaded_rows < level.rows) {
+                full = true;
+                break;
+            }
+            ++handle.uploaded_level;
+            handle.uploaded_rows = 0;
+        }
+    }
+    p->staging.flush(call_site);
+
+    p->staging.bind(call_site);
+    // Rows are tightly packed, e.g. 3 bytes per pixel.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const auto& strip : strips) {
+        auto& handle = *strip.handle;
+        auto internal_format = handle.compressed ? handle.compressed->internal_format() : handle.internal_format;
+        if (!handle.loaded) {
+            handle.loaded.emplace(texture::target::gl_texture_2d, internal_format, handle.width, handle.height,
+                                  handle.unit, 0, handle.level_count());
+        }
+        auto level = handle.layout(strip.level);
+        const auto* offset = reinterpret_cast<const void*>(strip.offset);
+        handle.loaded->bind(call_site);
+        if (handle.compressed) {
+            // Rows of blocks; the last one may be shorter than four pixels.
+            auto y = strip.first_row * 4;
+            auto height = std::min(strip.rows * 4, level.height - y);
+            handle.loaded->update_compressed(
+                strip.level, 0, y, level.width, height, internal_format, strip.size, offset);
+        } else {
+            handle.loaded->update(strip.level, 0, strip.first_row, level.width, strip.rows, handle.format,
+                                   data_type::gl_unsigned_byte, offset, call_site);
+        }
+        handle.loaded->unbind(call_site);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    p->staging.end_frame(call_site);
+
+    while (!p->uploads.empty() && p->uploads.front()->uploaded_level == p->uploads.front()->level_count()) {
+        auto& handle = *p->uploads.front();
+        handle.pixels.reset();
+        handle.compressed.reset();
+        handle.mip_levels.clear();
+        handle.state.store(texture_handle::status::ready, std::memory_order_release);
+        p->pending.fetch_sub(1, std::memory_order_relaxed);
+        p->uploads.pop_front();
+    }
+    validation::check(call_site);
+}
+
+void tinygl::texture_loader::set_bytes_per_frame(std::size_t bytes)
+{
+    p->bytes_per_frame = std::max<std::size_t>(bytes, 1);
+}
+
+std::size_t tinygl::texture_loader::pending() const
+{
+    return p->pending.load(std::memory_order_relaxed);
+}
+
+void tinygl::texture_loader::set_mipmap_settings(std::optional<mipmap_settings> settings)
+{
+    if (settings && !p->mip_generator) {
+        p->mip_generator = std::make_unique<mipmap_generator>(p->workers.thread_count());
+    }
+    p->mip_settings = settings;
+}
@@ -0,0 +1,164 @@
+#include "tinygl/texture_registry.h"
+#include "texture_utils.h"
+#include <algorithm>
+#include <compare>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+    struct key
+    {
+        std::filesystem::path path;
+        tinygl::texture::target target;
+        tinygl::texture::internal_format internal_format;
+        tinygl::texture::format format;
+
+        auto operator<=>(const key&) const = default;
+    };
+
+    std::filesystem::path canonical_path(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        auto result = std::filesystem::weakly_canonical(path, error);
+        return error ? std::filesystem::absolute(path).lexically_normal() : result;
+    }
+}
+
+struct tinygl::texture_registry::texture_registry_private
+{
+    struct entry
+    {
+        texture_handle handle;
+        std::size_t gpu_bytes = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    // The registry's own handle is one of the references.
+    static bool referenced(const entry& entry) { return entry.handle.use_count() > 1; }
+
+    void evict(std::size_t target_bytes);
+
+    texture_loader* loader;
+    std::size_t budget;
+    std::map<key, entry> entries;
+    std::size_t gpu_bytes = 0;
+    std::uint64_t clock = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+};
+
+void tinygl::texture_registry::texture_registry_private::evict(std::size_t target_bytes)
+{
+    while (gpu_bytes > target_bytes) {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.gpu_bytes > 0 && !referenced(it->second) &&
+                (victim == entries.end() || it->second.last_used < victim->second.last_used)) {
+                victim = it;
+            }
+        }
+        if (victim == entries.end()) {
+            return;
+        }
+        gpu_bytes -= victim->second.gpu_bytes;
+        entries.erase(victim);
+        ++evictions;
+    }
+}
+
+tinygl::texture_registry::texture_registry(texture_loader& loader, std::size_t budget) :
+    p{std::make_unique<texture_registry_private>()}
+{
+    p->loader = &loader;
+    p->budget = budget;
+}
+
+tinygl::texture_registry::~texture_registry() = default;
+
+tinygl::texture_registry::texture_registry(texture_registry&& other) noexcept = default;
+
+tinygl::texture_registry& tinygl::texture_registry::operator=(texture_registry&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+tinygl::texture_handle tinygl::texture_registry::acquire(
+        const std::filesystem::path& file_name,
+        texture::internal_format internal_format,
+        texture::format format,
+        std::uint32_t unit,
+        texture::target target)
+{
+    if (target != texture::target::gl_texture_2d) {
+        throw std::invalid_argument("tinygl::texture_registry::acquire(): only gl_texture_2d is supported!");
+    }
+    auto [it, inserted] = p->entries.try_emplace(key{canonical_path(file_name), target, internal_format, format});
+    auto& entry = it->second;
+    if (inserted) {
+        try {
+            entry.handle = p->loader->load(it->first.path, internal_format, format, unit);
+        } catch (...) {
+            p->entries.erase(it);
+            throw;
+        }
+        ++p->misses;
+    } else {
+        ++p->hits;
+    }
+    entry.last_used = ++p->clock;
+    return entry.handle;
+}
+
+void tinygl::texture_registry::update()
+{
+    p->loader->update();
+
+    for (auto it = p->entries.begin(); it != p->entries.end();) {
+        auto& [key, entry] = *it;
+        auto status = entry.handle.get_status();
+        if (status == texture_handle::status::failed && !texture_registry_private::referenced(entry)) {
+            // Let a later request try again, the file may have been fixed.
+            it = p->entries.erase(it);
+            continue;
+        }
+        if (status == texture_handle::status::ready && entry.gpu_bytes == 0) {
+            const auto& texture = entry.handle.get();
+            // Charged with what was allocated: compressed files keep their block format whatever was requested.
+            entry.gpu_bytes = utils::storage_size(
+                texture.get_internal_format(), texture.width(), texture.height(), texture.depth(), texture.levels());
+            p->gpu_bytes += entry.gpu_bytes;
+        }
+        ++it;
+    }
+    p->evict(p->budget);
+}
+
+void tinygl::texture_registry::set_budget(std::size_t bytes)
+{
+    p->budget = bytes;
+    p->evict(p->budget);
+}
+
+std::size_t tinygl::texture_registry::budget() const
+{
+    return p->budget;
+}
+
+void tinygl::texture_registry::evict_unused()
+{
+    p->evict(0);
+}
+
+tinygl::texture_registry::statistics tinygl::texture_registry::get_statistics() const
+{
+    auto referenced = static_cast<std::size_t>(
+        std::ranges::count_if(p->entries, [](const auto& item) {
+            return texture_registry_private::referenced(item.second);
+        }));
+    return {p->entries.size(), referenced, p->gpu_bytes, p->hits, p->misses, p->evictions};
+}
@@ -0,0 +1,146 @@
+#include "tinygl/texture_unit_manager.h"
+#include "state_cache.h"
+#include "texture_utils.h"
+#include "validation.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+struct tinygl::texture_unit_manager::texture_unit_manager_private
+{
+    struct slot
+    {
+        std::uint64_t serial = 0;  // 0 when empty
+        GLuint id = 0;
+        GLenum target = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    std::uint32_t first_unit;
+    std::vector<slot> slots;
+    // Texture serial to index into slots.
+    std::unordered_map<std::uint64_t, std::uint32_t> resident;
+    std::uint64_t clock = 0;
+    // Slots used after this time belong to the current draw and must not be evicted.
+    std::uint64_t draw_start = 0;
+    std::uint64_t binds = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t evictions = 0;
+};
+
+tinygl::texture_unit_manager::texture_unit_manager(std::uint32_t first_unit, std::uint32_t unit_count,
+                                                   std::source_location call_site) :
+    p{std::make_unique<texture_unit_manager_private>()}
+{
+    if (unit_count == 0) {
+        // Only units the state cache covers: a hit on any other costs a glGetIntegerv() round trip.
+        GLint max_units = 0;
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &max_units);
+        auto last_unit =
+            std::min(static_cast<std::uint32_t>(std::max(max_units, 0)), state_cache::cached_texture_units);
+        if (first_unit < last_unit) {
+            unit_count = last_unit - first_unit;
+        }
+    }
+    if (unit_count == 0) {
+        throw std::invalid_argument("tinygl::texture_unit_manager::texture_unit_manager(): no units to manage!");
+    }
+    p->first_unit = first_unit;
+    p->slots.resize(unit_count);
+    validation::check(call_site);
+}
+
+tinygl::texture_unit_manager::~texture_unit_manager() = default;
+
+tinygl::texture_unit_manager::texture_unit_manager(texture_unit_manager&& other) noexcept = default;
+
+tinygl::texture_unit_manager& tinygl::texture_unit_manager::operator=(texture_unit_manager&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::texture_unit_manager::begin_draw()
+{
+    p->draw_start = p->clock;
+}
+
+std::uint32_t tinygl::texture_unit_manager::bind(texture& texture, std::source_location call_site)
+{
+    auto serial = texture.serial();
+    if (auto it = p->resident.find(serial); it != p->resident.end()) {
+        auto& slot = p->slots[it->second];
+        auto unit = p->first_unit + it->second;
+        // The state cache knows about other binds to the unit and about deleted textures, at least for 2D ones.
+        if (slot.target != GL_TEXTURE_2D || state_cache::texture_2d(unit) == slot.id) {
+            slot.last_used = ++p->clock;
+            ++p->hits;
+            return unit;
+        }
+        slot = {};
+        p->resident.erase(it);
+    }
+
+    // An empty slot, otherwise the least recently used one outside the current draw.
+    auto victim = p->slots.size();
+    for (std::size_t i = 0; i < p->slots.size(); ++i) {
+        const auto& slot = p->slots[i];
+        if (slot.last_used > p->draw_start) {
+            continue;
+        }
+        if (victim == p->slots.size() || slot.serial == 0 ||
+            (p->slots[victim].serial != 0 && slot.last_used < p->slots[victim].last_used)) {
+            victim = i;
+            if (slot.serial == 0) {
+                break;
+            }
+        }
+    }
+    if (victim == p->slots.size()) {
+        throw std::runtime_error(
+            "tinygl::texture_unit_manager::bind(): the draw uses more textures than there are units!");
+    }
+
+    auto& slot = p->slots[victim];
+    if (slot.serial != 0) {
+        p->resident.erase(slot.serial);
+        ++p->evictions;
+    }
+    auto unit = p->first_unit + static_cast<std::uint32_t>(victim);
+    slot = {serial, texture.id(), utils::gl_enum(texture.get_target()), ++p->clock};
+    state_cache::bind_texture(unit, slot.target, slot.id);
+    p->resident[serial] = static_cast<std::uint32_t>(victim);
+    ++p->binds;
+    validation::check(call_site);
+    return unit;
+}
+
+std::uint32_t tinygl::texture_unit_manager::bind(texture& texture, shader_program& program, std::string_view name,
+                                                 std::source_location call_site)
+{
+    auto unit = bind(texture, call_site);
+    program.set_uniform_value(program.uniform_location(name), static_cast<std::int32_t>(unit), call_site);
+    return unit;
+}
+
+void tinygl::texture_unit_manager::invalidate()
+{
+    p->resident.clear();
+    for (auto& slot : p->slots) {
+        slot = {};
+    }
+}
+
+std::uint32_t tinygl::texture_unit_manager::unit_count() const
+{
+    return static_cast<std::uint32_t>(p->slots.size());
+}
+
+tinygl::texture_unit_manager::statistics tinygl::texture_unit_manager::get_statistics() const
+{
+    return {p->binds, p->hits, p->evictions};
+}
@@ -0,0 +1,405 @@
+#ifndef TINYGL_TEXTURE_UTILS_H
+#define TINYGL_TEXTURE_UTILS_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <tinygl/texture.h>
+
+namespace tinygl::utils {
+    inline constexpr GLenum gl_enum(tinygl::texture::target target)
+    {
+        switch(target) {
+            case tinygl::texture::target::gl_texture_1d: return GL_TEXTURE_1D;
+            case tinygl::texture::target::gl_texture_2d: return GL_TEXTURE_2D;
+            case tinygl::texture::target::gl_texture_3d: return GL_TEXTURE_3D;
+            case tinygl::texture::target::gl_texture_1d_array: return GL_TEXTURE_1D_ARRAY;
+            case tinygl::texture::target::gl_texture_2d_array: return GL_TEXTURE_2D_ARRAY;
+            case tinygl::texture::target::gl_texture_rectangle: return GL_TEXTURE_RECTANGLE;
+            case tinygl::texture::target::gl_texture_cube_map: return GL_TEXTURE_CUBE_MAP;
+            case tinygl::texture::target::gl_texture_cube_map_array: return GL_TEXTURE_CUBE_MAP_ARRAY;
+            case tinygl::texture::target::gl_texture_buffer: return GL_TEXTURE_BUFFER;
+            case tinygl::texture::target::gl_texture_2d_multisample: return GL_TEXTURE_2D_MULTISAMPLE;
+            case tinygl::texture::target::gl_texture_2d_multisample_array: return GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
+        }
+    }
+
+    inline constexpr GLenum gl_get_gl_enum(tinygl::texture::target target)
+    {
+        switch(target) {
+            case tinygl::texture::target::gl_texture_1d: return GL_TEXTURE_BINDING_1D;
+            case tinygl::texture::target::gl_texture_2d: return GL_TEXTURE_BINDING_2D;
+            case tinygl::texture::target::gl_texture_3d: return GL_TEXTURE_BINDING_3D;
+            case tinygl::texture::target::gl_texture_1d_array: return GL_TEXTURE_BINDING_1D_ARRAY;
+            case tinygl::texture::target::gl_texture_2d_array: return GL_TEXTURE_BINDING_2D_ARRAY;
+            case tinygl::texture::target::gl_texture_rectangle: return GL_TEXTURE_BINDING_RECTANGLE;
+            case tinygl::texture::target::gl_texture_cube_map: return GL_TEXTURE_BINDING_CUBE_MAP;
+            case tinygl::texture::target::gl_texture_cube_map_array: return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
+            case tinygl::texture::target::gl_texture_buffer: return GL_TEXTURE_BINDING_BUFFER;
+            case tinygl::texture::target::gl_texture_2d_multisample: return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+            case tinygl::texture::target::gl_texture_2d_multisample_array: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+        }
+    }
+
+    inline constexpr GLenum gl_enum(tinygl::texture::coordinate coordinate_direction)
+    {
+        switch(coordinate_direction) {
+        case tinygl::texture::coordinate::s: return GL_TEXTURE_WRAP_S;
+        case tinygl::texture::coordinate::t: return GL_TEXTURE_WRAP_T;
+        case tinygl::texture::coordinate::r: return GL_TEXTURE_WRAP_R;
+        }
+    }
+
+    inline constexpr GLint gl_int(tinygl::texture::wrap_mode wrap_mode)
+    {
+        switch(wrap_mode) {
+        case tinygl::texture::wrap_mode::gl_clamp_to_edge: return GL_CLAMP_TO_EDGE;
+        case tinygl::texture::wrap_mode::gl_clamp_to_border: return GL_CLAMP_TO_BORDER;
+        case tinygl::texture::wrap_mode::gl_mirrored_repeat: return GL_MIRRORED_REPEAT;
+        case tinygl::texture::wrap_mode::gl_repeat: return GL_REPEAT;
+        case tinygl::texture::wrap_mode::gl_mirror_clamp_to_edge: return GL_MIRROR_CLAMP_TO_EDGE;
+        }
+    }
+
+    inline constexpr GLint gl_int(tinygl::texture::filter filter)
+    {
+        switch(filter) {
+        case tinygl::texture::filter::nearest: return GL_NEAREST;
+        case tinygl::texture::filter::linear: return GL_LINEAR;
+        case tinygl::texture::filter::nearest_mip_map_nearest: return GL_NEAREST_MIPMAP_NEAREST;
+        case tinygl::texture::filter::nearest_mip_map_linear: return GL_NEAREST_MIPMAP_LINEAR;
+        case tinygl::texture::filter::linear_mip_map_nearest: return GL_LINEAR_MIPMAP_NEAREST;
+        case tinygl::texture::filter::linear_mip_map_linear: return GL_LINEAR_MIPMAP_LINEAR;
+        }
+    }
+
+    inline constexpr GLint gl_int(tinygl::texture::internal_format internal_format) {
+        switch(internal_format) {
+        case tinygl::texture::internal_format::gl_depth_component: return GL_DEPTH_COMPONENT;
+        case tinygl::texture::internal_format::gl_depth_stencil: return GL_DEPTH_STENCIL;
+        case tinygl::texture::internal_format::gl_red: return GL_RED;
+        case tinygl::texture::internal_format::gl_rg: return GL_RG;
+        case tinygl::texture::internal_format::gl_rgb: return GL_RGB;
+        case tinygl::texture::internal_format::gl_rgba: return GL_RGBA;
+        case tinygl::texture::internal_format::gl_r8: return GL_R8;
+        case tinygl::texture::internal_format::gl_r8_snorm: return GL_R8_SNORM;
+        case tinygl::texture::internal_format::gl_r16: return GL_R16;
+        case tinygl::texture::internal_format::gl_r16_snorm: return GL_R16_SNORM;
+        case tinygl::texture::internal_format::gl_rg8: return GL_RG8;
+        case tinygl::texture::internal_format::gl_rg8_snorm: return GL_RG8_SNORM;
+        case tinygl::texture::internal_format::gl_rg16: return GL_RG16;
+        case tinygl::texture::internal_format::gl_rg16_snorm: return GL_RG16_SNORM;
+        case tinygl::texture::internal_format::gl_r3_g3_b2: return GL_R3_G3_B2;
+        case tinygl::texture::internal_format::gl_rgb4: return GL_RGB4;
+        case tinygl::texture::internal_format::gl_rgb5: return GL_RGB5;
+        case tinygl::texture::internal_format::gl_rgb8: return GL_RGB8;
+        case tinygl::texture::internal_format::gl_rgb8_snorm: return GL_RGB8_SNORM;
+        case tinygl::texture::internal_format::gl_rgb10: return GL_RGB10;
+        case tinygl::texture::internal_format::gl_rgb12: return GL_RGB12;
+        case tinygl::texture::internal_format::gl_rgb16_snorm: return GL_RGB16_SNORM;
+        case tinygl::texture::internal_format::gl_rgba2: return GL_RGBA2;
+        case tinygl::texture::internal_format::gl_rgba4: return GL_RGBA4;
+        case tinygl::texture::internal_format::gl_rgb5_a1: return GL_RGB5_A1;
+        case tinygl::texture::internal_format::gl_rgba8: return GL_RGBA8;
+        case tinygl::texture::internal_format::gl_rgba8_snorm: return GL_RGBA8_SNORM;
+        case tinygl::texture::internal_format::gl_rgb10_a2: return GL_RGB10_A2;
+        case tinygl::texture::internal_format::gl_rgb10_a2ui: return GL_RGB10_A2UI;
+        case tinygl::texture::internal_format::gl_rgba12: return GL_RGBA12;
+        case tinygl::texture::internal_format::gl_rgba16: return GL_RGBA16;
+        case tinygl::texture::internal_format::gl_srgb8: return GL_SRGB8;
+        case tinygl::texture::internal_format::gl_srgb8_alpha8: return GL_SRGB8_ALPHA8;
+        case tinygl::texture::internal_format::gl_r16f: return GL_R16F;
+        case tinygl::texture::internal_format::gl_rg16f: return GL_RG16F;
+        case tinygl::texture::internal_format::gl_rgb16f: return GL_RGB16F;
+        case tinygl::texture::internal_format::gl_rgba16f: return GL_RGBA16F;
+        case tinygl::texture::internal_format::gl_r32f: return GL_R32F;
+        case tinygl::texture::internal_format::gl_rg32f: return GL_RG32F;
+        case tinygl::texture::internal_format::gl_rgb32f: return GL_RGB32F;
+        case tinygl::texture::internal_format::gl_rgba32f: return GL_RGBA32F;
+        case tinygl::texture::internal_format::gl_r11f_g11f_b10f: return GL_R11F_G11F_B10F;
+        case tinygl::texture::internal_format::gl_rgb9_e5: return GL_RGB9_E5;
+        case tinygl::texture::internal_format::gl_r8i: return GL_R8I;
+        case tinygl::texture::internal_format::gl_r8ui: return GL_R8UI;
+        case tinygl::texture::internal_format::gl_r16i: return GL_R16I;
+        case tinygl::texture::internal_format::gl_r16ui: return GL_R16UI;
+        case tinygl::texture::internal_format::gl_r32i: return GL_R32I;
+        case tinygl::texture::internal_format::gl_r32ui: return GL_R32UI;
+        case tinygl::texture::internal_format::gl_rg8i: return GL_RG8I;
+        case tinygl::texture::internal_format::gl_rg8ui: return GL_RG8UI;
+        case tinygl::texture::internal_format::gl_rg16i: return GL_RG16I;
+        case tinygl::texture::internal_format::gl_rg16ui: return GL_RG16UI;
+        case tinygl::texture::internal_format::gl_rg32i: return GL_RG32I;
+        case tinygl::texture::internal_format::gl_rg32ui: return GL_RG32UI;
+        case tinygl::texture::internal_format::gl_rgb8i: return GL_RGB8I;
+        case tinygl::texture::internal_format::gl_rgb8ui: return GL_RGB8UI;
+        case tinygl::texture::internal_format::gl_rgb16i: return GL_RGB16I;
+        case tinygl::texture::internal_format::gl_rgb16ui: return GL_RGB16UI;
+        case tinygl::texture::internal_format::gl_rgb32i: return GL_RGB32I;
+        case tinygl::texture::internal_format::gl_rgb32ui: return GL_RGB32UI;
+        case tinygl::texture::internal_format::gl_rgba8i: return GL_RGBA8I;
+        case tinygl::texture::internal_format::gl_rgba8ui: return GL_RGBA8UI;
+        case tinygl::texture::internal_format::gl_rgba16i: return GL_RGBA16I;
+        case tinygl::texture::internal_format::gl_rgba16ui: return GL_RGBA16UI;
+        case tinygl::texture::internal_format::gl_rgba32i: return GL_RGBA32I;
+        case tinygl::texture::internal_format::gl_rgba32ui: return GL_RGBA32UI;
+        case tinygl::texture::internal_format::gl_compressed_red: return GL_COMPRESSED_RED;
+        case tinygl::texture::internal_format::gl_compressed_rg: return GL_COMPRESSED_RG;
+        case tinygl::texture::internal_format::gl_compressed_rgb: return GL_COMPRESSED_RGB;
+        case tinygl::texture::internal_format::gl_compressed_rgba: return GL_COMPRESSED_RGBA;
+        case tinygl::texture::internal_format::gl_compressed_srgb: return GL_COMPRESSED_SRGB;
+        case tinygl::texture::internal_format::gl_compressed_srgb_alpha: return GL_COMPRESSED_SRGB_ALPHA;
+        case tinygl::texture::internal_format::gl_compressed_red_rgtc1: return GL_COMPRESSED_RED_RGTC1;
+        case tinygl::texture::internal_format::gl_compressed_signed_red_rgtc1: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+        case tinygl::texture::internal_format::gl_compressed_rg_rgtc2: return GL_COMPRESSED_RG_RGTC2;
+        case tinygl::texture::internal_format::gl_compressed_signed_rg_rgtc2: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+        case tinygl::texture::internal_format::gl_compressed_rgba_bptc_unorm: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case tinygl::texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        case tinygl::texture::internal_format::gl_compressed_rgb_bptc_signed_float: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+        case tinygl::texture::internal_format::gl_compressed_rgb_bptc_unsigned_float: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+        case tinygl::texture::internal_format::gl_compressed_rgb_s3tc_dxt1_ext: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case tinygl::texture::internal_format::gl_compressed_rgba_s3tc_dxt1_ext: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case tinygl::texture::internal_format::gl_compressed_rgba_s3tc_dxt3_ext: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case tinygl::texture::internal_format::gl_compressed_rgba_s3tc_dxt5_ext: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case tinygl::texture::internal_format::gl_compressed_srgb_s3tc_dxt1_ext: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case tinygl::texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt1_ext: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case tinygl::texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt3_ext: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+        case tinygl::texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt5_ext: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case tinygl::texture::internal_format::gl_depth_component16: return GL_DEPTH_COMPONENT16;
+        case tinygl::texture::internal_format::gl_depth_component24: return GL_DEPTH_COMPONENT24;
+        case tinygl::texture::internal_format::gl_depth_component32f: return GL_DEPTH_COMPONENT32F;
+        case tinygl::texture::internal_format::gl_depth24_stencil8: return GL_DEPTH24_STENCIL8;
+        case tinygl::texture::internal_format::gl_depth32f_stencil8: return GL_DEPTH32F_STENCIL8;
+        }
+    }
+
+    inline constexpr GLenum gl_enum(tinygl::texture::format format)
+    {
+        switch(format) {
+        case tinygl::texture::format::gl_red: return GL_RED;
+        case tinygl::texture::format::gl_rg: return GL_RG;
+        case tinygl::texture::format::gl_rgb: return GL_RGB;
+        case tinygl::texture::format::gl_bgr: return GL_BGR;
+        case tinygl::texture::format::gl_rgba: return GL_RGBA;
+        case tinygl::texture::format::gl_bgra: return GL_BGRA;
+        case tinygl::texture::format::gl_red_integer: return GL_RED_INTEGER;
+        case tinygl::texture::format::gl_rg_integer: return GL_RG_INTEGER;
+        case tinygl::texture::format::gl_rgb_integer: return GL_RGB_INTEGER;
+        case tinygl::texture::format::gl_bgr_integer: return GL_BGR_INTEGER;
+        case tinygl::texture::format::gl_rgba_integer: return GL_RGBA_INTEGER;
+        case tinygl::texture::format::gl_bgra_integer: return GL_BGRA_INTEGER;
+        case tinygl::texture::format::gl_stencil_index: return GL_STENCIL_INDEX;
+        case tinygl::texture::format::gl_depth_component: return GL_DEPTH_COMPONENT;
+        case tinygl::texture::format::gl_depth_stencil: return GL_DEPTH_STENCIL;
+        }
+    }
+
+    struct texel_block
+    {
+        GLsizei width;
+        GLsizei height;
+        std::size_t bytes;
+    };
+
+    // Storage of one pixel, or of one block for compressed formats. 3 channel formats count like 4 channel ones,
+    // drivers pad them; the sizes of unsized and generic compressed formats are estimates.
+    inline constexpr texel_block block(tinygl::texture::internal_format internal_format)
+    {
+        using tinygl::texture;
+        switch(internal_format) {
+        case texture::internal_format::gl_red:
+        case texture::internal_format::gl_r8:
+        case texture::internal_format::gl_r8_snorm:
+        case texture::internal_format::gl_r3_g3_b2:
+        case texture::internal_format::gl_rgba2:
+        case texture::internal_format::gl_r8i:
+        case texture::internal_format::gl_r8ui:
+            return {1, 1, 1};
+        case texture::internal_format::gl_rg:
+        case texture::internal_format::gl_r16:
+        case texture::internal_format::gl_r16_snorm:
+        case texture::internal_format::gl_rg8:
+        case texture::internal_format::gl_rg8_snorm:
+        case texture::internal_format::gl_rgb4:
+        case texture::internal_format::gl_rgb5:
+        case texture::internal_format::gl_rgba4:
+        case texture::internal_format::gl_rgb5_a1:
+        case texture::internal_format::gl_r16f:
+        case texture::internal_format::gl_r16i:
+        case texture::internal_format::gl_r16ui:
+        case texture::internal_format::gl_rg8i:
+        case texture::internal_format::gl_rg8ui:
+        case texture::internal_format::gl_depth_component16:
+            return {1, 1, 2};
+        case texture::internal_format::gl_depth_component:
+        case texture::internal_format::gl_depth_stencil:
+        case texture::internal_format::gl_rgb:
+        case texture::internal_format::gl_rgba:
+        case texture::internal_format::gl_rg16:
+        case texture::internal_format::gl_rg16_snorm:
+        case texture::internal_format::gl_rgb8:
+        case texture::internal_format::gl_rgb8_snorm:
+        case texture::internal_format::gl_rgb10:
+        case texture::internal_format::gl_rgba8:
+        case texture::internal_format::gl_rgba8_snorm:
+        case texture::internal_format::gl_rgb10_a2:
+        case texture::internal_format::gl_rgb10_a2ui:
+        case texture::internal_format::gl_srgb8:
+        case texture::internal_format::gl_srgb8_alpha8:
+        case texture::internal_format::gl_rg16f:
+        case texture::internal_format::gl_r32f:
+        case texture::internal_format::gl_r11f_g11f_b10f:
+        case texture::internal_format::gl_rgb9_e5:
+        case texture::internal_format::gl_r32i:
+        case texture::internal_format::gl_r32ui:
+        case texture::internal_format::gl_rg16i:
+        case texture::internal_format::gl_rg16ui:
+        case texture::internal_format::gl_rgb8i:
+        case texture::internal_format::gl_rgb8ui:
+        case texture::internal_format::gl_rgba8i:
+        case texture::internal_format::gl_rgba8ui:
+        case texture::internal_format::gl_depth_component24:
+        case texture::internal_format::gl_depth_component32f:
+        case texture::internal_format::gl_depth24_stencil8:
+            return {1, 1, 4};
+        case texture::internal_format::gl_rgb12:
+        case texture::internal_format::gl_rgb16_snorm:
+        case texture::internal_format::gl_rgba12:
+        case texture::internal_format::gl_rgba16:
+        case texture::internal_format::gl_rgb16f:
+        case texture::internal_format::gl_rgba16f:
+        case texture::internal_format::gl_rg32f:
+        case texture::internal_format::gl_rg32i:
+        case texture::internal_format::gl_rg32ui:
+        case texture::internal_format::gl_rgb16i:
+        case texture::internal_format::gl_rgb16ui:
+        case texture::internal_format::gl_rgba16i:
+        case texture::internal_format::gl_rgba16ui:
+        case texture::internal_format::gl_depth32f_stencil8:
+            return {1, 1, 8};
+        case texture::internal_format::gl_rgb32f:
+        case texture::internal_format::gl_rgba32f:
+        case texture::internal_format::gl_rgb32i:
+        case texture::internal_format::gl_rgb32ui:
+        case texture::internal_format::gl_rgba32i:
+        case texture::internal_format::gl_rgba32ui:
+            return {1, 1, 16};
+        case texture::internal_format::gl_compressed_red_rgtc1:
+        case texture::internal_format::gl_compressed_signed_red_rgtc1:
+        case texture::internal_format::gl_compressed_rgb_s3tc_dxt1_ext:
+        case texture::internal_format::gl_compressed_rgba_s3tc_dxt1_ext:
+        case texture::internal_format::gl_compressed_srgb_s3tc_dxt1_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt1_ext:
+            return {4, 4, 8};
+        case texture::internal_format::gl_compressed_red:
+        case texture::internal_format::gl_compressed_rg:
+        case texture::internal_format::gl_compressed_rgb:
+        case texture::internal_format::gl_compressed_rgba:
+        case texture::internal_format::gl_compressed_srgb:
+        case texture::internal_format::gl_compressed_srgb_alpha:
+        case texture::internal_format::gl_compressed_rg_rgtc2:
+        case texture::internal_format::gl_compressed_signed_rg_rgtc2:
+        case texture::internal_format::gl_compressed_rgba_bptc_unorm:
+        case texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm:
+        case texture::internal_format::gl_compressed_rgb_bptc_signed_float:
+        case texture::internal_format::gl_compressed_rgb_bptc_unsigned_float:
+        case texture::internal_format::gl_compressed_rgba_s3tc_dxt3_ext:
+        case texture::internal_format::gl_compressed_rgba_s3tc_dxt5_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt3_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt5_ext:
+            return {4, 4, 16};
+        }
+    }
+
+    inline constexpr bool compressed(tinygl::texture::internal_format internal_format)
+    {
+        return block(internal_format).width > 1;
+    }
+
+    // The sized format glTexStorage*() allocates for a base internal format. Generic compressed formats leave the
+    // choice to the driver and have none, they come back unchanged.
+    inline constexpr tinygl::texture::internal_format sized(tinygl::texture::internal_format internal_format)
+    {
+        using tinygl::texture;
+        switch (internal_format) {
+        case texture::internal_format::gl_depth_component: return texture::internal_format::gl_depth_component24;
+        case texture::internal_format::gl_depth_stencil: return texture::internal_format::gl_depth24_stencil8;
+        case texture::internal_format::gl_red: return texture::internal_format::gl_r8;
+        case texture::internal_format::gl_rg: return texture::internal_format::gl_rg8;
+        case texture::internal_format::gl_rgb: return texture::internal_format::gl_rgb8;
+        case texture::internal_format::gl_rgba: return texture::internal_format::gl_rgba8;
+        default: return internal_format;
+        }
+    }
+
+    inline constexpr bool generic_compressed(tinygl::texture::internal_format internal_format)
+    {
+        using tinygl::texture;
+        switch (internal_format) {
+        case texture::internal_format::gl_compressed_red:
+        case texture::internal_format::gl_compressed_rg:
+        case texture::internal_format::gl_compressed_rgb:
+        case texture::internal_format::gl_compressed_rgba:
+        case texture::internal_format::gl_compressed_srgb:
+        case texture::internal_format::gl_compressed_srgb_alpha:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Channels of 8-bit colour pixels in `format`, 0 for integer, depth and stencil formats.
+    inline constexpr int channel_count(tinygl::texture::format format)
+    {
+        using tinygl::texture;
+        switch (format) {
+        case texture::format::gl_red: return 1;
+        case texture::format::gl_rg: return 2;
+        case texture::format::gl_rgb:
+        case texture::format::gl_bgr: return 3;
+        case texture::format::gl_rgba:
+        case texture::format::gl_bgra: return 4;
+        default: return 0;
+        }
+    }
+
+    inline constexpr bool srgb(tinygl::texture::internal_format internal_format)
+    {
+        using tinygl::texture;
+        switch (internal_format) {
+        case texture::internal_format::gl_srgb8:
+        case texture::internal_format::gl_srgb8_alpha8:
+        case texture::internal_format::gl_compressed_srgb:
+        case texture::internal_format::gl_compressed_srgb_alpha:
+        case texture::internal_format::gl_compressed_srgb_alpha_bptc_unorm:
+        case texture::internal_format::gl_compressed_srgb_s3tc_dxt1_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt1_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt3_ext:
+        case texture::internal_format::gl_compressed_srgb_alpha_s3tc_dxt5_ext:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    inline constexpr std::size_t image_size(
+        tinygl::texture::internal_format internal_format, GLsizei width, GLsizei height, GLsizei depth = 1)
+    {
+        auto [block_width, block_height, bytes] = block(internal_format);
+        auto columns = static_cast<std::size_t>((width + block_width - 1) / block_width);
+        auto rows = static_cast<std::size_t>((height + block_height - 1) / block_height);
+        return columns * rows * static_cast<std::size_t>(depth) * bytes;
+    }
+
+    // Bytes of `levels` mip levels of a 2D texture or 2D array with `layers` layers.
+    inline constexpr std::size_t storage_size(tinygl::texture::internal_format internal_format, GLsizei width,
+                                              GLsizei height, GLsizei layers, GLsizei levels)
+    {
+        std::size_t size = 0;
+        for (GLsizei level = 0; level < levels; ++level) {
+            size += image_size(internal_format, std::max(width >> level, 1), std::max(height >> level, 1), layers);
+        }
+        return size;
+    }
+}
+
+#endif // TINYGL_TEXTURE_UTILS_H
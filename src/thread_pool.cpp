@@ -0,0 +1,84 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+tinygl::utils::thread_pool::thread_pool(std::size_t thread_count, std::size_t max_queued) :
+        max_queued{std::max<std::size_t>(max_queued, 1)}
+{
+    thread_count = std::max<std::size_t>(thread_count, 1);
+    threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([this] { work(); });
+    }
+}
+
+tinygl::utils::thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    task_available.notify_all();
+    task_done.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool tinygl::utils::thread_pool::try_submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock{mutex};
+        if (tasks.size() >= max_queued) {
+            return false;
+        }
+        tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+    return true;
+}
+
+void tinygl::utils::thread_pool::submit(std::function<void()> task)
+{
+    {
+        std::unique_lock lock{mutex};
+        task_done.wait(lock, [this] { return tasks.size() < max_queued || stopping; });
+        tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void tinygl::utils::thread_pool::wait_idle()
+{
+    std::unique_lock lock{mutex};
+    task_done.wait(lock, [this] { return tasks.empty() && running == 0; });
+}
+
+std::size_t tinygl::utils::thread_pool::thread_count() const
+{
+    return threads.size();
+}
+
+void tinygl::utils::thread_pool::work()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex};
+            task_available.wait(lock, [this] { return !tasks.empty() || stopping; });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            ++running;
+        }
+        // A queue slot was freed for submit().
+        task_done.notify_all();
+        task();
+        {
+            std::lock_guard lock{mutex};
+            --running;
+        }
+        task_done.notify_all();
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef TINYGL_THREAD_POOL_H
+#define TINYGL_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tinygl::utils {
+    /**
+     * Fixed set of worker threads draining a FIFO task queue. The queue can be bounded, so producers that must
+     * never block (e.g. the render thread) can use try_submit() and drop work instead.
+     */
+    class thread_pool final
+    {
+    public:
+        explicit thread_pool(
+            std::size_t thread_count = std::thread::hardware_concurrency(),
+            std::size_t max_queued = std::numeric_limits<std::size_t>::max());
+        // Finishes the queued tasks before joining the workers.
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        bool try_submit(std::function<void()> task);
+        void submit(std::function<void()> task);
+
+        // Blocks until the queue is empty and no task is running.
+        void wait_idle();
+
+        std::size_t thread_count() const;
+
+    private:
+        void work();
+
+        std::mutex mutex;
+        std::condition_variable task_available;
+        std::condition_variable task_done;
+        std::deque<std::function<void()>> tasks;
+        std::size_t max_queued;
+        std::size_t running = 0;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+    };
+}
+
+#endif // TINYGL_THREAD_POOL_H
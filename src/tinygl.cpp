@@ -1,7 +1,9 @@
 #include <GL/glew.h>
 
 #include "tinygl/tinygl.h"
+#include "state_cache.h"
 #include "utils.h"
+#include "validation.h"
 #include <stdexcept>
 
 namespace {
@@ -33,45 +35,6 @@ namespace {
         }
     }
 
-    constexpr GLenum gl_enum(tinygl::capability capability)
-    {
-        switch(capability) {
-        case tinygl::capability::gl_blend: return GL_BLEND;
-        case tinygl::capability::gl_clip_distance0: return GL_CLIP_DISTANCE0;
-        case tinygl::capability::gl_clip_distance1: return GL_CLIP_DISTANCE1;
-        case tinygl::capability::gl_clip_distance2: return GL_CLIP_DISTANCE2;
-        case tinygl::capability::gl_clip_distance3: return GL_CLIP_DISTANCE3;
-        case tinygl::capability::gl_clip_distance4: return GL_CLIP_DISTANCE4;
-        case tinygl::capability::gl_clip_distance5: return GL_CLIP_DISTANCE5;
-        case tinygl::capability::gl_color_logic_op: return GL_COLOR_LOGIC_OP;
-        case tinygl::capability::gl_cull_face: return GL_CULL_FACE;
-        case tinygl::capability::gl_debug_output: return GL_DEBUG_OUTPUT;
-        case tinygl::capability::gl_debug_output_synchronous: return GL_DEBUG_OUTPUT_SYNCHRONOUS;
-        case tinygl::capability::gl_depth_clamp: return GL_DEPTH_CLAMP;
-        case tinygl::capability::gl_depth_test: return GL_DEPTH_TEST;
-        case tinygl::capability::gl_dither: return GL_DITHER;
-        case tinygl::capability::gl_framebuffer_srgb: return GL_FRAMEBUFFER_SRGB;
-        case tinygl::capability::gl_line_smooth: return GL_LINE_SMOOTH;
-        case tinygl::capability::gl_multisample: return GL_MULTISAMPLE;
-        case tinygl::capability::gl_polygon_offset_fill: return GL_POLYGON_OFFSET_FILL;
-        case tinygl::capability::gl_polygon_offset_line: return GL_POLYGON_OFFSET_LINE;
-        case tinygl::capability::gl_polygon_offset_point: return GL_POLYGON_OFFSET_POINT;
-        case tinygl::capability::gl_polygon_smooth: return GL_POLYGON_SMOOTH;
-        case tinygl::capability::gl_primitive_restart: return GL_PRIMITIVE_RESTART;
-        case tinygl::capability::gl_primitive_restart_fixed_index: return GL_PRIMITIVE_RESTART_FIXED_INDEX;
-        case tinygl::capability::gl_rasterizer_discard: return GL_RASTERIZER_DISCARD;
-        case tinygl::capability::gl_sample_alpha_to_coverage: return GL_SAMPLE_ALPHA_TO_COVERAGE;
-        case tinygl::capability::gl_sample_alpha_to_one: return GL_SAMPLE_ALPHA_TO_ONE;
-        case tinygl::capability::gl_sample_coverage: return GL_SAMPLE_COVERAGE;
-        case tinygl::capability::gl_sample_shading: return GL_SAMPLE_SHADING;
-        case tinygl::capability::gl_sample_mask: return GL_SAMPLE_MASK;
-        case tinygl::capability::gl_scissor_test: return GL_SCISSOR_TEST;
-        case tinygl::capability::gl_stencil_test: return GL_STENCIL_TEST;
-        case tinygl::capability::gl_texture_cube_map_seamless: return GL_TEXTURE_CUBE_MAP_SEAMLESS;
-        case tinygl::capability::gl_program_point_size: return GL_PROGRAM_POINT_SIZE;
-        }
-    }
-
     constexpr GLenum gl_enum(tinygl::depth_func depth_func)
     {
         switch (depth_func) {
@@ -87,52 +50,80 @@ namespace {
     }
 }
 
-void tinygl::gl_clear_color(const tinygl::color& color)
+void tinygl::gl_clear_color(const tinygl::color& color, std::source_location call_site)
 {
     glClearColor(color.r, color.g, color.b, color.a);
+    validation::check(call_site);
 }
 
-void tinygl::gl_clear(buffer_bit buffer_bit)
+void tinygl::gl_clear(buffer_bit buffer_bit, std::source_location call_site)
 {
     glClear(static_cast<GLenum>(buffer_bit));
+    validation::check(call_site);
 }
 
-void tinygl::gl_point_size(float size)
+void tinygl::gl_point_size(float size, std::source_location call_site)
 {
     glPointSize(size);
+    validation::check(call_site);
 }
 
-void tinygl::gl_draw_arrays(mode mode, std::int32_t first, std::int32_t count)
+void tinygl::gl_draw_arrays(mode mode, std::int32_t first, std::int32_t count, std::source_location call_site)
 {
     glDrawArrays(gl_enum(mode), first, count);
+    validation::check(call_site);
 }
 
-void tinygl::gl_draw_arrays_instanced(mode mode, std::int32_t first, std::int32_t count, std::int32_t instance_count)
+void tinygl::gl_draw_arrays_instanced(mode mode, std::int32_t first, std::int32_t count, std::int32_t instance_count,
+                                      std::source_location call_site)
 {
     glDrawArraysInstanced(gl_enum(mode), first, count, instance_count);
+    validation::check(call_site);
 }
 
-void tinygl::gl_draw_elements(mode mode, std::int32_t count, data_type type, const void* indices)
+void tinygl::gl_draw_elements(mode mode, std::int32_t count, data_type type, const void* indices,
+                              std::source_location call_site)
 {
     glDrawElements(gl_enum(mode), count, utils::gl_enum(type), indices);
+    validation::check(call_site);
+}
+
+void tinygl::gl_enable(capability capability, std::source_location call_site)
+{
+    state_cache::set_enabled(capability, true);
+    validation::check(call_site);
 }
 
-void tinygl::gl_enable(capability capability)
+void tinygl::gl_disable(capability capability, std::source_location call_site)
 {
-    glEnable(gl_enum(capability));
+    state_cache::set_enabled(capability, false);
+    validation::check(call_site);
 }
 
-void tinygl::gl_depth_func(depth_func depth_func)
+void tinygl::invalidate_state_cache()
+{
+    state_cache::invalidate();
+}
+
+void tinygl::gl_depth_func(depth_func depth_func, std::source_location call_site)
 {
     glDepthFunc(gl_enum(depth_func));
+    validation::check(call_site);
 }
 
-void tinygl::init(int major, int minor)
+void tinygl::init(int major, int minor, context_flag flags)
 {
+    const bool headless = (flags & context_flag::headless) == context_flag::headless;
+    if (headless) {
+        // The null platform needs no display server; windows are never shown and
+        // contexts come from EGL (surfaceless) or, as a fallback, OSMesa.
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    } else {
 #if defined(__linux__)
-    // Force GLFW to bypass Wayland and use X11
-    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
+        // Force GLFW to bypass Wayland and use X11
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
 #endif
+    }
 
     if (!glfwInit()) {
         throw std::runtime_error("glfwInit() failed!");
@@ -141,19 +132,34 @@ void tinygl::init(int major, int minor)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    } else {
 #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
 #else
-    auto* monitor = glfwGetPrimaryMonitor();
-    float xscale, yscale;
-    glfwGetMonitorContentScale(monitor, &xscale, &yscale);
-    if (xscale > 1.0f || yscale > 1.0f) {
-        glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
-    }
+        auto* monitor = glfwGetPrimaryMonitor();
+        float xscale, yscale;
+        glfwGetMonitorContentScale(monitor, &xscale, &yscale);
+        if (xscale > 1.0f || yscale > 1.0f) {
+            glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
+        }
 #endif
+    }
+    // A context cannot be both a debug and a no-error one.
+    if ((flags & context_flag::no_error) == context_flag::no_error) {
+        glfwWindowHint(GLFW_CONTEXT_NO_ERROR, GLFW_TRUE);
+    } else {
 #ifndef NDEBUG
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 #endif
+    }
+}
+
+bool tinygl::headless()
+{
+    return glfwGetPlatform() == GLFW_PLATFORM_NULL;
 }
 
 void tinygl::terminate()
@@ -180,11 +186,12 @@ const char* tinygl::get_string(name name)
     return reinterpret_cast<const char*>(glGetString(gl_enum(name)));
 }
 
-void tinygl::check_opengl_errors()
+void tinygl::check_opengl_errors(std::source_location location)
 {
-    auto error = glGetError();
-    while (error != GL_NO_ERROR) {
-        std::cerr << "OpenGL error: " << error << '\n';
-        error = glGetError();
-    }
+    validation::report_errors(location);
+}
+
+void tinygl::set_validation_enabled(bool enabled)
+{
+    validation::set_enabled(enabled);
 }
@@ -0,0 +1,49 @@
+#include "validation.h"
+#include <GL/glew.h>
+#include <spdlog/spdlog.h>
+#include <atomic>
+
+namespace {
+    std::atomic<bool> validation_enabled{true};
+
+    constexpr const char* error_string(GLenum error)
+    {
+        switch (error) {
+        case GL_INVALID_ENUM: return "GL_INVALID_ENUM";
+        case GL_INVALID_VALUE: return "GL_INVALID_VALUE";
+        case GL_INVALID_OPERATION: return "GL_INVALID_OPERATION";
+        case GL_STACK_OVERFLOW: return "GL_STACK_OVERFLOW";
+        case GL_STACK_UNDERFLOW: return "GL_STACK_UNDERFLOW";
+        case GL_OUT_OF_MEMORY: return "GL_OUT_OF_MEMORY";
+        case GL_INVALID_FRAMEBUFFER_OPERATION: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case GL_CONTEXT_LOST: return "GL_CONTEXT_LOST";
+        default: return "unknown error";
+        }
+    }
+}
+
+#ifdef TINYGL_VALIDATION
+void tinygl::validation::check(std::source_location location)
+{
+    if (validation_enabled.load(std::memory_order_relaxed)) {
+        report_errors(location);
+    }
+}
+#endif
+
+void tinygl::validation::set_enabled(bool enabled)
+{
+    validation_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void tinygl::validation::report_errors(std::source_location location)
+{
+    for (auto error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+        spdlog::error(
+            "[tinygl] OpenGL error {} (0x{:04X}) in {} ({}:{})",
+            error_string(error), error, location.function_name(), location.file_name(), location.line());
+        if (error == GL_CONTEXT_LOST) {
+            break;
+        }
+    }
+}
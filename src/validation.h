@@ -0,0 +1,29 @@
+#ifndef TINYGL_VALIDATION_H
+#define TINYGL_VALIDATION_H
+
+#include <source_location>
+
+// Validation is compiled in for debug builds only. Define TINYGL_NO_VALIDATION to strip it from debug builds too.
+#if !defined(NDEBUG) && !defined(TINYGL_NO_VALIDATION)
+#define TINYGL_VALIDATION 1
+#endif
+
+namespace tinygl::validation {
+    /**
+     * Drains `glGetError` and reports every error together with `location`. Public entry points take the caller's
+     * location as a defaulted last parameter and pass it on, so reports name the user's call site.
+     * In release builds this is an empty inline function, so the calls sprinkled through tinygl compile to nothing.
+     */
+#ifdef TINYGL_VALIDATION
+    void check(std::source_location location = std::source_location::current());
+#else
+    inline void check([[maybe_unused]] std::source_location location = std::source_location::current()) {}
+#endif
+
+    // Turned off at runtime for KHR_no_error contexts, where `glGetError` carries no information.
+    void set_enabled(bool enabled);
+
+    void report_errors(std::source_location location);
+}
+
+#endif // TINYGL_VALIDATION_H
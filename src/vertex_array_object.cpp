@@ -1,5 +1,7 @@
 #include "tinygl/vertex_array_object.h"
+#include "state_cache.h"
 #include "utils.h"
+#include "validation.h"
 #include <stdexcept>
 
 namespace {
@@ -24,6 +26,7 @@ tinygl::vertex_array_object::vertex_array_object_private::vertex_array_object_pr
 
 tinygl::vertex_array_object::vertex_array_object_private::~vertex_array_object_private()
 {
+    state_cache::forget_vertex_array(id);
     glDeleteVertexArrays(1, &id);
 }
 
@@ -44,24 +47,27 @@ tinygl::vertex_array_object& tinygl::vertex_array_object::operator=(vertex_array
     return *this;
 }
 
-void tinygl::vertex_array_object::bind()
+void tinygl::vertex_array_object::bind(std::source_location call_site)
 {
     if (!p->id) {
         throw std::runtime_error("tinygl::vertex_array_object::bind(): vao not created!");
     }
-    glBindVertexArray(p->id);
+    state_cache::bind_vertex_array(p->id);
+    validation::check(call_site);
 }
 
-void tinygl::vertex_array_object::unbind()
+void tinygl::vertex_array_object::unbind(std::source_location call_site)
 {
     if (!p->id) {
         throw std::runtime_error("tinygl::vertex_array_object::unbind(): vao not created!");
     }
-    glBindVertexArray(0);
+    state_cache::bind_vertex_array(0);
+    validation::check(call_site);
 }
 
 void tinygl::vertex_array_object::set_attribute_array(
-        int location, int tuple_size, data_type type, normalization normalization, int stride, int offset)
+        int location, int tuple_size, data_type type, normalization normalization, int stride, int offset,
+        std::source_location call_site)
 {
     /**
      * Here we have to convert the last parameter from `int` to `void*` to send it to `glVertexAttribPointer`.
@@ -85,10 +91,12 @@ void tinygl::vertex_array_object::set_attribute_array(
 #pragma warning(disable: 4312) // possible loss of data
 #endif
     glVertexAttribPointer(location, tuple_size, utils::gl_enum(type), gl_boolean(normalization), stride, reinterpret_cast<void*>(offset));
+    validation::check(call_site);
 }
 
-void tinygl::vertex_array_object::enable_attribute_array(int location)
+void tinygl::vertex_array_object::enable_attribute_array(int location, std::source_location call_site)
 {
     glEnableVertexAttribArray(location);
+    validation::check(call_site);
 }
 
@@ -2,65 +2,103 @@
 
 #include "tinygl/tinygl.h"
 #include "tinygl/window.h"
+#include "tinygl/debug_output.h"
+#include "tinygl/frame_capture.h"
+#include "tinygl/frame_stats.h"
+#include "tinygl/render_target.h"
+#include "debug_callback.h"
+#include "font_cache.h"
+#include "imgui_renderer.h"
+#include "state_cache.h"
+#include "spsc_ring.h"
 
 #include "imgui.h"
 #include "imgui/backends/imgui_impl_glfw.h"
-#include "imgui/backends/imgui_impl_opengl3.h"
+#include "validation.h"
 
 #include <spdlog/spdlog.h>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <utility>
+#include <vector>
 
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-
-static const std::map<GLenum, std::string> gl_debug_source = {
-    { GL_DEBUG_SOURCE_API            , "API"             },
-    { GL_DEBUG_SOURCE_WINDOW_SYSTEM  , "Window System"   },
-    { GL_DEBUG_SOURCE_SHADER_COMPILER, "Shader Compiler" },
-    { GL_DEBUG_SOURCE_THIRD_PARTY    , "Third Party"     },
-    { GL_DEBUG_SOURCE_APPLICATION    , "Application"     },
-    { GL_DEBUG_SOURCE_OTHER          , "Other"           }
-};
-
-static const std::map<GLenum, std::string> gl_debug_type = {
-    { GL_DEBUG_TYPE_ERROR              , "Error"               },
-    { GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR, "Deprecated Behavior" },
-    { GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR , "Undefined Behavior"  },
-    { GL_DEBUG_TYPE_PORTABILITY        , "Portability"         },
-    { GL_DEBUG_TYPE_PERFORMANCE        , "Performance"         },
-    { GL_DEBUG_TYPE_MARKER             , "Marker"              },
-    { GL_DEBUG_TYPE_PUSH_GROUP         , "Push Group"          },
-    { GL_DEBUG_TYPE_POP_GROUP          , "Pop Group"           },
-    { GL_DEBUG_TYPE_OTHER              , "Other"               }
-};
-
-static const std::map<GLenum, std::string> gl_debug_severity = {
-    { GL_DEBUG_SEVERITY_HIGH        , "High"         },
-    { GL_DEBUG_SEVERITY_MEDIUM      , "Medium"       },
-    { GL_DEBUG_SEVERITY_LOW         , "Low"          },
-    { GL_DEBUG_SEVERITY_NOTIFICATION, "Notification" }
-};
-
-void GLAPIENTRY gl_debug_output(
-        GLenum source,
-        GLenum type,
-        [[maybe_unused]] GLuint id,
-        GLenum severity,
-        [[maybe_unused]] GLsizei length,
-        const GLchar* message,
-        [[maybe_unused]] const void* user_param)
-{
-    std::cerr <<
-        "================================[ OpenGL error ]================================\n" <<
-        "Source: " << gl_debug_source.at(source) << '\n' <<
-        "Type: " << gl_debug_type.at(type) << '\n' <<
-        "Severity: " << gl_debug_severity.at(severity) << '\n' <<
-        "Message: " << message << '\n' <<
-        "================================[ Stack  Trace ]================================\n";
-    std::cerr <<
-        "================================================================================\n";
+namespace {
+    ImGuiKey to_imgui_key(int key)
+    {
+        if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) {
+            return static_cast<ImGuiKey>(ImGuiKey_0 + (key - GLFW_KEY_0));
+        }
+        if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) {
+            return static_cast<ImGuiKey>(ImGuiKey_A + (key - GLFW_KEY_A));
+        }
+        if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12) {
+            return static_cast<ImGuiKey>(ImGuiKey_F1 + (key - GLFW_KEY_F1));
+        }
+        if (key >= GLFW_KEY_KP_0 && key <= GLFW_KEY_KP_9) {
+            return static_cast<ImGuiKey>(ImGuiKey_Keypad0 + (key - GLFW_KEY_KP_0));
+        }
+        switch (key) {
+            case GLFW_KEY_TAB: return ImGuiKey_Tab;
+            case GLFW_KEY_LEFT: return ImGuiKey_LeftArrow;
+            case GLFW_KEY_RIGHT: return ImGuiKey_RightArrow;
+            case GLFW_KEY_UP: return ImGuiKey_UpArrow;
+            case GLFW_KEY_DOWN: return ImGuiKey_DownArrow;
+            case GLFW_KEY_PAGE_UP: return ImGuiKey_PageUp;
+            case GLFW_KEY_PAGE_DOWN: return ImGuiKey_PageDown;
+            case GLFW_KEY_HOME: return ImGuiKey_Home;
+            case GLFW_KEY_END: return ImGuiKey_End;
+            case GLFW_KEY_INSERT: return ImGuiKey_Insert;
+            case GLFW_KEY_DELETE: return ImGuiKey_Delete;
+            case GLFW_KEY_BACKSPACE: return ImGuiKey_Backspace;
+            case GLFW_KEY_SPACE: return ImGuiKey_Space;
+            case GLFW_KEY_ENTER: return ImGuiKey_Enter;
+            case GLFW_KEY_ESCAPE: return ImGuiKey_Escape;
+            case GLFW_KEY_APOSTROPHE: return ImGuiKey_Apostrophe;
+            case GLFW_KEY_COMMA: return ImGuiKey_Comma;
+            case GLFW_KEY_MINUS: return ImGuiKey_Minus;
+            case GLFW_KEY_PERIOD: return ImGuiKey_Period;
+            case GLFW_KEY_SLASH: return ImGuiKey_Slash;
+            case GLFW_KEY_SEMICOLON: return ImGuiKey_Semicolon;
+            case GLFW_KEY_EQUAL: return ImGuiKey_Equal;
+            case GLFW_KEY_LEFT_BRACKET: return ImGuiKey_LeftBracket;
+            case GLFW_KEY_BACKSLASH: return ImGuiKey_Backslash;
+            case GLFW_KEY_RIGHT_BRACKET: return ImGuiKey_RightBracket;
+            case GLFW_KEY_GRAVE_ACCENT: return ImGuiKey_GraveAccent;
+            case GLFW_KEY_CAPS_LOCK: return ImGuiKey_CapsLock;
+            case GLFW_KEY_SCROLL_LOCK: return ImGuiKey_ScrollLock;
+            case GLFW_KEY_NUM_LOCK: return ImGuiKey_NumLock;
+            case GLFW_KEY_PRINT_SCREEN: return ImGuiKey_PrintScreen;
+            case GLFW_KEY_PAUSE: return ImGuiKey_Pause;
+            case GLFW_KEY_KP_DECIMAL: return ImGuiKey_KeypadDecimal;
+            case GLFW_KEY_KP_DIVIDE: return ImGuiKey_KeypadDivide;
+            case GLFW_KEY_KP_MULTIPLY: return ImGuiKey_KeypadMultiply;
+            case GLFW_KEY_KP_SUBTRACT: return ImGuiKey_KeypadSubtract;
+            case GLFW_KEY_KP_ADD: return ImGuiKey_KeypadAdd;
+            case GLFW_KEY_KP_ENTER: return ImGuiKey_KeypadEnter;
+            case GLFW_KEY_KP_EQUAL: return ImGuiKey_KeypadEqual;
+            case GLFW_KEY_LEFT_SHIFT: return ImGuiKey_LeftShift;
+            case GLFW_KEY_LEFT_CONTROL: return ImGuiKey_LeftCtrl;
+            case GLFW_KEY_LEFT_ALT: return ImGuiKey_LeftAlt;
+            case GLFW_KEY_LEFT_SUPER: return ImGuiKey_LeftSuper;
+            case GLFW_KEY_RIGHT_SHIFT: return ImGuiKey_RightShift;
+            case GLFW_KEY_RIGHT_CONTROL: return ImGuiKey_RightCtrl;
+            case GLFW_KEY_RIGHT_ALT: return ImGuiKey_RightAlt;
+            case GLFW_KEY_RIGHT_SUPER: return ImGuiKey_RightSuper;
+            case GLFW_KEY_MENU: return ImGuiKey_Menu;
+            default: return ImGuiKey_None;
+        }
+    }
 }
 
 struct tinygl::window::window_private
@@ -68,29 +106,550 @@ struct tinygl::window::window_private
     GLFWwindow* window = nullptr;
     key_callback key_callback;
     mouse_button_callback mouse_button_callback;
-    float previous_time{};
-    float current_time{};
-    float delta_time{};
+    std::shared_ptr<tinygl::frame_capture> capture;
+    std::shared_ptr<tinygl::frame_stats> stats;
+    std::filesystem::path font_cache_directory = font_cache::default_directory();
+    double previous_time{};
+    double current_time{};
+    double delta_time{};
+
+    window::loop_mode mode = window::loop_mode::uncapped;
+    double frame_period = 1.0 / 60.0;
+    double next_frame_time{};
+    double fixed_timestep = 1.0 / 60.0;
+    int max_steps = 5;
+    double accumulator{};
+    std::atomic<bool> redraw_requested{false};
+    double redraw_timeout{};
+    int settle_frames{};
+
+    render_target_registry render_targets;
+    double resize_settle_time{};
+    double last_resize_time{};
+    bool resize_pending = false;
+
+    // Handed off from the event thread: written by the GLFW callbacks, read by whichever thread renders.
+    window::threading_mode threading = window::threading_mode::single;
+    std::thread::id event_thread = std::this_thread::get_id();
+    std::atomic<int> window_width{};
+    std::atomic<int> window_height{};
+    std::atomic<int> framebuffer_width{};
+    std::atomic<int> framebuffer_height{};
+    std::atomic<bool> resized{false};
+    std::atomic<double> cursor_x{};
+    std::atomic<double> cursor_y{};
+    std::array<std::atomic<std::uint8_t>, GLFW_KEY_LAST + 1> keys{};
+    std::atomic<int> pending_swap_interval{no_swap_interval};
+
+    // Filled by the GLFW callbacks, drained once per frame by poll_events().
+    utils::spsc_ring<input::event, 1024> events;
+    std::atomic<std::uint64_t> dropped_events{0};
+    std::uint64_t reported_dropped_events{};
+    input::snapshot current_input;
+    input::snapshot next_input;
+    std::uint64_t frame_number{};
+
+    std::mutex event_mutex;
+    std::condition_variable event_signal;
+    std::atomic<bool> render_waiting{false};
+    std::optional<std::string> pending_title;
+    std::atomic<bool> render_finished{false};
+
+    // Set up by start(), torn down by stop().
+    ImGuiContext* imgui_context = nullptr;
+    std::unique_ptr<imgui_renderer> renderer;
+    // Events reach Dear ImGui through dispatch() instead of its own GLFW callbacks.
+    bool forward_imgui_events = false;
+    // Dear ImGui's GLFW platform backend queries and sets cursors, input modes and gamepads, which GLFW only allows
+    // on the main thread. In threading_mode::render_thread it is left out and ImGuiIO is fed from the handed-off
+    // state instead.
+    bool imgui_glfw_backend = false;
+    // Driven by a window_group, which pumps the events of all windows itself.
+    bool grouped = false;
+
+    static constexpr int no_swap_interval = std::numeric_limits<int>::min();
+    // Requests adaptive vsync, which needs the context current to look up the swap_control_tear extensions.
+    static constexpr int adaptive_swap_interval = -1;
+
+    static window_private* from(GLFWwindow* window)
+    {
+        return static_cast<window_private*>(glfwGetWindowUserPointer(window));
+    }
+
+    static float monitor_content_scale();
+
+    bool render_thread() const { return threading == window::threading_mode::render_thread; }
+    void make_current();
+    void install_callbacks();
+    void push_event(input::event event);
+    void wake();
+    void apply(const input::event& event);
+    void dispatch(const input::event& event);
+    void feed_imgui(const input::event& event);
+    void new_imgui_frame();
+    // `pump` runs glfwPollEvents() first where this thread owns the event loop.
+    void poll_events(bool pump = true);
+    void publish_input();
+    void begin_frame();
+    static void apply_swap_interval(int interval);
+    void handle_resize(tinygl::window& owner);
+    void start(tinygl::window& owner, float content_scale, bool install_imgui_callbacks);
+    void render_frame(tinygl::window& owner);
+    void present();
+    void stop();
+    void render_loop(tinygl::window& owner, float content_scale);
+    void wait_for_next_frame();
+    void wait_for_events();
 };
 
-tinygl::window::window(int width, int height, std::string_view title, bool vsync) :
+float tinygl::window::window_private::monitor_content_scale()
+{
+    // Monitors may only be queried on the main thread.
+    auto content_scale = 1.0f;
+#ifndef __APPLE__
+    if (!tinygl::headless()) {
+        auto* monitor = glfwGetPrimaryMonitor();
+        float xscale, yscale;
+        glfwGetMonitorContentScale(monitor, &xscale, &yscale);
+        content_scale = xscale;
+    }
+#endif
+    return content_scale;
+}
+
+void tinygl::window::window_private::make_current()
+{
+    glfwMakeContextCurrent(window);
+    state_cache::make_current(window);
+}
+
+void tinygl::window::window_private::install_callbacks()
+{
+    // The user pointer is the private part, which stays put when the window is moved.
+    glfwSetWindowUserPointer(window, this);
+    glfwSetWindowSizeCallback(window, [](GLFWwindow* w, int width, int height) {
+        auto* p = from(w);
+        p->window_width.store(width);
+        p->window_height.store(height);
+    });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int width, int height) {
+        // The viewport is set on the render thread, see handle_resize().
+        auto* p = from(w);
+        p->framebuffer_width.store(width);
+        p->framebuffer_height.store(height);
+        p->resized.store(true);
+        p->push_event({.type = input::event_type::resize, .width = width, .height = height});
+        p->wake();
+    });
+    glfwSetWindowCloseCallback(window, [](GLFWwindow* w) {
+        from(w)->wake();
+    });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int key, int scancode, int action, int mods) {
+        auto* p = from(w);
+        if (key >= 0 && key <= GLFW_KEY_LAST) {
+            p->keys[key].store(action == GLFW_RELEASE ? GLFW_RELEASE : GLFW_PRESS);
+        }
+        p->push_event({
+            .type = input::event_type::key,
+            .key = static_cast<keyboard::key>(key),
+            .scancode = scancode,
+            .action = static_cast<input::action>(action),
+            .mods = static_cast<input::modifier>(mods)});
+    });
+    glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int codepoint) {
+        from(w)->push_event({.type = input::event_type::character, .codepoint = codepoint});
+    });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int button, int action, int mods) {
+        from(w)->push_event({
+            .type = input::event_type::mouse_button,
+            .button = static_cast<mouse::button>(button),
+            .action = static_cast<input::action>(action),
+            .mods = static_cast<input::modifier>(mods)});
+    });
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double x, double y) {
+        auto* p = from(w);
+        p->cursor_x.store(x);
+        p->cursor_y.store(y);
+        p->push_event({.type = input::event_type::cursor_pos, .x = x, .y = y});
+    });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int entered) {
+        from(w)->push_event({.type = input::event_type::cursor_enter, .entered = entered == GLFW_TRUE});
+    });
+    glfwSetScrollCallback(window, [](GLFWwindow* w, double x, double y) {
+        from(w)->push_event({.type = input::event_type::scroll, .x = x, .y = y});
+    });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int focused) {
+        from(w)->push_event({.type = input::event_type::focus, .entered = focused == GLFW_TRUE});
+    });
+}
+
+void tinygl::window::window_private::push_event(input::event event)
+{
+    event.time = tinygl::get_time<double>();
+    if (!events.try_push(event)) {
+        dropped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (render_thread()) {
+        // Pairs with the fence in wait_for_events(): either the render thread sees the event before it sleeps,
+        // or this thread sees it waiting and wakes it up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (render_waiting.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard lock{event_mutex};
+            }
+            event_signal.notify_one();
+        }
+    }
+}
+
+void tinygl::window::window_private::wake()
+{
+    {
+        std::lock_guard lock{event_mutex};
+        redraw_requested.store(true);
+    }
+    event_signal.notify_one();
+}
+
+void tinygl::window::window_private::apply(const input::event& event)
+{
+    auto& state = next_input;
+    switch (event.type) {
+        case input::event_type::key: {
+            auto index = static_cast<int>(event.key);
+            if (index >= 0 && index <= GLFW_KEY_LAST) {
+                state.keys.set(static_cast<std::size_t>(index), event.action != input::action::release);
+            }
+            state.mods = event.mods;
+            break;
+        }
+        case input::event_type::mouse_button:
+            state.buttons.set(static_cast<std::size_t>(event.button), event.action != input::action::release);
+            state.mods = event.mods;
+            break;
+        case input::event_type::cursor_pos:
+            state.cursor_x = event.x;
+            state.cursor_y = event.y;
+            break;
+        case input::event_type::scroll:
+            state.scroll_x += event.x;
+            state.scroll_y += event.y;
+            break;
+        case input::event_type::focus:
+            state.focused = event.entered;
+            break;
+        case input::event_type::resize:
+            state.framebuffer_width = event.width;
+            state.framebuffer_height = event.height;
+            break;
+        case input::event_type::character:
+        case input::event_type::cursor_enter:
+            break;
+    }
+    state.events.push_back(event);
+}
+
+void tinygl::window::window_private::dispatch(const input::event& event)
+{
+    // Dear ImGui installs its own callbacks, except when another thread or a window_group pumps the events.
+    auto forward = forward_imgui_events && imgui_glfw_backend && ImGui::GetCurrentContext();
+    if (!imgui_glfw_backend && ImGui::GetCurrentContext()) {
+        feed_imgui(event);
+    }
+    switch (event.type) {
+        case input::event_type::key:
+            if (forward) {
+                ImGui_ImplGlfw_KeyCallback(
+                    window, static_cast<int>(event.key), event.scancode, static_cast<int>(event.action),
+                    static_cast<int>(event.mods));
+            }
+            if (key_callback) {
+                key_callback(event.key, event.scancode, event.action, event.mods);
+            }
+            break;
+        case input::event_type::character:
+            if (forward) {
+                ImGui_ImplGlfw_CharCallback(window, event.codepoint);
+            }
+            break;
+        case input::event_type::mouse_button:
+            if (forward) {
+                ImGui_ImplGlfw_MouseButtonCallback(
+                    window, static_cast<int>(event.button), static_cast<int>(event.action),
+                    static_cast<int>(event.mods));
+            }
+            if (mouse_button_callback && !(ImGui::GetCurrentContext() && ImGui::GetIO().WantCaptureMouse)) {
+                mouse_button_callback(event.button, event.action, event.mods);
+            }
+            break;
+        case input::event_type::cursor_pos:
+            if (forward) {
+                ImGui_ImplGlfw_CursorPosCallback(window, event.x, event.y);
+            }
+            break;
+        case input::event_type::cursor_enter:
+            if (forward) {
+                ImGui_ImplGlfw_CursorEnterCallback(window, event.entered ? GLFW_TRUE : GLFW_FALSE);
+            }
+            break;
+        case input::event_type::scroll:
+            if (forward) {
+                ImGui_ImplGlfw_ScrollCallback(window, event.x, event.y);
+            }
+            break;
+        case input::event_type::focus:
+            if (forward) {
+                ImGui_ImplGlfw_WindowFocusCallback(window, event.entered ? GLFW_TRUE : GLFW_FALSE);
+            }
+            break;
+        case input::event_type::resize:
+            break;
+    }
+}
+
+void tinygl::window::window_private::feed_imgui(const input::event& event)
+{
+    auto& io = ImGui::GetIO();
+    // apply() has already run, so the key state includes this event; the GLFW backend asks glfwGetKey() instead.
+    auto held = [this](int left, int right) {
+        return next_input.keys.test(static_cast<std::size_t>(left)) ||
+               next_input.keys.test(static_cast<std::size_t>(right));
+    };
+    auto update_modifiers = [&] {
+        io.AddKeyEvent(ImGuiMod_Ctrl, held(GLFW_KEY_LEFT_CONTROL, GLFW_KEY_RIGHT_CONTROL));
+        io.AddKeyEvent(ImGuiMod_Shift, held(GLFW_KEY_LEFT_SHIFT, GLFW_KEY_RIGHT_SHIFT));
+        io.AddKeyEvent(ImGuiMod_Alt, held(GLFW_KEY_LEFT_ALT, GLFW_KEY_RIGHT_ALT));
+        io.AddKeyEvent(ImGuiMod_Super, held(GLFW_KEY_LEFT_SUPER, GLFW_KEY_RIGHT_SUPER));
+    };
+    switch (event.type) {
+        case input::event_type::key:
+            if (event.action == input::action::repeat) {
+                break;
+            }
+            update_modifiers();
+            io.AddKeyEvent(to_imgui_key(static_cast<int>(event.key)), event.action == input::action::press);
+            break;
+        case input::event_type::character:
+            io.AddInputCharacter(event.codepoint);
+            break;
+        case input::event_type::mouse_button: {
+            auto button = static_cast<int>(event.button);
+            if (button >= 0 && button < ImGuiMouseButton_COUNT) {
+                update_modifiers();
+                io.AddMouseButtonEvent(button, event.action == input::action::press);
+            }
+            break;
+        }
+        case input::event_type::cursor_pos:
+            io.AddMousePosEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case input::event_type::cursor_enter:
+            if (!event.entered) {
+                io.AddMousePosEvent(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+            }
+            break;
+        case input::event_type::scroll:
+            io.AddMouseWheelEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case input::event_type::focus:
+            io.AddFocusEvent(event.entered);
+            break;
+        case input::event_type::resize:
+            break;
+    }
+}
+
+void tinygl::window::window_private::new_imgui_frame()
+{
+    // What ImGui_ImplGlfw_NewFrame() does, from the sizes the event thread handed off.
+    auto& io = ImGui::GetIO();
+    auto width = window_width.load();
+    auto height = window_height.load();
+    io.DisplaySize = ImVec2{static_cast<float>(width), static_cast<float>(height)};
+    if (width > 0 && height > 0) {
+        io.DisplayFramebufferScale = ImVec2{
+            static_cast<float>(framebuffer_width.load()) / static_cast<float>(width),
+            static_cast<float>(framebuffer_height.load()) / static_cast<float>(height)};
+    }
+    io.DeltaTime = delta_time > 0.0 ? static_cast<float>(delta_time) : 1.0f / 60.0f;
+}
+
+void tinygl::window::window_private::poll_events(bool pump)
+{
+    if (pump && !render_thread() && !grouped) {
+        glfwPollEvents();
+    }
+    input::event event;
+    while (events.try_pop(event)) {
+        apply(event);
+        dispatch(event);
+    }
+
+    auto dropped = dropped_events.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_events) {
+        spdlog::warn("[tinygl::window] input queue full, dropped {} events", dropped - reported_dropped_events);
+        reported_dropped_events = dropped;
+    }
+}
+
+void tinygl::window::window_private::publish_input()
+{
+    // The finished snapshot becomes current, the next one starts from its state without any events.
+    current_input.events.clear();
+    std::swap(current_input, next_input);
+    current_input.frame = frame_number++;
+    current_input.time = current_time;
+
+    next_input.keys = current_input.keys;
+    next_input.buttons = current_input.buttons;
+    next_input.mods = current_input.mods;
+    next_input.cursor_x = current_input.cursor_x;
+    next_input.cursor_y = current_input.cursor_y;
+    next_input.scroll_x = 0.0;
+    next_input.scroll_y = 0.0;
+    next_input.framebuffer_width = current_input.framebuffer_width;
+    next_input.framebuffer_height = current_input.framebuffer_height;
+    next_input.focused = current_input.focused;
+}
+
+void tinygl::window::window_private::begin_frame()
+{
+    publish_input();
+
+    auto swap_interval = pending_swap_interval.exchange(no_swap_interval);
+    if (swap_interval != no_swap_interval) {
+        apply_swap_interval(swap_interval);
+    }
+}
+
+void tinygl::window::window_private::apply_swap_interval(int interval)
+{
+    // A negative interval enables adaptive vsync where the swap_control_tear extensions are supported.
+    if (interval == adaptive_swap_interval && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        interval = 1;
+    }
+    glfwSwapInterval(interval);
+}
+
+void tinygl::window::window_private::handle_resize(tinygl::window& owner)
+{
+    // The callbacks may report many sizes per frame; only the latest one is acted upon.
+    if (resized.exchange(false)) {
+        glViewport(0, 0, framebuffer_width.load(), framebuffer_height.load());
+        resize_pending = true;
+        last_resize_time = current_time;
+    }
+    if (resize_pending && current_time - last_resize_time >= resize_settle_time) {
+        resize_pending = false;
+        auto width = framebuffer_width.load();
+        auto height = framebuffer_height.load();
+        render_targets.resize(width, height);
+        owner.resize(width, height);
+    }
+}
+
+void tinygl::window::window_private::wait_for_events()
+{
+    // Dear ImGui reacts to some input only on the frame after it arrives, so render once more before sleeping.
+    // A resize that has not settled yet needs frames as well.
+    if (settle_frames > 0 || resize_pending) {
+        settle_frames = std::max(settle_frames - 1, 0);
+        poll_events();
+        return;
+    }
+    if (!redraw_requested.exchange(false)) {
+        if (render_thread()) {
+            std::unique_lock lock{event_mutex};
+            render_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto ready = [this] { return !events.empty() || redraw_requested.load(); };
+            if (redraw_timeout > 0.0) {
+                event_signal.wait_for(lock, std::chrono::duration<double>(redraw_timeout), ready);
+            } else {
+                event_signal.wait(lock, ready);
+            }
+            render_waiting.store(false, std::memory_order_relaxed);
+        } else if (redraw_timeout > 0.0) {
+            glfwWaitEventsTimeout(redraw_timeout);
+        } else {
+            glfwWaitEvents();
+        }
+        redraw_requested.store(false);
+    }
+    // The events that woke us up belong to the frame about to be rendered; glfwWaitEvents() already pumped them.
+    poll_events(false);
+    settle_frames = 1;
+}
+
+void tinygl::window::window_private::wait_for_next_frame()
+{
+    // Sleeping is only accurate to a millisecond or so (far worse on some platforms),
+    // so sleep until shortly before the deadline and spin for the rest.
+    constexpr auto spin_threshold = 0.002;
+
+    next_frame_time += frame_period;
+    auto now = tinygl::get_time<double>();
+    if (now - next_frame_time > frame_period) {
+        // Fell behind by more than a frame, do not try to catch up.
+        next_frame_time = now;
+        return;
+    }
+    for (auto remaining = next_frame_time - now; remaining > 0.0; remaining = next_frame_time - now) {
+        if (remaining > spin_threshold) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - spin_threshold));
+        } else {
+            std::this_thread::yield();
+        }
+        now = tinygl::get_time<double>();
+    }
+}
+
+tinygl::window::window(int width, int height, std::string_view title, bool vsync, const window* share) :
         p{std::make_unique<window_private>()}
 {
-    p->window = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
+    auto* shared_window = share ? share->p->window : nullptr;
+    p->window = glfwCreateWindow(width, height, title.data(), nullptr, shared_window);
+    if (!p->window && tinygl::headless()) {
+        // No usable EGL device, fall back to Mesa's software rasterizer.
+        spdlog::warn("[tinygl::window] EGL context creation failed, retrying with OSMesa");
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        p->window = glfwCreateWindow(width, height, title.data(), nullptr, shared_window);
+    }
     if (!p->window) {
         throw std::runtime_error("glfwCreateWindow() failed!");
     }
-    glfwMakeContextCurrent(p->window);
-    if (vsync) {
+    p->make_current();
+    if (vsync && !tinygl::headless()) {
         glfwSwapInterval(1);
     }
-    glfwSetFramebufferSizeCallback(p->window, framebuffer_size_callback);
 
-    // see setKeyCallback() method
-    glfwSetWindowUserPointer(p->window, reinterpret_cast<void*>(this));
+    int window_width, window_height, framebuffer_width, framebuffer_height;
+    double cursor_x, cursor_y;
+    glfwGetWindowSize(p->window, &window_width, &window_height);
+    glfwGetFramebufferSize(p->window, &framebuffer_width, &framebuffer_height);
+    glfwGetCursorPos(p->window, &cursor_x, &cursor_y);
+    p->window_width.store(window_width);
+    p->window_height.store(window_height);
+    p->framebuffer_width.store(framebuffer_width);
+    p->framebuffer_height.store(framebuffer_height);
+    p->cursor_x.store(cursor_x);
+    p->cursor_y.store(cursor_y);
+    p->next_input.cursor_x = cursor_x;
+    p->next_input.cursor_y = cursor_y;
+    p->next_input.framebuffer_width = framebuffer_width;
+    p->next_input.framebuffer_height = framebuffer_height;
+    p->render_targets.resize(framebuffer_width, framebuffer_height);
+    p->install_callbacks();
 
     glewExperimental = GL_TRUE;
-    if (auto result = glewInit(); result != GLEW_OK) {
+    auto result = glewInit();
+    // A GLX build of GLEW loads the core entry points fine and only then fails to find an X display.
+    if (result == GLEW_ERROR_NO_GLX_DISPLAY && tinygl::headless()) {
+        result = GLEW_OK;
+    }
+    if (result != GLEW_OK) {
         const auto* error_string = glewGetErrorString(result);
         throw std::runtime_error{fmt::format("glewInit() failed! Error: {}", reinterpret_cast<const char*>(error_string))};
     }
@@ -120,17 +679,18 @@ tinygl::window::window(int width, int height, std::string_view title, bool vsync
         spdlog::info("[tinygl::window] [{}] {}", flags & flag ? "V" : " ", desc);
     }
 
+    validation::set_enabled(!(flags & GL_CONTEXT_FLAG_NO_ERROR_BIT));
+
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT) {
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-        glDebugMessageCallback(gl_debug_output, nullptr);
-        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        debug_output::install();
     }
 }
 
 tinygl::window::~window()
 {
-    if (p->window) {
+    if (p && p->window) {
+        debug_output::report_repeated();
+        state_cache::forget_context(p->window);
         glfwDestroyWindow(p->window);
     }
 }
@@ -144,72 +704,215 @@ tinygl::window& tinygl::window::operator=(window&& other) noexcept
     return *this;
 }
 
+void tinygl::window::set_threading_mode(threading_mode mode)
+{
+#ifdef __APPLE__
+    if (mode == threading_mode::render_thread) {
+        spdlog::warn("[tinygl::window] threading_mode::render_thread is not supported on macOS");
+        mode = threading_mode::single;
+    }
+#endif
+    p->threading = mode;
+}
+
 void tinygl::window::run()
 {
-    init();
+    auto content_scale = window_private::monitor_content_scale();
 
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    if (!p->render_thread()) {
+        p->render_loop(*this, content_scale);
+        return;
+    }
+
+    // A context can only be current on one thread at a time.
+    glfwMakeContextCurrent(nullptr);
+    p->render_finished.store(false);
+    std::exception_ptr error;
+    std::thread renderer{[this, content_scale, &error] {
+        try {
+            p->make_current();
+            p->render_loop(*this, content_scale);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        glfwMakeContextCurrent(nullptr);
+        p->render_finished.store(true);
+        glfwPostEmptyEvent();
+    }};
 
-    ImGui_ImplGlfw_InitForOpenGL(p->window, true);
-    ImGui_ImplOpenGL3_Init("#version 330");
+    // The event thread only pumps events; the callbacks hand them to the render thread.
+    while (!p->render_finished.load()) {
+        glfwWaitEvents();
+        std::optional<std::string> title;
+        {
+            std::lock_guard lock{p->event_mutex};
+            title.swap(p->pending_title);
+        }
+        if (title) {
+            glfwSetWindowTitle(p->window, title->c_str());
+        }
+    }
+    renderer.join();
+    p->make_current();
+    // The render thread changed the state behind this thread's cache.
+    state_cache::invalidate();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void tinygl::window::window_private::start(tinygl::window& owner, float content_scale, bool install_imgui_callbacks)
+{
+    owner.init();
+
+    IMGUI_CHECKVERSION();
+    imgui_context = ImGui::CreateContext();
+    // CreateContext() only makes the new context current when there was none, as for the first window of a group.
+    ImGui::SetCurrentContext(imgui_context);
 
     auto& io = ImGui::GetIO();
+    forward_imgui_events = !install_imgui_callbacks;
+    imgui_glfw_backend = !render_thread();
+    if (imgui_glfw_backend) {
+        ImGui_ImplGlfw_InitForOpenGL(window, install_imgui_callbacks);
+    } else {
+        io.BackendPlatformName = "tinygl_render_thread";
+        // The cursor shape can only be set on the event thread.
+        io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
+    }
+    renderer = std::make_unique<imgui_renderer>();
+
     auto font_size = 14.0f;
-#ifndef __APPLE__
-    auto* monitor = glfwGetPrimaryMonitor();
-    float xscale, yscale;
-    glfwGetMonitorContentScale(monitor, &xscale, &yscale);
-    if (xscale > 1.0f || yscale > 1.0f) {
-        font_size *= xscale;
+    if (content_scale > 1.0f) {
+        font_size *= content_scale;
         ImGuiStyle& style = ImGui::GetStyle();
-        style.ScaleAllSizes(xscale);
+        style.ScaleAllSizes(content_scale);
     }
-#endif
     const char* font_path = "fonts/JetBrainsMono-Light.ttf";
     if (std::filesystem::exists(font_path)) {
-        io.Fonts->AddFontFromFileTTF(font_path, font_size, nullptr, nullptr);
+        font_cache::add_font(*io.Fonts, font_path, font_size, font_cache_directory);
     }
 
-    while (!glfwWindowShouldClose(p->window)) {
-        process_input();
+    previous_time = tinygl::get_time<double>();
+    next_frame_time = previous_time;
+}
+
+void tinygl::window::window_private::render_frame(tinygl::window& owner)
+{
+    current_time = tinygl::get_time<double>();
+    delta_time = current_time - previous_time;
+    previous_time = current_time;
 
-        draw();
+    begin_frame();
+    handle_resize(owner);
+    if (stats) {
+        stats->begin_frame();
+    }
+    owner.process_input();
 
-        // feed inputs to dear imgui, start new frame
-        ImGui_ImplOpenGL3_NewFrame();
+    auto alpha = 1.0;
+    if (mode == loop_mode::fixed_timestep) {
+        accumulator += std::min(delta_time, fixed_timestep * max_steps);
+        while (accumulator >= fixed_timestep) {
+            owner.update(fixed_timestep);
+            accumulator -= fixed_timestep;
+        }
+        alpha = accumulator / fixed_timestep;
+    } else {
+        owner.update(delta_time);
+    }
+
+    owner.draw_interpolated(alpha);
+
+    // feed inputs to dear imgui, start new frame
+    renderer->new_frame();
+    if (imgui_glfw_backend) {
         ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+    } else {
+        new_imgui_frame();
+    }
+    ImGui::NewFrame();
 
-        draw_ui();
+    owner.draw_ui();
+    if (stats && stats->graph_visible()) {
+        stats->draw_ui();
+    }
 
-        // Render dear imgui into screen
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // Render dear imgui into screen
+    ImGui::Render();
+    renderer->render(ImGui::GetDrawData());
 
-        glfwSwapBuffers(p->window);
-        glfwPollEvents();
+    if (capture) {
+        capture->capture(framebuffer_width.load(), framebuffer_height.load());
+    }
+}
+
+void tinygl::window::window_private::present()
+{
+    if (stats) {
+        stats->begin_swap();
+    }
+    glfwSwapBuffers(window);
+    if (stats) {
+        stats->end_frame();
+    }
+}
+
+void tinygl::window::window_private::stop()
+{
+    if (capture) {
+        capture->finish();
+    }
+    if (stats) {
+        stats->finish();
+    }
+
+    renderer.reset();
+    if (imgui_glfw_backend) {
+        ImGui_ImplGlfw_Shutdown();
+    }
+    ImGui::DestroyContext(imgui_context);
+    imgui_context = nullptr;
+}
+
+void tinygl::window::window_private::render_loop(tinygl::window& owner, float content_scale)
+{
+    // In threading_mode::render_thread the events reach Dear ImGui through dispatch() instead.
+    start(owner, content_scale, !render_thread());
 
-        p->current_time = tinygl::get_time<float>();
-        p->delta_time = (p->current_time - p->previous_time);
-        p->previous_time = p->current_time;
+    while (!glfwWindowShouldClose(window)) {
+        render_frame(owner);
+        present();
+        if (mode == loop_mode::on_demand) {
+            wait_for_events();
+        } else {
+            poll_events();
+        }
+        debug_output::drain();
+
+        if (mode == loop_mode::frame_rate_cap) {
+            wait_for_next_frame();
+        }
     }
 
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    stop();
 }
 
 tinygl::keyboard::key_state tinygl::window::get_key(tinygl::keyboard::key key)
 {
-    return static_cast<tinygl::keyboard::key_state>(glfwGetKey(p->window, static_cast<int>(key)));
+    auto index = static_cast<int>(key);
+    if (index < 0 || index > GLFW_KEY_LAST) {
+        return tinygl::keyboard::key_state::release;
+    }
+    return static_cast<tinygl::keyboard::key_state>(p->keys[index].load());
 }
 
 template<std::floating_point T>
 std::tuple<T, T> tinygl::window::get_cursor_pos()
 {
-    double x, y;
-    glfwGetCursorPos(p->window, &x, &y);
+    auto x = p->cursor_x.load();
+    auto y = p->cursor_y.load();
     if constexpr (std::is_same<T, double>::value) {
         return {x, y};
     } else {
@@ -223,24 +926,18 @@ template std::tuple<long double, long double> tinygl::window::get_cursor_pos<lon
 
 std::tuple<int, int> tinygl::window::get_window_size()
 {
-    int width, height;
-    glfwGetWindowSize(p->window, &width, &height);
-    return {width, height};
+    return {p->window_width.load(), p->window_height.load()};
 }
 
 std::tuple<int, int> tinygl::window::get_framebuffer_size()
 {
-    int width, height;
-    glfwGetFramebufferSize(p->window, &width, &height);
-    return {width, height};
+    return {p->framebuffer_width.load(), p->framebuffer_height.load()};
 }
 
 template<std::floating_point T>
 T tinygl::window::aspect_ratio()
 {
-    int width, height;
-    glfwGetWindowSize(p->window, &width, &height);
-    return static_cast<T>(width) / height;
+    return static_cast<T>(p->window_width.load()) / p->window_height.load();
 }
 
 template float tinygl::window::aspect_ratio<float>();
@@ -249,12 +946,16 @@ template long double tinygl::window::aspect_ratio<long double>();
 
 void tinygl::window::set_title(std::string_view title)
 {
-    glfwSetWindowTitle(p->window, title.data());
-}
-
-void framebuffer_size_callback([[maybe_unused]] GLFWwindow* window, int width, int height)
-{
-    glViewport(0, 0, width, height);
+    // Window titles may only be changed on the event thread.
+    if (std::this_thread::get_id() != p->event_thread) {
+        {
+            std::lock_guard lock{p->event_mutex};
+            p->pending_title = std::string{title};
+        }
+        glfwPostEmptyEvent();
+        return;
+    }
+    glfwSetWindowTitle(p->window, std::string{title}.c_str());
 }
 
 void tinygl::window::set_should_close(bool should_close)
@@ -264,36 +965,213 @@ void tinygl::window::set_should_close(bool should_close)
 
 void tinygl::window::set_key_callback(tinygl::window::key_callback callback)
 {
-    // https://stackoverflow.com/questions/7676971/pointing-to-a-function-that-is-a-class-member-glfw-setkeycallback
-    // https://www.glfw.org/faq.html#216---how-do-i-use-c-methods-as-callbacks
+    // Called from dispatch(), on the render thread in threading_mode::render_thread.
     p->key_callback = std::move(callback);
-    auto glfw_key_callback = [](GLFWwindow* w, int key, int scancode, int action, int mods) {
-        static_cast<tinygl::window*>(glfwGetWindowUserPointer(w))->p->key_callback(
-            static_cast<tinygl::keyboard::key>(key),
-            scancode,
-            static_cast<input::action>(action),
-            static_cast<tinygl::input::modifier>(mods)
-        );
-    };
-    glfwSetKeyCallback(p->window, glfw_key_callback);
 }
 
 void tinygl::window::set_mouse_button_callback(tinygl::window::mouse_button_callback callback)
 {
     p->mouse_button_callback = std::move(callback);
-    auto glfw_mouse_button_callback = [](GLFWwindow* w, int button, int action, int mods) {
-        ImGuiIO& io = ImGui::GetIO();
-        if (io.WantCaptureMouse) return;
-        static_cast<tinygl::window*>(glfwGetWindowUserPointer(w))->p->mouse_button_callback(
-            static_cast<tinygl::mouse::button>(button),
-            static_cast<input::action>(action),
-            static_cast<tinygl::input::modifier>(mods)
-        );
-    };
-    glfwSetMouseButtonCallback(p->window, glfw_mouse_button_callback);
+}
+
+void tinygl::window::set_frame_capture(std::shared_ptr<tinygl::frame_capture> capture)
+{
+    p->capture = std::move(capture);
+}
+
+void tinygl::window::set_frame_stats(std::shared_ptr<tinygl::frame_stats> stats)
+{
+    p->stats = std::move(stats);
+}
+
+void tinygl::window::set_font_cache_directory(const std::filesystem::path& directory)
+{
+    p->font_cache_directory = directory;
+}
+
+void tinygl::window::set_loop_mode(loop_mode mode)
+{
+    p->mode = mode;
+    p->next_frame_time = tinygl::get_time<double>();
+    p->accumulator = 0.0;
+}
+
+void tinygl::window::set_frame_rate_cap(double frames_per_second)
+{
+    if (frames_per_second <= 0.0) {
+        throw std::invalid_argument("tinygl::window::set_frame_rate_cap(): frame rate must be positive!");
+    }
+    p->frame_period = 1.0 / frames_per_second;
+}
+
+void tinygl::window::set_fixed_timestep(double seconds, int max_steps)
+{
+    if (seconds <= 0.0 || max_steps < 1) {
+        throw std::invalid_argument("tinygl::window::set_fixed_timestep(): invalid timestep!");
+    }
+    p->fixed_timestep = seconds;
+    p->max_steps = max_steps;
+}
+
+void tinygl::window::set_vsync(vsync_mode mode)
+{
+    if (tinygl::headless()) {
+        return;
+    }
+    auto interval = 0;
+    switch (mode) {
+        case vsync_mode::off:
+            interval = 0;
+            break;
+        case vsync_mode::on:
+            interval = 1;
+            break;
+        case vsync_mode::adaptive:
+            interval = window_private::adaptive_swap_interval;
+            break;
+    }
+    // The swap interval and the extension lookup apply to the current context, which may belong to the render
+    // thread or to another window of a group; then both wait until the next frame of this window.
+    if (glfwGetCurrentContext() == p->window) {
+        window_private::apply_swap_interval(interval);
+    } else {
+        p->pending_swap_interval.store(interval);
+    }
+}
+
+void tinygl::window::request_redraw()
+{
+    p->wake();
+    glfwPostEmptyEvent();
+}
+
+void tinygl::window::set_redraw_timeout(double seconds)
+{
+    p->redraw_timeout = std::max(seconds, 0.0);
+}
+
+const tinygl::input::snapshot& tinygl::window::input_snapshot() const
+{
+    return p->current_input;
+}
+
+tinygl::render_target_registry& tinygl::window::render_targets()
+{
+    return p->render_targets;
+}
+
+void tinygl::window::set_resize_settle_time(double seconds)
+{
+    if (seconds < 0.0) {
+        throw std::invalid_argument("tinygl::window::set_resize_settle_time(): settle time must not be negative!");
+    }
+    p->resize_settle_time = seconds;
 }
 
 float tinygl::window::delta_time() const
 {
-    return p->delta_time;
+    return static_cast<float>(p->delta_time);
+}
+
+struct tinygl::window_group::window_group_private
+{
+    bool vsync;
+    std::vector<tinygl::window*> windows;
+
+    // The primary window is the only one that waits for vsync.
+    void set_primary(tinygl::window* primary);
+};
+
+void tinygl::window_group::window_group_private::set_primary(tinygl::window* primary)
+{
+    if (vsync && !tinygl::headless()) {
+        primary->p->make_current();
+        glfwSwapInterval(1);
+    }
+}
+
+tinygl::window_group::window_group(bool vsync) : p{std::make_unique<window_group_private>()}
+{
+    p->vsync = vsync;
+}
+
+tinygl::window_group::~window_group() = default;
+
+tinygl::window_group::window_group(window_group&& other) noexcept = default;
+tinygl::window_group& tinygl::window_group::operator=(window_group&& other) noexcept
+{
+    if (this != &other) {
+        p = std::move(other.p);
+    }
+    return *this;
+}
+
+void tinygl::window_group::add(tinygl::window& window)
+{
+    if (std::ranges::find(p->windows, &window) != p->windows.end()) {
+        throw std::invalid_argument("tinygl::window_group::add(): window added twice!");
+    }
+    if (window.p->render_thread()) {
+        spdlog::warn("[tinygl::window_group] windows in a group are rendered on the thread that calls run()");
+    }
+    if (window.p->mode == window::loop_mode::frame_rate_cap || window.p->mode == window::loop_mode::on_demand) {
+        spdlog::warn("[tinygl::window_group] the loop mode of a window is ignored in a group, it renders every pass");
+    }
+    p->windows.push_back(&window);
+}
+
+void tinygl::window_group::run()
+{
+    auto content_scale = window::window_private::monitor_content_scale();
+
+    for (auto* window : p->windows) {
+        auto& w = *window->p;
+        w.make_current();
+        w.grouped = true;
+        if (!tinygl::headless()) {
+            glfwSwapInterval(0);
+        }
+        w.start(*window, content_scale, false);
+    }
+
+    std::vector<tinygl::window*> open = p->windows;
+    if (!open.empty()) {
+        p->set_primary(open.front());
+    }
+    while (!open.empty()) {
+        glfwPollEvents();
+
+        for (auto* window : open) {
+            auto& w = *window->p;
+            w.make_current();
+            ImGui::SetCurrentContext(w.imgui_context);
+            w.poll_events();
+            w.render_frame(*window);
+        }
+
+        // Everything has been submitted, so the swaps go out back to back; the primary window swaps last and
+        // its vsync wait paces the loop.
+        for (auto it = open.rbegin(); it != open.rend(); ++it) {
+            auto& w = *(*it)->p;
+            w.make_current();
+            w.present();
+            debug_output::drain();
+        }
+
+        auto* primary = open.front();
+        std::erase_if(open, [](tinygl::window* window) {
+            auto& w = *window->p;
+            if (!glfwWindowShouldClose(w.window)) {
+                return false;
+            }
+            w.make_current();
+            ImGui::SetCurrentContext(w.imgui_context);
+            w.stop();
+            w.grouped = false;
+            return true;
+        });
+        if (!open.empty() && open.front() != primary) {
+            p->set_primary(open.front());
+        }
+    }
 }
@@ -0,0 +1,429 @@
+#include "block_encoder.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace {
+    template<std::size_t N>
+    using vec = std::array<float, N>;
+
+    template<std::size_t N>
+    float distance_squared(const vec<N>& a, const vec<N>& b)
+    {
+        auto sum = 0.0f;
+        for (std::size_t c = 0; c < N; ++c) {
+            sum += (a[c] - b[c]) * (a[c] - b[c]);
+        }
+        return sum;
+    }
+
+    // Endpoints spanning the block along its principal axis, found by power iteration on the covariance matrix.
+    template<std::size_t N>
+    std::pair<vec<N>, vec<N>> principal_endpoints(const std::array<vec<N>, 16>& texels)
+    {
+        vec<N> mean{};
+        for (const auto& texel : texels) {
+            for (std::size_t c = 0; c < N; ++c) {
+                mean[c] += texel[c] / 16.0f;
+            }
+        }
+        std::array<vec<N>, N> covariance{};
+        for (const auto& texel : texels) {
+            for (std::size_t i = 0; i < N; ++i) {
+                for (std::size_t j = 0; j < N; ++j) {
+                    covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+                }
+            }
+        }
+
+        vec<N> axis;
+        axis.fill(1.0f);
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            vec<N> next{};
+            for (std::size_t i = 0; i < N; ++i) {
+                for (std::size_t j = 0; j < N; ++j) {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+            }
+            auto length = 0.0f;
+            for (auto value : next) {
+                length = std::max(length, std::abs(value));
+            }
+            if (length < 1e-6f) {
+                // All texels are (nearly) equal.
+                return {mean, mean};
+            }
+            for (std::size_t i = 0; i < N; ++i) {
+                axis[i] = next[i] / length;
+            }
+        }
+
+        auto low = std::numeric_limits<float>::max();
+        auto high = std::numeric_limits<float>::lowest();
+        auto length_squared = 0.0f;
+        for (auto value : axis) {
+            length_squared += value * value;
+        }
+        for (const auto& texel : texels) {
+            auto t = 0.0f;
+            for (std::size_t c = 0; c < N; ++c) {
+                t += (texel[c] - mean[c]) * axis[c];
+            }
+            t /= length_squared;
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+        vec<N> first, second;
+        for (std::size_t c = 0; c < N; ++c) {
+            first[c] = std::clamp(mean[c] + low * axis[c], 0.0f, 255.0f);
+            second[c] = std::clamp(mean[c] + high * axis[c], 0.0f, 255.0f);
+        }
+        return {first, second};
+    }
+
+    // Least squares endpoints for texels interpolated with weights[i] between the two endpoints.
+    template<std::size_t N>
+    bool refine_endpoints(const std::array<vec<N>, 16>& texels, const std::array<float, 16>& weights,
+                          vec<N>& first, vec<N>& second)
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        vec<N> x{}, y{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            auto t = weights[i];
+            a += (1.0f - t) * (1.0f - t);
+            b += t * (1.0f - t);
+            c += t * t;
+            for (std::size_t k = 0; k < N; ++k) {
+                x[k] += (1.0f - t) * texels[i][k];
+                y[k] += t * texels[i][k];
+            }
+        }
+        auto determinant = a * c - b * b;
+        if (std::abs(determinant) < 1e-6f) {
+            return false;
+        }
+        for (std::size_t k = 0; k < N; ++k) {
+            first[k] = std::clamp((c * x[k] - b * y[k]) / determinant, 0.0f, 255.0f);
+            second[k] = std::clamp((a * y[k] - b * x[k]) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    class bit_writer
+    {
+    public:
+        explicit bit_writer(std::uint8_t* out) : out{out} {}
+
+        void write(std::uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; ++i, ++position) {
+                out[position >> 3] |= static_cast<std::uint8_t>(((value >> i) & 1u) << (position & 7));
+            }
+        }
+
+    private:
+        std::uint8_t* out;
+        int position = 0;
+    };
+
+    std::uint16_t pack_565(const vec<3>& color)
+    {
+        auto r = static_cast<std::uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+        auto g = static_cast<std::uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+        auto b = static_cast<std::uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+        return static_cast<std::uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    vec<3> unpack_565(std::uint16_t packed)
+    {
+        auto r = (packed >> 11) & 31;
+        auto g = (packed >> 5) & 63;
+        auto b = packed & 31;
+        return {static_cast<float>(r << 3 | r >> 2), static_cast<float>(g << 2 | g >> 4),
+                static_cast<float>(b << 3 | b >> 2)};
+    }
+
+    void encode_bc1(const std::uint8_t* pixels, std::uint8_t* block)
+    {
+        std::array<vec<3>, 16> texels;
+        for (std::size_t i = 0; i < 16; ++i) {
+            texels[i] = {static_cast<float>(pixels[4 * i]), static_cast<float>(pixels[4 * i + 1]),
+                         static_cast<float>(pixels[4 * i + 2])};
+        }
+        auto [first, second] = principal_endpoints(texels);
+
+        auto palette_of = [](std::uint16_t c0, std::uint16_t c1) {
+            auto p0 = unpack_565(c0);
+            auto p1 = unpack_565(c1);
+            std::array<vec<3>, 4> palette{p0, p1};
+            for (std::size_t c = 0; c < 3; ++c) {
+                palette[2][c] = (2.0f * p0[c] + p1[c]) / 3.0f;
+                palette[3][c] = (p0[c] + 2.0f * p1[c]) / 3.0f;
+            }
+            return palette;
+        };
+        auto encode = [&](const vec<3>& a, const vec<3>& b, std::uint32_t& indices) {
+            auto c0 = pack_565(a);
+            auto c1 = pack_565(b);
+            if (c0 < c1) {
+                std::swap(c0, c1);
+            }
+            indices = 0;
+            auto error = 0.0f;
+            if (c0 == c1) {
+                // Both endpoints are equal: every texel uses the first one.
+                for (const auto& texel : texels) {
+                    error += distance_squared(texel, unpack_565(c0));
+                }
+                return std::tuple{c0, c1, error};
+            }
+            auto palette = palette_of(c0, c1);
+            for (std::size_t i = 0; i < 16; ++i) {
+                std::uint32_t best = 0;
+                auto best_error = std::numeric_limits<float>::max();
+                for (std::uint32_t k = 0; k < 4; ++k) {
+                    auto e = distance_squared(texels[i], palette[k]);
+                    if (e < best_error) {
+                        best_error = e;
+                        best = k;
+                    }
+                }
+                indices |= best << (2 * i);
+                error += best_error;
+            }
+            return std::tuple{c0, c1, error};
+        };
+
+        std::uint32_t indices;
+        auto [c0, c1, error] = encode(first, second, indices);
+        if (c0 != c1) {
+            // Palette order is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1.
+            constexpr std::array<float, 4> weights = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+            std::array<float, 16> texel_weights;
+            for (std::size_t i = 0; i < 16; ++i) {
+                texel_weights[i] = weights[(indices >> (2 * i)) & 3];
+            }
+            auto refined_first = unpack_565(c0);
+            auto refined_second = unpack_565(c1);
+            if (refine_endpoints(texels, texel_weights, refined_first, refined_second)) {
+                std::uint32_t refined_indices;
+                auto [r0, r1, refined_error] = encode(refined_first, refined_second, refined_indices);
+                if (refined_error < error) {
+                    c0 = r0;
+                    c1 = r1;
+                    indices = refined_indices;
+                }
+            }
+        }
+
+        block[0] = static_cast<std::uint8_t>(c0);
+        block[1] = static_cast<std::uint8_t>(c0 >> 8);
+        block[2] = static_cast<std::uint8_t>(c1);
+        block[3] = static_cast<std::uint8_t>(c1 >> 8);
+        for (int i = 0; i < 4; ++i) {
+            block[4 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+        }
+    }
+
+    // One channel of the block, `channel` selecting it from the RGBA texels.
+    void encode_bc4(const std::uint8_t* pixels, std::size_t channel, std::uint8_t* block)
+    {
+        std::uint8_t low = 255, high = 0;
+        for (std::size_t i = 0; i < 16; ++i) {
+            low = std::min(low, pixels[4 * i + channel]);
+            high = std::max(high, pixels[4 * i + channel]);
+        }
+        std::memset(block, 0, 8);
+        // With red_0 > red_1 the palette holds both endpoints and six evenly spaced values in between.
+        block[0] = high;
+        block[1] = low;
+        if (high == low) {
+            return;
+        }
+        bit_writer writer{block + 2};
+        for (std::size_t i = 0; i < 16; ++i) {
+            auto step = static_cast<int>(std::lround((pixels[4 * i + channel] - low) * 7.0f / (high - low)));
+            auto index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+            writer.write(static_cast<std::uint32_t>(index), 3);
+        }
+    }
+
+    // Mode 6: one subset, 7 bit RGBA endpoints with a shared low bit each, 4 bit indices.
+    void encode_bc7(const std::uint8_t* pixels, std::uint8_t* block)
+    {
+        constexpr std::array<int, 16> weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        std::array<vec<4>, 16> texels;
+        for (std::size_t i = 0; i < 16; ++i) {
+            for (std::size_t c = 0; c < 4; ++c) {
+                texels[i][c] = static_cast<float>(pixels[4 * i + c]);
+            }
+        }
+
+        struct endpoint
+        {
+            std::array<std::uint32_t, 4> bits;
+            std::uint32_t p;
+            vec<4> value;
+        };
+        auto quantize = [](const vec<4>& color) {
+            endpoint best{};
+            auto best_error = std::numeric_limits<float>::max();
+            for (std::uint32_t p = 0; p < 2; ++p) {
+                endpoint candidate{{}, p, {}};
+                auto error = 0.0f;
+                for (std::size_t c = 0; c < 4; ++c) {
+                    auto q = std::clamp(std::lround((color[c] - static_cast<float>(p)) / 2.0f), 0L, 127L);
+                    candidate.bits[c] = static_cast<std::uint32_t>(q);
+                    candidate.value[c] = static_cast<float>(q << 1 | p);
+                    error += (candidate.value[c] - color[c]) * (candidate.value[c] - color[c]);
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    best = candidate;
+                }
+            }
+            return best;
+        };
+        auto assign = [&](const endpoint& e0, const endpoint& e1, std::array<std::uint32_t, 16>& indices) {
+            std::array<vec<4>, 16> palette;
+            for (std::size_t k = 0; k < 16; ++k) {
+                for (std::size_t c = 0; c < 4; ++c) {
+                    auto value = ((64 - weights[k]) * static_cast<int>(e0.value[c]) +
+                                  weights[k] * static_cast<int>(e1.value[c]) + 32) >> 6;
+                    palette[k][c] = static_cast<float>(value);
+                }
+            }
+            auto error = 0.0f;
+            for (std::size_t i = 0; i < 16; ++i) {
+                auto best_error = std::numeric_limits<float>::max();
+                for (std::uint32_t k = 0; k < 16; ++k) {
+                    auto e = distance_squared(texels[i], palette[k]);
+                    if (e < best_error) {
+                        best_error = e;
+                        indices[i] = k;
+                    }
+                }
+                error += best_error;
+            }
+            return error;
+        };
+
+        auto [first, second] = principal_endpoints(texels);
+        auto e0 = quantize(first);
+        auto e1 = quantize(second);
+        std::array<std::uint32_t, 16> indices;
+        auto error = assign(e0, e1, indices);
+
+        std::array<float, 16> texel_weights;
+        for (std::size_t i = 0; i < 16; ++i) {
+            texel_weights[i] = static_cast<float>(weights[indices[i]]) / 64.0f;
+        }
+        if (refine_endpoints(texels, texel_weights, first, second)) {
+            auto r0 = quantize(first);
+            auto r1 = quantize(second);
+            std::array<std::uint32_t, 16> refined_indices;
+            if (assign(r0, r1, refined_indices) < error) {
+                e0 = r0;
+                e1 = r1;
+                indices = refined_indices;
+            }
+        }
+
+        // The most significant bit of the first index is implied to be zero.
+        if (indices[0] & 8) {
+            std::swap(e0, e1);
+            for (auto& index : indices) {
+                index = 15 - index;
+            }
+        }
+
+        std::memset(block, 0, 16);
+        bit_writer writer{block};
+        writer.write(1u << 6, 7);
+        for (std::size_t c = 0; c < 4; ++c) {
+            writer.write(e0.bits[c], 7);
+            writer.write(e1.bits[c], 7);
+        }
+        writer.write(e0.p, 1);
+        writer.write(e1.p, 1);
+        writer.write(indices[0], 3);
+        for (std::size_t i = 1; i < 16; ++i) {
+            writer.write(indices[i], 4);
+        }
+    }
+}
+
+std::size_t tinygl::texbake::block_size(block_format format)
+{
+    switch (format) {
+        case block_format::bc1:
+        case block_format::bc4:
+            return 8;
+        case block_format::bc5:
+        case block_format::bc7:
+            return 16;
+    }
+    return 16;
+}
+
+void tinygl::texbake::encode_block(block_format format, const std::uint8_t* pixels, std::uint8_t* block)
+{
+    switch (format) {
+        case block_format::bc1:
+            encode_bc1(pixels, block);
+            break;
+        case block_format::bc4:
+            encode_bc4(pixels, 0, block);
+            break;
+        case block_format::bc5:
+            encode_bc4(pixels, 0, block);
+            encode_bc4(pixels, 1, block + 8);
+            break;
+        case block_format::bc7:
+            encode_bc7(pixels, block);
+            break;
+    }
+}
+
+std::vector<std::uint8_t> tinygl::texbake::encode_image(
+        block_format format, const std::uint8_t* rgba, int width, int height, std::size_t thread_count)
+{
+    auto columns = (width + 3) / 4;
+    auto rows = (height + 3) / 4;
+    auto size = block_size(format);
+    std::vector<std::uint8_t> blocks(static_cast<std::size_t>(columns) * rows * size);
+
+    std::atomic<int> next_row{0};
+    auto work = [&] {
+        std::array<std::uint8_t, 64> pixels;
+        for (auto row = next_row++; row < rows; row = next_row++) {
+            for (int column = 0; column < columns; ++column) {
+                for (int y = 0; y < 4; ++y) {
+                    auto source_y = std::min(row * 4 + y, height - 1);
+                    for (int x = 0; x < 4; ++x) {
+                        auto source_x = std::min(column * 4 + x, width - 1);
+                        std::memcpy(&pixels[static_cast<std::size_t>(4 * (4 * y + x))],
+                                    rgba + (static_cast<std::size_t>(source_y) * width + source_x) * 4, 4);
+                    }
+                }
+                encode_block(format, pixels.data(),
+                             blocks.data() + (static_cast<std::size_t>(row) * columns + column) * size);
+            }
+        }
+    };
+
+    std::vector<std::jthread> threads;
+    auto count = std::clamp<std::size_t>(thread_count, 1, static_cast<std::size_t>(rows));
+    for (std::size_t i = 1; i < count; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    // Joined before `blocks` is returned, which the workers still write to.
+    threads.clear();
+    return blocks;
+}
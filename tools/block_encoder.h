@@ -0,0 +1,32 @@
+#ifndef TINYGL_TOOLS_BLOCK_ENCODER_H
+#define TINYGL_TOOLS_BLOCK_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Block compression for tinygl_texbake. The encoders fit endpoints along the principal axis of each block and
+ * refine them once by least squares; that is far from an exhaustive search, but fast and good enough for assets
+ * that would otherwise ship as PNG.
+ */
+namespace tinygl::texbake {
+    enum class block_format {
+        bc1,  // RGB, 4 bpp
+        bc4,  // R, 4 bpp
+        bc5,  // RG, 8 bpp, e.g. tangent space normal maps
+        bc7   // RGBA, 8 bpp; mode 6 only
+    };
+
+    std::size_t block_size(block_format format);
+
+    // `pixels` are the 16 RGBA8 texels of a 4x4 block, row by row.
+    void encode_block(block_format format, const std::uint8_t* pixels, std::uint8_t* block);
+
+    // Encodes an RGBA8 image row by row of blocks on `thread_count` threads; partial edge blocks repeat the last
+    // row and column.
+    std::vector<std::uint8_t> encode_image(
+        block_format format, const std::uint8_t* rgba, int width, int height, std::size_t thread_count);
+}
+
+#endif // TINYGL_TOOLS_BLOCK_ENCODER_H
@@ -0,0 +1,342 @@
+#include "block_encoder.h"
+#include "tinygl/mipmap_generator.h"
+#include <stb/stb_image.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Bakes PNG/JPEG images into block-compressed KTX2 files with a full mip chain, ready for
+ * tinygl::compressed_image and the texture constructor taking it. Images are stored bottom row first, as tinygl
+ * loads PNG/JPEG textures, so a baked file is a drop-in replacement for its source image.
+ *
+ * Usage: tinygl_texbake [--format bc1|bc4|bc5|bc7] [--srgb] [--filter box|kaiser] [--alpha-cutoff A] [--no-mips]
+ *                       [--threads N] [-o output] input...
+ *
+ * bc4 keeps the red channel and bc5 red and green. --srgb filters the mip chain in linear space and writes an
+ * sRGB format (bc1 and bc7 only). --alpha-cutoff keeps the alpha-tested coverage of every level at that of the
+ * base level. With several inputs -o names a directory; by default every output is written next to its input
+ * with the .ktx2 extension.
+ */
+
+namespace {
+    using tinygl::texbake::block_format;
+
+    struct options
+    {
+        block_format format = block_format::bc7;
+        bool srgb = false;
+        bool mips = true;
+        tinygl::mipmap_filter filter = tinygl::mipmap_filter::kaiser;
+        float alpha_cutoff = 0.0f;
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        std::optional<std::filesystem::path> output;
+        std::vector<std::filesystem::path> inputs;
+    };
+
+    [[noreturn]] void usage(std::string_view error)
+    {
+        std::cerr << "tinygl_texbake: " << error << "\n"
+                  << "Usage: tinygl_texbake [--format bc1|bc4|bc5|bc7] [--srgb] [--filter box|kaiser] "
+                     "[--alpha-cutoff A] [--no-mips] [--threads N] [-o output] input...\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    options parse_options(int argc, char** argv)
+    {
+        options result;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            auto value = [&] {
+                if (i + 1 >= argc) {
+                    usage(fmt::format("{} expects a value", arg));
+                }
+                return std::string_view{argv[++i]};
+            };
+            if (arg == "--format" || arg == "-f") {
+                auto name = value();
+                if (name == "bc1") {
+                    result.format = block_format::bc1;
+                } else if (name == "bc4") {
+                    result.format = block_format::bc4;
+                } else if (name == "bc5") {
+                    result.format = block_format::bc5;
+                } else if (name == "bc7") {
+                    result.format = block_format::bc7;
+                } else {
+                    usage(fmt::format("unknown format '{}'", name));
+                }
+            } else if (arg == "--srgb") {
+                result.srgb = true;
+            } else if (arg == "--filter") {
+                auto name = value();
+                if (name == "box") {
+                    result.filter = tinygl::mipmap_filter::box;
+                } else if (name == "kaiser") {
+                    result.filter = tinygl::mipmap_filter::kaiser;
+                } else {
+                    usage(fmt::format("unknown filter '{}'", name));
+                }
+            } else if (arg == "--alpha-cutoff") {
+                auto text = value();
+                auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result.alpha_cutoff);
+                if (error != std::errc{} || end != text.data() + text.size() || result.alpha_cutoff <= 0.0f ||
+                    result.alpha_cutoff >= 1.0f) {
+                    usage(fmt::format("invalid alpha cutoff '{}'", text));
+                }
+            } else if (arg == "--no-mips") {
+                result.mips = false;
+            } else if (arg == "--threads" || arg == "-j") {
+                auto text = value();
+                auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result.threads);
+                if (error != std::errc{} || end != text.data() + text.size() || result.threads == 0) {
+                    usage(fmt::format("invalid thread count '{}'", text));
+                }
+            } else if (arg == "--output" || arg == "-o") {
+                result.output = value();
+            } else if (arg.starts_with("-")) {
+                usage(fmt::format("unknown option '{}'", arg));
+            } else {
+                result.inputs.emplace_back(arg);
+            }
+        }
+        if (result.inputs.empty()) {
+            usage("no input files");
+        }
+        if (result.srgb && result.format != block_format::bc1 && result.format != block_format::bc7) {
+            usage("--srgb needs bc1 or bc7");
+        }
+        return result;
+    }
+
+    std::uint32_t vk_format(const options& options)
+    {
+        switch (options.format) {
+            case block_format::bc1: return options.srgb ? 132 : 131;  // BC1_RGB_SRGB / BC1_RGB_UNORM
+            case block_format::bc4: return 139;                       // BC4_UNORM
+            case block_format::bc5: return 141;                       // BC5_UNORM
+            case block_format::bc7: return options.srgb ? 146 : 145;  // BC7_SRGB / BC7_UNORM
+        }
+        return 0;
+    }
+
+    // Minimal basic data format descriptor for a 4x4 block format, as required by KTX2.
+    std::vector<std::uint32_t> data_format_descriptor(const options& options)
+    {
+        constexpr std::uint32_t model_bc1a = 128, model_bc4 = 131, model_bc5 = 132, model_bc7 = 134;
+        constexpr std::uint32_t primaries_bt709 = 1, transfer_linear = 1, transfer_srgb = 2;
+
+        auto block_bytes = static_cast<std::uint32_t>(tinygl::texbake::block_size(options.format));
+        std::uint32_t model = model_bc7;
+        std::uint32_t samples = 1;
+        switch (options.format) {
+            case block_format::bc1: model = model_bc1a; break;
+            case block_format::bc4: model = model_bc4; break;
+            case block_format::bc5: model = model_bc5; samples = 2; break;
+            case block_format::bc7: model = model_bc7; break;
+        }
+        auto bits_per_sample = block_bytes * 8 / samples;
+
+        std::vector<std::uint32_t> words;
+        auto block_size = 24 + 16 * samples;
+        words.push_back(4 + block_size);                                   // dfdTotalSize
+        words.push_back(0);                                                // vendorId, descriptorType
+        words.push_back(2 | block_size << 16);                             // versionNumber, descriptorBlockSize
+        words.push_back(model | primaries_bt709 << 8 |
+                        (options.srgb ? transfer_srgb : transfer_linear) << 16);
+        words.push_back(3 | 3 << 8);                                       // 4x4x1x1 texel block
+        words.push_back(block_bytes);                                      // bytesPlane0
+        words.push_back(0);
+        for (std::uint32_t sample = 0; sample < samples; ++sample) {
+            // Channel ids: BC1A colour, BC4 data, BC5 red/green, BC7 colour are 0 and 1.
+            words.push_back(sample * bits_per_sample | (bits_per_sample - 1) << 16 | sample << 24);
+            words.push_back(0);                                            // sample position
+            words.push_back(0);                                            // sampleLower
+            words.push_back(0xFFFFFFFF);                                   // sampleUpper
+        }
+        return words;
+    }
+
+    class ktx2_writer
+    {
+    public:
+        void u32(std::uint32_t value) { bytes(&value, sizeof(value)); }
+        void u64(std::uint64_t value) { bytes(&value, sizeof(value)); }
+
+        void bytes(const void* data, std::size_t size)
+        {
+            const auto* first = static_cast<const std::uint8_t*>(data);
+            buffer.insert(buffer.end(), first, first + size);
+        }
+
+        void align(std::size_t alignment)
+        {
+            buffer.resize((buffer.size() + alignment - 1) / alignment * alignment);
+        }
+
+        std::size_t size() const { return buffer.size(); }
+
+        void patch_u64(std::size_t offset, std::uint64_t value)
+        {
+            std::copy_n(reinterpret_cast<const std::uint8_t*>(&value), sizeof(value), buffer.begin() + offset);
+        }
+
+        void save(const std::filesystem::path& file_name) const
+        {
+            std::ofstream file{file_name, std::ios::binary};
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            if (!file) {
+                throw std::runtime_error(fmt::format("cannot write '{}'", file_name.string()));
+            }
+        }
+
+    private:
+        std::vector<std::uint8_t> buffer;
+    };
+
+    // KTX2 stores the levels smallest first, each aligned to the block size, while the level index lists them
+    // largest first.
+    void write_ktx2(const std::filesystem::path& file_name, const options& options, int width, int height,
+                    const std::vector<std::vector<std::uint8_t>>& levels)
+    {
+        constexpr std::array<std::uint8_t, 12> identifier = {
+            0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        // Sorted by key, as KTX2 requires. "ru" records that the bottom row comes first.
+        constexpr std::array<std::pair<std::string_view, std::string_view>, 2> key_values = {{
+            {"KTXorientation", "ru"},
+            {"KTXwriter", "tinygl_texbake"},
+        }};
+
+        auto dfd = data_format_descriptor(options);
+        auto level_count = static_cast<std::uint32_t>(levels.size());
+        auto dfd_offset = 80 + 24 * level_count;
+        auto dfd_length = static_cast<std::uint32_t>(dfd.size() * 4);
+        auto kvd_offset = dfd_offset + dfd_length;
+        auto kvd_length = std::uint32_t{0};
+        for (const auto& [key, value] : key_values) {
+            kvd_length += static_cast<std::uint32_t>(4 + key.size() + value.size() + 2 + 3) / 4 * 4;
+        }
+
+        ktx2_writer writer;
+        writer.bytes(identifier.data(), identifier.size());
+        writer.u32(vk_format(options));
+        writer.u32(1);                     // typeSize
+        writer.u32(static_cast<std::uint32_t>(width));
+        writer.u32(static_cast<std::uint32_t>(height));
+        writer.u32(0);                     // pixelDepth
+        writer.u32(0);                     // layerCount
+        writer.u32(1);                     // faceCount
+        writer.u32(level_count);
+        writer.u32(0);                     // supercompressionScheme
+        writer.u32(dfd_offset);
+        writer.u32(dfd_length);
+        writer.u32(kvd_offset);
+        writer.u32(kvd_length);
+        writer.u64(0);                     // sgdByteOffset
+        writer.u64(0);                     // sgdByteLength
+
+        auto level_index = writer.size();
+        for (const auto& level : levels) {
+            writer.u64(0);
+            writer.u64(level.size());
+            writer.u64(level.size());      // uncompressedByteLength
+        }
+        for (auto word : dfd) {
+            writer.u32(word);
+        }
+        for (const auto& [key, value] : key_values) {
+            writer.u32(static_cast<std::uint32_t>(key.size() + value.size() + 2));
+            writer.bytes(key.data(), key.size());
+            writer.bytes("", 1);
+            writer.bytes(value.data(), value.size());
+            writer.bytes("", 1);
+            writer.align(4);
+        }
+
+        auto alignment = std::lcm(tinygl::texbake::block_size(options.format), std::size_t{4});
+        for (auto i = levels.size(); i-- > 0;) {
+            writer.align(alignment);
+            writer.patch_u64(level_index + i * 24, writer.size());
+            writer.bytes(levels[i].data(), levels[i].size());
+        }
+        writer.save(file_name);
+    }
+
+    std::filesystem::path output_path(const options& options, const std::filesystem::path& input)
+    {
+        auto file_name = input.filename().replace_extension(".ktx2");
+        if (!options.output) {
+            return input.parent_path() / file_name;
+        }
+        if (options.inputs.size() > 1 || std::filesystem::is_directory(*options.output)) {
+            return *options.output / file_name;
+        }
+        return *options.output;
+    }
+
+    void bake(const options& options, tinygl::mipmap_generator& generator, const std::filesystem::path& input)
+    {
+        int width, height, channels;
+        // Flipped like texture, texture_loader and texture_atlas do, so a baked file can replace its source image.
+        stbi_set_flip_vertically_on_load(true);
+        std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels{
+            stbi_load(input.string().c_str(), &width, &height, &channels, 4), stbi_image_free};
+        if (!pixels) {
+            throw std::runtime_error(fmt::format("cannot load '{}': {}", input.string(), stbi_failure_reason()));
+        }
+
+        tinygl::image_view base{pixels.get(), width, height, 4};
+        std::vector<tinygl::image_level> mips;
+        if (options.mips) {
+            mips = generator.generate(base, {options.filter, options.srgb, options.alpha_cutoff, 0});
+        }
+
+        std::vector<std::vector<std::uint8_t>> levels;
+        levels.push_back(tinygl::texbake::encode_image(options.format, base.pixels, width, height, options.threads));
+        pixels.reset();
+        for (const auto& level : mips) {
+            levels.push_back(tinygl::texbake::encode_image(
+                options.format, level.pixels.data(), level.width, level.height, options.threads));
+        }
+
+        auto file_name = output_path(options, input);
+        write_ktx2(file_name, options, width, height, levels);
+        std::cout << fmt::format("{} -> {} ({}x{}, {} levels)\n",
+                                 input.string(), file_name.string(), width, height, levels.size());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = parse_options(argc, argv);
+    if (options.output && options.inputs.size() > 1) {
+        std::filesystem::create_directories(*options.output);
+    }
+
+    tinygl::mipmap_generator generator{options.threads};
+    auto failures = 0;
+    for (const auto& input : options.inputs) {
+        try {
+            bake(options, generator, input);
+        } catch (const std::exception& e) {
+            std::cerr << "tinygl_texbake: " << e.what() << "\n";
+            ++failures;
+        }
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}